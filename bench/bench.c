@@ -0,0 +1,169 @@
+/* See LICENSE file for copyright and license details. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#include <inttypes.h>
+
+#include "bench.h"
+
+u64
+benchclock(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+u64
+benchcpu(int pid)
+{
+    char path[64];
+    FILE *f;
+    unsigned long long ns = 0;
+    unsigned long utime = 0;
+    unsigned long stime = 0;
+    int ok;
+
+    if(!pid)
+    {   return 0;
+    }
+    /* schedstat has ns resolution, stat only has clock ticks */
+    snprintf(path, sizeof(path), "/proc/%d/schedstat", pid);
+    if((f = fopen(path, "r")))
+    {
+        ok = fscanf(f, "%llu", &ns) == 1;
+        fclose(f);
+        if(ok)
+        {   return ns;
+        }
+    }
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    if(!(f = fopen(path, "r")))
+    {   return 0;
+    }
+    /* comm may contain spaces, skip to the closing paren */
+    ok = fscanf(f, "%*d (%*[^)]) %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu", &utime, &stime) == 2;
+    fclose(f);
+    return ok ? (u64)(utime + stime) * (1000000000 / sysconf(_SC_CLK_TCK)) : 0;
+}
+
+void
+distadd(Dist *d, u64 v)
+{
+    u64 *nv;
+    if(d->n == d->max)
+    {
+        d->max = d->max ? d->max * 2 : 64;
+        if(!(nv = realloc(d->v, d->max * sizeof(u64))))
+        {   DIE("%s", "out of memory");
+        }
+        d->v = nv;
+    }
+    d->v[d->n++] = v;
+}
+
+static int
+u64cmp(const void *a, const void *b)
+{
+    const u64 x = *(const u64 *)a;
+    const u64 y = *(const u64 *)b;
+    return (x > y) - (x < y);
+}
+
+static u64
+percentile(const Dist *d, u32 p)
+{
+    return d->v[(u64)(d->n - 1) * p / 100];
+}
+
+void
+distprint(FILE *f, const char *name, Dist *d)
+{
+    u64 sum = 0;
+    u32 i;
+    if(!d->n)
+    {   fprintf(f, "\"%s\":{\"n\":0}", name);
+        return;
+    }
+    qsort(d->v, d->n, sizeof(u64), u64cmp);
+    for(i = 0; i < d->n; ++i)
+    {   sum += d->v[i];
+    }
+    fprintf(f, "\"%s\":{\"n\":%u,\"min\":%"PRIu64",\"p50\":%"PRIu64",\"p90\":%"PRIu64",\"p99\":%"PRIu64",\"max\":%"PRIu64",\"mean\":%"PRIu64"}",
+            name, d->n, d->v[0], percentile(d, 50), percentile(d, 90), percentile(d, 99), d->v[d->n - 1], sum / d->n);
+}
+
+void
+distfree(Dist *d)
+{
+    free(d->v);
+    memset(d, 0, sizeof(Dist));
+}
+
+xcb_atom_t
+benchatom(xcb_connection_t *c, const char *name)
+{
+    xcb_intern_atom_reply_t *reply = xcb_intern_atom_reply(c, xcb_intern_atom(c, 0, strlen(name), name), NULL);
+    xcb_atom_t atom = XCB_ATOM_NONE;
+    if(reply)
+    {   atom = reply->atom;
+        free(reply);
+    }
+    return atom;
+}
+
+int
+benchwaitwm(xcb_connection_t *c, xcb_window_t root, u64 timeoutns)
+{
+    const xcb_atom_t check = benchatom(c, "_NET_SUPPORTING_WM_CHECK");
+    const u64 deadline = benchclock() + timeoutns;
+    xcb_get_property_reply_t *reply;
+    int found;
+
+    do
+    {
+        reply = xcb_get_property_reply(c, xcb_get_property(c, 0, root, check, XCB_ATOM_WINDOW, 0, 1), NULL);
+        found = reply && reply->value_len;
+        free(reply);
+        if(found)
+        {   return 1;
+        }
+        usleep(10000);
+    } while(benchclock() < deadline);
+    return 0;
+}
+
+xcb_generic_event_t *
+benchwaitevent(xcb_connection_t *c, u64 deadline)
+{
+    xcb_generic_event_t *ev;
+    struct pollfd pfd = { .fd = xcb_get_file_descriptor(c), .events = POLLIN };
+    u64 now;
+
+    while(!(ev = xcb_poll_for_event(c)))
+    {
+        if(xcb_connection_has_error(c) || (now = benchclock()) >= deadline)
+        {   return NULL;
+        }
+        poll(&pfd, 1, (deadline - now) / 1000000 + 1);
+    }
+    return ev;
+}
+
+void
+benchlabel(FILE *f)
+{
+    const char *label = getenv("BENCH_LABEL");
+    const char *s;
+    fputs("\"label\":\"", f);
+    for(s = label ? label : "unknown"; *s; ++s)
+    {
+        if(*s != '"' && *s != '\\')
+        {   fputc(*s, f);
+        }
+    }
+    fputc('"', f);
+}
@@ -0,0 +1,52 @@
+/* See LICENSE file for copyright and license details. */
+#ifndef BENCH_H_
+#define BENCH_H_
+
+/* Shared helpers for the benchmark clients in bench/.
+ * These are plain xcb clients (libxcb only) so they measure the WM and not xcb_trl.
+ * Every benchmark prints one JSON object per run on stdout so results can be kept as .jsonl and compared across commits.
+ */
+
+#include <xcb/xcb.h>
+
+#include "../util.h"
+
+/* same as XCB_EVENT_RESPONSE_TYPE() without needing xcb-util */
+#define EVTYPE(E)               ((E)->response_type & ~0x80)
+
+typedef struct Dist Dist;
+
+struct Dist
+{
+    u64 *v;                     /* samples (ns)                     */
+    u32 n;                      /* samples used                     */
+    u32 max;                    /* samples allocated                */
+};
+
+/* RETURN: CLOCK_MONOTONIC in ns. */
+u64 benchclock(void);
+/* RETURN: CPU time used by pid in ns (schedstat, else stat).
+ * RETURN: 0 if pid is 0 or cannot be read.
+ */
+u64 benchcpu(int pid);
+/* Adds a sample. */
+void distadd(Dist *d, u64 v);
+/* Prints "name":{"n":N,"min":...,"p50":...,"p90":...,"p99":...,"max":...,"mean":...} sorting the samples. */
+void distprint(FILE *f, const char *name, Dist *d);
+void distfree(Dist *d);
+/* RETURN: the atom for name, interning it if needed. */
+xcb_atom_t benchatom(xcb_connection_t *c, const char *name);
+/* Waits for a WM to set _NET_SUPPORTING_WM_CHECK on root.
+ * RETURN: 1 on Success.
+ * RETURN: 0 on timeout.
+ */
+int benchwaitwm(xcb_connection_t *c, xcb_window_t root, u64 timeoutns);
+/* Waits for the next event until deadline (benchclock() ns).
+ * RETURN: the event (caller frees) on Success.
+ * RETURN: NULL on timeout or connection error.
+ */
+xcb_generic_event_t *benchwaitevent(xcb_connection_t *c, u64 deadline);
+/* Prints the label field, "label":"..." using $BENCH_LABEL or "unknown". */
+void benchlabel(FILE *f);
+
+#endif
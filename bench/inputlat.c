@@ -0,0 +1,393 @@
+/* See LICENSE file for copyright and license details. */
+
+/* Input to action latency benchmark.
+ * Injects input with XTest and measures the time until the effect is visible to this (observer) client:
+ *
+ * layout-*     SUPER+z/c/g/x (SetWindowLayout)     until a ConfigureNotify on one of our windows.
+ * spawn        SUPER+Return (SpawnWindow)          until a new top level window is mapped, see -child.
+ * focus        pointer moved onto another window   until FocusIn on it (FocusMonitor has no binding,
+ *                                                  this is the same focus()/setfocus() path).
+ * resize       SUPER+RMB drag (ResizeWindow)       until a ConfigureNotify on the dragged window.
+ *
+ * Prints one JSON object per case with the latency distribution.
+ *
+ * usage: inputlat [-r runs] [-c case] [-t timeoutms]
+ *        inputlat -child       maps a single window and exits once it is destroyed,
+ *                              used as the terminal SpawnWindow starts (see bench/inputlat.sh).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <inttypes.h>
+
+#include <xcb/xtest.h>
+#include <X11/keysym.h>
+
+#include "bench.h"
+
+#define WINDOWS         3
+/* events that arrive this long after a run are leftovers from it */
+#define SETTLE_NS       (50 * 1000000)
+
+enum { EffectConfigure, EffectMap, EffectFocus };
+
+typedef struct Case Case;
+typedef struct Bench Bench;
+
+struct Case
+{
+    const char *name;
+    xcb_keysym_t keysym;        /* 0 for pointer only cases                             */
+    xcb_keysym_t from;          /* pressed (unmeasured) before keysym on every run      */
+    u8 button;                  /* pressed with SUPER instead of a key, 0 for none      */
+    u8 effect;
+};
+
+struct Bench
+{
+    xcb_connection_t *c;
+    xcb_screen_t *screen;
+    xcb_window_t wins[WINDOWS];
+    xcb_keycode_t super;
+    u64 timeout;
+};
+
+/* Every layout run switches from another layout first so the press changes the geometry of at least one window.
+ * Tiled goes last, focus and resize need the windows side by side.
+ */
+static const Case cases[] =
+{
+    { "layout-floating",    XK_x,       XK_z,   0,  EffectConfigure },
+    { "layout-monocle",     XK_c,       XK_x,   0,  EffectConfigure },
+    { "layout-grid",        XK_g,       XK_c,   0,  EffectConfigure },
+    { "layout-tiled",       XK_z,       XK_g,   0,  EffectConfigure },
+    { "spawn",              XK_Return,  0,      0,  EffectMap },
+    { "focus",              0,          0,      0,  EffectFocus },
+    { "resize",             0,          0,      3,  EffectConfigure },
+};
+
+static xcb_keycode_t
+keycode(xcb_connection_t *c, xcb_keysym_t keysym)
+{
+    const xcb_setup_t *setup = xcb_get_setup(c);
+    const u8 count = setup->max_keycode - setup->min_keycode + 1;
+    xcb_get_keyboard_mapping_reply_t *reply;
+    xcb_keysym_t *syms;
+    xcb_keycode_t code = 0;
+    u32 i;
+
+    reply = xcb_get_keyboard_mapping_reply(c, xcb_get_keyboard_mapping(c, setup->min_keycode, count), NULL);
+    if(!reply)
+    {   return 0;
+    }
+    syms = xcb_get_keyboard_mapping_keysyms(reply);
+    for(i = 0; i < count * reply->keysyms_per_keycode; ++i)
+    {
+        if(syms[i] == keysym)
+        {   code = setup->min_keycode + i / reply->keysyms_per_keycode;
+            break;
+        }
+    }
+    free(reply);
+    return code;
+}
+
+static void
+fake(Bench *b, u8 type, u8 detail, i16 x, i16 y)
+{
+    xcb_test_fake_input(b->c, type, detail, XCB_CURRENT_TIME, type == XCB_MOTION_NOTIFY ? b->screen->root : XCB_NONE, x, y, 0);
+}
+
+static int
+center(Bench *b, xcb_window_t win, i16 *x, i16 *y)
+{
+    xcb_get_geometry_reply_t *g = xcb_get_geometry_reply(b->c, xcb_get_geometry(b->c, win), NULL);
+    if(!g)
+    {   return 0;
+    }
+    *x = g->x + g->width / 2;
+    *y = g->y + g->height / 2;
+    free(g);
+    return 1;
+}
+
+static void
+press(Bench *b, xcb_keycode_t key)
+{
+    fake(b, XCB_KEY_PRESS, b->super, 0, 0);
+    fake(b, XCB_KEY_PRESS, key, 0, 0);
+    fake(b, XCB_KEY_RELEASE, key, 0, 0);
+    fake(b, XCB_KEY_RELEASE, b->super, 0, 0);
+    xcb_flush(b->c);
+}
+
+static xcb_window_t
+createwin(Bench *b, u32 mask)
+{
+    const xcb_window_t win = xcb_generate_id(b->c);
+    xcb_create_window(b->c, XCB_COPY_FROM_PARENT, win, b->screen->root, 0, 0, 300, 200, 0,
+            XCB_WINDOW_CLASS_INPUT_OUTPUT, b->screen->root_visual, XCB_CW_EVENT_MASK, &mask);
+    xcb_map_window(b->c, win);
+    xcb_flush(b->c);
+    return win;
+}
+
+static i32
+ours(const Bench *b, xcb_window_t win)
+{
+    i32 i;
+    for(i = 0; i < WINDOWS; ++i)
+    {
+        if(b->wins[i] == win)
+        {   return i;
+        }
+    }
+    return -1;
+}
+
+/* drops everything until nothing arrived for SETTLE_NS */
+static void
+settle(Bench *b)
+{
+    xcb_generic_event_t *ev;
+    while((ev = benchwaitevent(b->c, benchclock() + SETTLE_NS)))
+    {   free(ev);
+    }
+}
+
+/* RETURN: 1 if ev is the effect we are waiting for. */
+static int
+iseffect(Bench *b, xcb_generic_event_t *ev, u8 effect, xcb_window_t target)
+{
+    switch(EVTYPE(ev))
+    {
+        case XCB_CONFIGURE_NOTIFY:
+        {
+            const xcb_configure_notify_event_t *cev = (xcb_configure_notify_event_t *)ev;
+            return effect == EffectConfigure && (target ? cev->window == target : ours(b, cev->window) >= 0);
+        }
+        case XCB_MAP_NOTIFY:
+        {
+            const xcb_map_notify_event_t *mev = (xcb_map_notify_event_t *)ev;
+            /* SubstructureNotify on the root, someone else's window */
+            if(effect == EffectMap && mev->event == b->screen->root && ours(b, mev->window) < 0 && !mev->override_redirect)
+            {   /* any client may destroy any window, -child exits once it is gone */
+                xcb_destroy_window(b->c, mev->window);
+                return 1;
+            }
+            return 0;
+        }
+        case XCB_FOCUS_IN:
+            return effect == EffectFocus && ((xcb_focus_in_event_t *)ev)->event == target;
+    }
+    return 0;
+}
+
+/* RETURN: latency in ns, 0 on timeout. */
+static u64
+runcase(Bench *b, const Case *cs, u32 run)
+{
+    xcb_generic_event_t *ev;
+    xcb_window_t target = XCB_NONE;
+    xcb_keycode_t key = 0;
+    xcb_keycode_t from;
+    i16 x;
+    i16 y;
+    u64 start;
+    u64 latency = 0;
+
+    if(cs->keysym)
+    {
+        if(!(key = keycode(b->c, cs->keysym)))
+        {   return 0;
+        }
+        if(cs->from && (from = keycode(b->c, cs->from)))
+        {   press(b, from);
+            settle(b);
+        }
+        fake(b, XCB_KEY_PRESS, b->super, 0, 0);
+        start = benchclock();
+        fake(b, XCB_KEY_PRESS, key, 0, 0);
+    }
+    else if(cs->button)
+    {
+        /* drag the middle of a window 40px further */
+        target = b->wins[run % WINDOWS];
+        if(!center(b, target, &x, &y))
+        {   return 0;
+        }
+        fake(b, XCB_MOTION_NOTIFY, 0, x, y);
+        fake(b, XCB_KEY_PRESS, b->super, 0, 0);
+        fake(b, XCB_BUTTON_PRESS, cs->button, 0, 0);
+        xcb_flush(b->c);
+        settle(b);
+        start = benchclock();
+        fake(b, XCB_MOTION_NOTIFY, 0, x + 40, y + 40);
+    }
+    else
+    {
+        /* start on one window so moving to the next always crosses into another one */
+        target = b->wins[(run + 1) % WINDOWS];
+        if(!center(b, b->wins[run % WINDOWS], &x, &y))
+        {   return 0;
+        }
+        fake(b, XCB_MOTION_NOTIFY, 0, x, y);
+        xcb_flush(b->c);
+        settle(b);
+        if(!center(b, target, &x, &y))
+        {   return 0;
+        }
+        start = benchclock();
+        fake(b, XCB_MOTION_NOTIFY, 0, x, y);
+    }
+    xcb_flush(b->c);
+
+    while((ev = benchwaitevent(b->c, start + b->timeout)))
+    {
+        const u64 now = benchclock();
+        const int done = iseffect(b, ev, cs->effect, target);
+        free(ev);
+        if(done)
+        {   latency = now - start;
+            break;
+        }
+    }
+
+    if(cs->button)
+    {   fake(b, XCB_BUTTON_RELEASE, cs->button, 0, 0);
+    }
+    if(key)
+    {   fake(b, XCB_KEY_RELEASE, key, 0, 0);
+    }
+    if(key || cs->button)
+    {   fake(b, XCB_KEY_RELEASE, b->super, 0, 0);
+    }
+    xcb_flush(b->c);
+    settle(b);
+    return latency;
+}
+
+static int
+child(void)
+{
+    xcb_connection_t *c = xcb_connect(NULL, NULL);
+    xcb_generic_event_t *ev;
+    xcb_screen_t *screen;
+    xcb_window_t win;
+    u32 mask = XCB_EVENT_MASK_STRUCTURE_NOTIFY;
+    u8 destroyed = 0;
+
+    if(xcb_connection_has_error(c))
+    {   return EXIT_FAILURE;
+    }
+    screen = xcb_setup_roots_iterator(xcb_get_setup(c)).data;
+    win = xcb_generate_id(c);
+    xcb_create_window(c, XCB_COPY_FROM_PARENT, win, screen->root, 0, 0, 300, 200, 0,
+            XCB_WINDOW_CLASS_INPUT_OUTPUT, screen->root_visual, XCB_CW_EVENT_MASK, &mask);
+    xcb_map_window(c, win);
+    xcb_flush(c);
+    while(!destroyed && (ev = xcb_wait_for_event(c)))
+    {   destroyed = EVTYPE(ev) == XCB_DESTROY_NOTIFY;
+        free(ev);
+    }
+    xcb_disconnect(c);
+    return EXIT_SUCCESS;
+}
+
+static void
+usage(void)
+{
+    fputs("usage: inputlat [-r runs] [-c case] [-t timeoutms] | inputlat -child\n", stderr);
+    exit(EXIT_FAILURE);
+}
+
+int
+main(int argc, char **argv)
+{
+    Bench b;
+    const char *only = NULL;
+    u32 runs = 50;
+    u32 i;
+    u32 j;
+    u32 timeouts;
+    u64 latency;
+    Dist dist = { 0 };
+
+    memset(&b, 0, sizeof(Bench));
+    b.timeout = 2000;
+    for(i = 1; i < (u32)argc; ++i)
+    {
+        if(!strcmp(argv[i], "-child"))
+        {   return child();
+        }
+        else if(i + 1 == (u32)argc)
+        {   usage();
+        }
+        else if(!strcmp(argv[i], "-r"))
+        {   runs = strtoul(argv[++i], NULL, 0);
+        }
+        else if(!strcmp(argv[i], "-c"))
+        {   only = argv[++i];
+        }
+        else if(!strcmp(argv[i], "-t"))
+        {   b.timeout = strtoull(argv[++i], NULL, 0);
+        }
+        else
+        {   usage();
+        }
+    }
+    b.timeout *= 1000000;
+
+    int scr;
+    b.c = xcb_connect(NULL, &scr);
+    if(xcb_connection_has_error(b.c))
+    {   DIE("%s", "cannot open display");
+    }
+    xcb_screen_iterator_t it = xcb_setup_roots_iterator(xcb_get_setup(b.c));
+    for(; scr > 0 && it.rem; --scr, xcb_screen_next(&it));
+    b.screen = it.data;
+
+    const xcb_query_extension_reply_t *xtest = xcb_get_extension_data(b.c, &xcb_test_id);
+    if(!xtest || !xtest->present)
+    {   DIE("%s", "the XServer has no XTEST extension");
+    }
+    if(!(b.super = keycode(b.c, XK_Super_L)))
+    {   DIE("%s", "Super_L is not in the keymap");
+    }
+
+    /* see other clients being mapped, for spawn */
+    const u32 rootmask = XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY;
+    xcb_change_window_attributes(b.c, b.screen->root, XCB_CW_EVENT_MASK, &rootmask);
+    for(i = 0; i < WINDOWS; ++i)
+    {   b.wins[i] = createwin(&b, XCB_EVENT_MASK_STRUCTURE_NOTIFY | XCB_EVENT_MASK_FOCUS_CHANGE);
+    }
+    settle(&b);
+
+    for(i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i)
+    {
+        if(only && strcmp(only, cases[i].name))
+        {   continue;
+        }
+        timeouts = 0;
+        for(j = 0; j < runs; ++j)
+        {
+            if((latency = runcase(&b, cases + i, j)))
+            {   distadd(&dist, latency);
+            }
+            else
+            {   ++timeouts;
+            }
+        }
+        fputs("{\"bench\":\"inputlat\",", stdout);
+        benchlabel(stdout);
+        printf(",\"case\":\"%s\",\"runs\":%u,\"timeouts\":%u,", cases[i].name, runs, timeouts);
+        distprint(stdout, "latency_ns", &dist);
+        fputs("}\n", stdout);
+        fflush(stdout);
+        distfree(&dist);
+    }
+    xcb_disconnect(b.c);
+    return EXIT_SUCCESS;
+}
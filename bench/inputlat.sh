@@ -0,0 +1,45 @@
+#!/bin/sh
+# See LICENSE file for copyright and license details.
+#
+# Runs bench/inputlat against the WM on a private Xvfb and prints one JSON object per case (jsonl).
+# The terminal SpawnWindow starts is replaced by "inputlat -child" so spawn measures the WM and not st.
+#
+# usage: bench/inputlat.sh [wm] >> inputlat.jsonl
+#
+# RUNS      injections per case             (default: 50)
+# CASES     cases to run                    (default: all)
+# REPEAT    runs of the whole set           (default: 3)
+# BENCH_LABEL  label stored with every result (default: git describe of the tree)
+
+BENCH=$(dirname "$0")
+. "$BENCH/lib.sh"
+
+WM=${1:-$BENCH/../binary/dwm}
+RUNS=${RUNS:-50}
+REPEAT=${REPEAT:-3}
+
+[ -x "$BENCH/inputlat" ] || die "$BENCH/inputlat not found, run make bench first"
+[ -x "$BENCH/maplat" ] || die "$BENCH/maplat not found, run make bench first"
+
+inputlat=$(cd "$BENCH" && pwd)/inputlat
+printf '#!/bin/sh\nexec "%s" -child\n' "$inputlat" > "$tmp/st"
+chmod +x "$tmp/st"
+startwm "$WM" "$tmp"
+
+rc=0
+i=0
+while [ "$i" -lt "$REPEAT" ]
+do
+    if [ -n "$CASES" ]
+    then
+        for case in $CASES
+        do
+            "$BENCH/inputlat" -r "$RUNS" -c "$case" || rc=1
+        done
+    else
+        "$BENCH/inputlat" -r "$RUNS" || rc=1
+    fi
+    checkwm
+    i=$((i + 1))
+done
+exit $rc
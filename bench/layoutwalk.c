@@ -0,0 +1,417 @@
+/* See LICENSE file for copyright and license details. */
+
+/* Layout walk benchmark.
+ * Runs the list walks of one arrange, the nexttiled() count and place passes of tile() and restack()'s stack passes,
+ * over a desktop of N clients and reports the time and, if perf_event_open() is allowed, the cache misses per arrange.
+ * It does this twice: for Client as it is (dwm.h), and for "flat", the same fields in one struct like Client was before
+ * ClientInfo was split off, so a single run shows what the layout is worth.
+ * Caches are flushed before every arrange (unless -w), an arrange normally runs after X events evicted the clients.
+ * No XServer is needed.
+ *
+ * usage: layoutwalk [-n clients] [-r arranges] [-f floatingpercent] [-e evictMB] [-w]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "bench.h"
+#include "../dwm.h"
+
+typedef struct Flat Flat;
+typedef struct Counters Counters;
+
+/* Client before the hot/cold split, field for field */
+struct Flat
+{
+    int16_t x, y;
+    uint16_t w, h;
+    int16_t oldx, oldy;
+    uint16_t oldw, oldh;
+    uint16_t flags;
+    XCBWindow win;
+    Flat *next, *snext, *prev, *sprev;
+    Monitor *mon;
+    Desktop *desktop;
+    uint16_t bw, oldbw;
+    float mina, maxa;
+    uint16_t basew, baseh, incw, inch, maxw, maxh, minw, minh;
+    XCBSyncCounter counter;
+    int16_t savex, savey;
+    uint16_t savew, saveh;
+    pid_t pid;
+    char *name;
+    uint32_t focusfights;
+    Idle reconfigure;
+    uint16_t confpending, confmask;
+    int16_t confx, confy;
+    uint16_t confw, confh, confbw, confrepeat;
+    uint64_t conftime;
+    Flat *wnext;
+    Timer grace;
+    uint32_t tags;
+    uint8_t pad0[8];
+};
+
+struct Counters
+{
+    int l1d;                    /* L1D read misses, -1 if unavailable   */
+    int llc;                    /* LLC misses, -1 if unavailable        */
+    Dist l1ddist;
+    Dist llcdist;
+    Dist nsdist;
+};
+
+/* what the walks compute, so they are not optimized out */
+static volatile u64 sink;
+
+static int
+perfopen(u32 type, u64 config)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static void
+countstart(Counters *k)
+{
+    if(k->l1d >= 0)
+    {   ioctl(k->l1d, PERF_EVENT_IOC_RESET, 0);
+        ioctl(k->l1d, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    if(k->llc >= 0)
+    {   ioctl(k->llc, PERF_EVENT_IOC_RESET, 0);
+        ioctl(k->llc, PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+static void
+countstop(Counters *k, u64 start)
+{
+    const u64 end = benchclock();
+    u64 v;
+    if(k->l1d >= 0)
+    {
+        ioctl(k->l1d, PERF_EVENT_IOC_DISABLE, 0);
+        if(read(k->l1d, &v, sizeof(v)) == sizeof(v))
+        {   distadd(&k->l1ddist, v);
+        }
+    }
+    if(k->llc >= 0)
+    {
+        ioctl(k->llc, PERF_EVENT_IOC_DISABLE, 0);
+        if(read(k->llc, &v, sizeof(v)) == sizeof(v))
+        {   distadd(&k->llcdist, v);
+        }
+    }
+    distadd(&k->nsdist, end - start);
+}
+
+static void
+evict(u8 *buf, size_t size)
+{
+    size_t i;
+    for(i = 0; i < size; i += 64)
+    {   ++buf[i];
+    }
+}
+
+static Client *
+nexttiledsplit(Client *c)
+{
+    for(; c && (!ISVISIBLE(c) || ISFLOATING(c)); c = c->next);
+    return c;
+}
+
+/* tile() and restack() over Client, like resize() it only writes when the geometry changes */
+static u64
+arrangesplit(Desktop *desk, Monitor *m)
+{
+    Client *c;
+    u32 n, i;
+    u16 h, ty;
+    u64 sum = 0;
+
+    for(n = 0, c = nexttiledsplit(desk->clients); c; c = nexttiledsplit(c->next))
+    {   ++n;
+    }
+    for(i = ty = 0, c = nexttiledsplit(desk->clients); c; c = nexttiledsplit(c->next), ++i)
+    {
+        h = (m->wh - ty) / (n - i);
+        if(c->x != m->wx || c->y != m->wy + ty || c->w != m->ww - (c->bw << 1) || c->h != h - (c->bw << 1))
+        {
+            c->info->oldx = c->x;
+            c->info->oldy = c->y;
+            c->info->oldw = c->w;
+            c->info->oldh = c->h;
+            c->x = m->wx;
+            c->y = m->wy + ty;
+            c->w = m->ww - (c->bw << 1);
+            c->h = h - (c->bw << 1);
+        }
+        ty += HEIGHT(c);
+    }
+    for(c = desk->stack; c; c = c->snext)
+    {   sum += c->win;
+    }
+    for(c = desk->stack; c; c = c->snext)
+    {   sum += ISFLOATING(c) && ISVISIBLE(c);
+    }
+    for(c = desk->stack; c; c = c->snext)
+    {   sum += ISALWAYSONTOP(c) && ISVISIBLE(c);
+    }
+    for(c = desk->stack; c; c = c->snext)
+    {   sum += ISDIALOG(c) && ISVISIBLE(c);
+    }
+    for(c = desk->stack; c; c = c->snext)
+    {   sum += ISMODAL(c) && ISVISIBLE(c);
+    }
+    return sum + n;
+}
+
+static Flat *
+nexttiledflat(Flat *c)
+{
+    for(; c && (!ISVISIBLE(c) || ISFLOATING(c)); c = c->next);
+    return c;
+}
+
+/* arrangesplit() over Flat */
+static u64
+arrangeflat(Flat *clients, Flat *stack, Monitor *m)
+{
+    Flat *c;
+    u32 n, i;
+    u16 h, ty;
+    u64 sum = 0;
+
+    for(n = 0, c = nexttiledflat(clients); c; c = nexttiledflat(c->next))
+    {   ++n;
+    }
+    for(i = ty = 0, c = nexttiledflat(clients); c; c = nexttiledflat(c->next), ++i)
+    {
+        h = (m->wh - ty) / (n - i);
+        if(c->x != m->wx || c->y != m->wy + ty || c->w != m->ww - (c->bw << 1) || c->h != h - (c->bw << 1))
+        {
+            c->oldx = c->x;
+            c->oldy = c->y;
+            c->oldw = c->w;
+            c->oldh = c->h;
+            c->x = m->wx;
+            c->y = m->wy + ty;
+            c->w = m->ww - (c->bw << 1);
+            c->h = h - (c->bw << 1);
+        }
+        ty += HEIGHT(c);
+    }
+    for(c = stack; c; c = c->snext)
+    {   sum += c->win;
+    }
+    for(c = stack; c; c = c->snext)
+    {   sum += ISFLOATING(c) && ISVISIBLE(c);
+    }
+    for(c = stack; c; c = c->snext)
+    {   sum += ISALWAYSONTOP(c) && ISVISIBLE(c);
+    }
+    for(c = stack; c; c = c->snext)
+    {   sum += ISDIALOG(c) && ISVISIBLE(c);
+    }
+    for(c = stack; c; c = c->snext)
+    {   sum += ISMODAL(c) && ISVISIBLE(c);
+    }
+    return sum + n;
+}
+
+static void
+print(const char *layout, u32 n, u32 floatpct, u8 warm, size_t size, Counters *k)
+{
+    fputs("{\"bench\":\"layoutwalk\",", stdout);
+    benchlabel(stdout);
+    printf(",\"layout\":\"%s\",\"clients\":%u,\"floating_pct\":%u,\"warm\":%u,\"client_bytes\":%zu,",
+            layout, n, floatpct, warm, size);
+    distprint(stdout, "arrange_ns", &k->nsdist);
+    fputc(',', stdout);
+    distprint(stdout, "l1d_misses", &k->l1ddist);
+    fputc(',', stdout);
+    distprint(stdout, "llc_misses", &k->llcdist);
+    fputs("}\n", stdout);
+    fflush(stdout);
+    distfree(&k->nsdist);
+    distfree(&k->l1ddist);
+    distfree(&k->llcdist);
+}
+
+static void
+usage(void)
+{
+    fputs("usage: layoutwalk [-n clients] [-r arranges] [-f floatingpercent] [-e evictMB] [-w]\n", stderr);
+    exit(EXIT_FAILURE);
+}
+
+int
+main(int argc, char **argv)
+{
+    u32 n = 1000;
+    u32 runs = 200;
+    u32 floatpct = 10;
+    size_t evictsize = 64;
+    u8 warm = 0;
+    Pool clientpool, infopool, flatpool;
+    Monitor mon;
+    Desktop desk;
+    Client **clients;
+    Flat **flats;
+    Client *tc;
+    Flat *tf;
+    Flat *flathead = NULL;
+    Flat *flatstack = NULL;
+    Counters k;
+    u8 *buf;
+    u64 start;
+    u32 i, j;
+    int a;
+
+    for(a = 1; a < argc; ++a)
+    {
+        if(!strcmp(argv[a], "-w"))
+        {   warm = 1;
+        }
+        else if(a + 1 == argc)
+        {   usage();
+        }
+        else if(!strcmp(argv[a], "-n"))
+        {   n = strtoul(argv[++a], NULL, 0);
+        }
+        else if(!strcmp(argv[a], "-r"))
+        {   runs = strtoul(argv[++a], NULL, 0);
+        }
+        else if(!strcmp(argv[a], "-f"))
+        {   floatpct = strtoul(argv[++a], NULL, 0);
+        }
+        else if(!strcmp(argv[a], "-e"))
+        {   evictsize = strtoul(argv[++a], NULL, 0);
+        }
+        else
+        {   usage();
+        }
+    }
+    if(!n || !runs)
+    {   usage();
+    }
+    evictsize <<= 20;
+
+    memset(&mon, 0, sizeof(Monitor));
+    memset(&desk, 0, sizeof(Desktop));
+    mon.ww = 1920;
+    mon.wh = 1080;
+    mon.desksel = &desk;
+    mon.desktops = &desk;
+    mon.deskcount = 1;
+    mon.tagset = TAGBIT(&desk);
+
+    /* same pools as setup() with the default CFG_MAX_CLIENT_COUNT and CFG_DESKTOP_COUNT, one desktop is one group */
+    poolinit(&clientpool, sizeof(Client), 256 / 10);
+    poolinit(&infopool, sizeof(ClientInfo), 256);
+    poolinit(&flatpool, sizeof(Flat), 256);
+    clients = malloc(n * sizeof(Client *));
+    flats = malloc(n * sizeof(Flat *));
+    buf = calloc(1, evictsize + 1);
+    if(!clients || !flats || !buf)
+    {   DIE("%s", "out of memory");
+    }
+    for(i = 0; i < n; ++i)
+    {
+        /* allocated like createclient() would, interleaved */
+        clients[i] = poolalloc(&clientpool);
+        flats[i] = poolalloc(&flatpool);
+        if(!clients[i] || !flats[i] || !(clients[i]->info = poolalloc(&infopool)))
+        {   DIE("%s", "out of memory");
+        }
+        clients[i]->win = flats[i]->win = 0x200000 + i;
+        clients[i]->bw = flats[i]->bw = 1;
+        clients[i]->flags = flats[i]->flags = (i * 100 / n) % 100 < floatpct ? _FLOATING : 0;
+        clients[i]->mon = flats[i]->mon = &mon;
+        clients[i]->desktop = flats[i]->desktop = &desk;
+        clients[i]->tags = flats[i]->tags = TAGBIT(&desk);
+        /* attach() prepends */
+        clients[i]->next = desk.clients;
+        desk.clients = clients[i];
+        flats[i]->next = flathead;
+        flathead = flats[i];
+    }
+    /* the stack is in focus order, not map order */
+    srand(1);
+    for(i = n; i-- > 1;)
+    {
+        j = rand() % (i + 1);
+        tc = clients[i];
+        clients[i] = clients[j];
+        clients[j] = tc;
+        tf = flats[i];
+        flats[i] = flats[j];
+        flats[j] = tf;
+    }
+    for(i = 0; i < n; ++i)
+    {
+        clients[i]->snext = desk.stack;
+        desk.stack = clients[i];
+        flats[i]->snext = flatstack;
+        flatstack = flats[i];
+    }
+
+    memset(&k, 0, sizeof(Counters));
+    k.l1d = perfopen(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    k.llc = perfopen(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+
+    /* the first arrange places every client, the rest only walk */
+    sink += arrangesplit(&desk, &mon);
+    sink += arrangeflat(flathead, flatstack, &mon);
+    for(i = 0; i < runs; ++i)
+    {
+        if(!warm)
+        {   evict(buf, evictsize);
+        }
+        countstart(&k);
+        start = benchclock();
+        sink += arrangesplit(&desk, &mon);
+        countstop(&k, start);
+    }
+    print("split", n, floatpct, warm, sizeof(Client), &k);
+    for(i = 0; i < runs; ++i)
+    {
+        if(!warm)
+        {   evict(buf, evictsize);
+        }
+        countstart(&k);
+        start = benchclock();
+        sink += arrangeflat(flathead, flatstack, &mon);
+        countstop(&k, start);
+    }
+    print("flat", n, floatpct, warm, sizeof(Flat), &k);
+
+    if(k.l1d >= 0)
+    {   close(k.l1d);
+    }
+    if(k.llc >= 0)
+    {   close(k.llc);
+    }
+    pooldestroy(&clientpool);
+    pooldestroy(&infopool);
+    pooldestroy(&flatpool);
+    free(clients);
+    free(flats);
+    free(buf);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,54 @@
+# See LICENSE file for copyright and license details.
+#
+# Sourced by the bench/*.sh drivers.
+# startwm WM [PATH_PREFIX] starts Xvfb on a free display and WM on it, exporting DISPLAY.
+# $tmp is a scratch directory removed on exit together with Xvfb and the WM.
+
+BENCH=${BENCH:-$(dirname "$0")}
+TIMEOUT=${TIMEOUT:-30000}
+BENCH_LABEL=${BENCH_LABEL:-$(git -C "$BENCH" describe --always --dirty 2>/dev/null || echo unknown)}
+export BENCH_LABEL
+
+die()
+{
+    echo "$(basename "$0"): $*" >&2
+    exit 1
+}
+
+tmp=$(mktemp -d) || die "mktemp failed"
+wm=
+xvfb=
+cleanup()
+{
+    [ -n "$wm" ] && kill "$wm" 2>/dev/null
+    [ -n "$xvfb" ] && kill "$xvfb" 2>/dev/null
+    rm -rf "$tmp"
+}
+trap cleanup EXIT
+trap 'exit 1' INT TERM
+
+startwm()
+{
+    [ -x "$1" ] || die "$1 not found, run make first"
+    command -v Xvfb >/dev/null || die "Xvfb not found"
+
+    # let Xvfb pick a free display and tell us which one
+    Xvfb -displayfd 3 -screen 0 1920x1080x24 -nolisten tcp 3>"$tmp/display" 2>"$tmp/xvfb.log" &
+    xvfb=$!
+    while [ ! -s "$tmp/display" ]
+    do
+        kill -0 "$xvfb" 2>/dev/null || die "Xvfb failed: $(cat "$tmp/xvfb.log")"
+        sleep 0.1
+    done
+    DISPLAY=:$(cat "$tmp/display")
+    export DISPLAY
+
+    PATH="${2:+$2:}$PATH" "$1" 2>"$tmp/wm.log" &
+    wm=$!
+    "$BENCH/maplat" -w -t 10000 || die "WM did not start: $(cat "$tmp/wm.log")"
+}
+
+checkwm()
+{
+    kill -0 "$wm" 2>/dev/null || die "WM died: $(cat "$tmp/wm.log")"
+}
@@ -0,0 +1,311 @@
+/* See LICENSE file for copyright and license details. */
+
+/* Map latency benchmark.
+ * Creates N top level windows of one kind, maps them back to back (like a dashboard starting up)
+ * and measures per window the time from sending MapWindow, which the WM gets as a MapRequest,
+ * to the first MapNotify and the first ConfigureNotify the window receives.
+ * With -p it also reports the CPU time the WM used per window.
+ *
+ * usage: maplat [-n windows] [-k kind] [-p wmpid] [-t timeoutms] [-w]
+ * kind: plain, transient, dialog, fullscreen, sizehints, mixed (cycles through the others)
+ * -w: only wait (up to the timeout) for a WM to start, then exit.
+ *
+ * See bench/maplat.sh to run it against a private Xvfb.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <inttypes.h>
+
+#include "bench.h"
+
+enum { KindPlain, KindTransient, KindDialog, KindFullscreen, KindSizeHints, KindMixed, KindLast };
+
+typedef struct Win Win;
+typedef struct Run Run;
+
+struct Win
+{
+    xcb_window_t id;
+    u32 index;
+};
+
+struct Run
+{
+    u32 n;
+    Win *sorted;                /* by id, for lookups       */
+    u64 *mapat;                 /* when MapWindow was sent  */
+    u64 *mapped;                /* first MapNotify          */
+    u64 *configured;            /* first ConfigureNotify    */
+    u32 nmapped;
+    u32 nconfigured;
+    u64 last;                   /* last first-event seen    */
+    Dist mapdist;
+    Dist configuredist;
+};
+
+static const char *kinds[KindLast] =
+{
+    [KindPlain] = "plain",
+    [KindTransient] = "transient",
+    [KindDialog] = "dialog",
+    [KindFullscreen] = "fullscreen",
+    [KindSizeHints] = "sizehints",
+    [KindMixed] = "mixed",
+};
+
+static int
+wincmp(const void *a, const void *b)
+{
+    const xcb_window_t x = ((const Win *)a)->id;
+    const xcb_window_t y = ((const Win *)b)->id;
+    return (x > y) - (x < y);
+}
+
+static i32
+winindex(const Win *sorted, u32 n, xcb_window_t id)
+{
+    const Win key = { .id = id };
+    const Win *w = bsearch(&key, sorted, n, sizeof(Win), wincmp);
+    return w ? (i32)w->index : -1;
+}
+
+static void
+onevent(Run *r, xcb_generic_event_t *ev)
+{
+    const u64 now = benchclock();
+    i32 idx;
+    switch(EVTYPE(ev))
+    {
+        case XCB_MAP_NOTIFY:
+            idx = winindex(r->sorted, r->n, ((xcb_map_notify_event_t *)ev)->window);
+            if(idx >= 0 && !r->mapped[idx])
+            {   r->mapped[idx] = now;
+                distadd(&r->mapdist, now - r->mapat[idx]);
+                ++r->nmapped;
+                r->last = now;
+            }
+            break;
+        /* synthetic (from the WM) or real, whichever comes first */
+        case XCB_CONFIGURE_NOTIFY:
+            idx = winindex(r->sorted, r->n, ((xcb_configure_notify_event_t *)ev)->window);
+            if(idx >= 0 && !r->configured[idx])
+            {   r->configured[idx] = now;
+                distadd(&r->configuredist, now - r->mapat[idx]);
+                ++r->nconfigured;
+                r->last = now;
+            }
+            break;
+    }
+    free(ev);
+}
+
+static void
+sethints(xcb_connection_t *c, xcb_window_t win, u8 kind, xcb_window_t leader)
+{
+    static xcb_atom_t type, dialog, state, fullscreen;
+    /* min == max, a fixed size window */
+    const u32 sizehints[18] = { 16 | 32, 0, 0, 0, 0, 200, 150, 200, 150 };
+    static const char name[] = "maplat";
+
+    if(!type)
+    {
+        type = benchatom(c, "_NET_WM_WINDOW_TYPE");
+        dialog = benchatom(c, "_NET_WM_WINDOW_TYPE_DIALOG");
+        state = benchatom(c, "_NET_WM_STATE");
+        fullscreen = benchatom(c, "_NET_WM_STATE_FULLSCREEN");
+    }
+    xcb_change_property(c, XCB_PROP_MODE_REPLACE, win, XCB_ATOM_WM_NAME, XCB_ATOM_STRING, 8, sizeof(name) - 1, name);
+    switch(kind)
+    {
+        case KindTransient:
+            xcb_change_property(c, XCB_PROP_MODE_REPLACE, win, XCB_ATOM_WM_TRANSIENT_FOR, XCB_ATOM_WINDOW, 32, 1, &leader);
+            break;
+        case KindDialog:
+            xcb_change_property(c, XCB_PROP_MODE_REPLACE, win, type, XCB_ATOM_ATOM, 32, 1, &dialog);
+            break;
+        case KindFullscreen:
+            xcb_change_property(c, XCB_PROP_MODE_REPLACE, win, state, XCB_ATOM_ATOM, 32, 1, &fullscreen);
+            break;
+        case KindSizeHints:
+            xcb_change_property(c, XCB_PROP_MODE_REPLACE, win, XCB_ATOM_WM_NORMAL_HINTS, XCB_ATOM_WM_SIZE_HINTS, 32, 18, sizehints);
+            break;
+    }
+}
+
+static xcb_window_t
+createwin(xcb_connection_t *c, xcb_screen_t *screen, i16 x, i16 y)
+{
+    const xcb_window_t win = xcb_generate_id(c);
+    const u32 mask = XCB_EVENT_MASK_STRUCTURE_NOTIFY;
+    xcb_create_window(c, XCB_COPY_FROM_PARENT, win, screen->root, x, y, 200, 150, 0,
+            XCB_WINDOW_CLASS_INPUT_OUTPUT, screen->root_visual, XCB_CW_EVENT_MASK, &mask);
+    return win;
+}
+
+static void
+roundtrip(xcb_connection_t *c)
+{
+    free(xcb_get_input_focus_reply(c, xcb_get_input_focus(c), NULL));
+}
+
+static void
+usage(void)
+{
+    fputs("usage: maplat [-n windows] [-k plain|transient|dialog|fullscreen|sizehints|mixed] [-p wmpid] [-t timeoutms] [-w]\n", stderr);
+    exit(EXIT_FAILURE);
+}
+
+int
+main(int argc, char **argv)
+{
+    u32 n = 100;
+    u8 kind = KindPlain;
+    int pid = 0;
+    u64 timeout = 10000;
+    u8 waitonly = 0;
+    int i;
+    u32 j;
+
+    for(i = 1; i < argc; ++i)
+    {
+        if(!strcmp(argv[i], "-w"))
+        {   waitonly = 1;
+        }
+        else if(i + 1 == argc)
+        {   usage();
+        }
+        else if(!strcmp(argv[i], "-n"))
+        {   n = strtoul(argv[++i], NULL, 0);
+        }
+        else if(!strcmp(argv[i], "-p"))
+        {   pid = atoi(argv[++i]);
+        }
+        else if(!strcmp(argv[i], "-t"))
+        {   timeout = strtoull(argv[++i], NULL, 0);
+        }
+        else if(!strcmp(argv[i], "-k"))
+        {
+            ++i;
+            for(kind = 0; kind < KindLast && strcmp(kinds[kind], argv[i]); ++kind);
+            if(kind == KindLast)
+            {   usage();
+            }
+        }
+        else
+        {   usage();
+        }
+    }
+    timeout *= 1000000;
+
+    int scr;
+    xcb_connection_t *c = xcb_connect(NULL, &scr);
+    if(xcb_connection_has_error(c))
+    {   DIE("%s", "cannot open display");
+    }
+    xcb_screen_iterator_t it = xcb_setup_roots_iterator(xcb_get_setup(c));
+    for(; scr > 0 && it.rem; --scr, xcb_screen_next(&it));
+    xcb_screen_t *screen = it.data;
+
+    if(waitonly)
+    {
+        i = benchwaitwm(c, screen->root, timeout);
+        xcb_disconnect(c);
+        return i ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    if(!n)
+    {   usage();
+    }
+
+    Win *wins = calloc(n, sizeof(Win));
+    Run r = { .n = n };
+    xcb_window_t leader = XCB_NONE;
+    xcb_generic_event_t *ev;
+
+    r.sorted = calloc(n, sizeof(Win));
+    r.mapat = calloc(n, sizeof(u64));
+    r.mapped = calloc(n, sizeof(u64));
+    r.configured = calloc(n, sizeof(u64));
+    if(!wins || !r.sorted || !r.mapat || !r.mapped || !r.configured)
+    {   DIE("%s", "out of memory");
+    }
+
+    /* transients need a managed parent */
+    if(kind == KindTransient || kind == KindMixed)
+    {
+        leader = createwin(c, screen, 0, 0);
+        sethints(c, leader, KindPlain, XCB_NONE);
+        xcb_map_window(c, leader);
+        xcb_flush(c);
+        while((ev = benchwaitevent(c, benchclock() + timeout)))
+        {
+            j = EVTYPE(ev) == XCB_MAP_NOTIFY;
+            free(ev);
+            if(j)
+            {   break;
+            }
+        }
+    }
+
+    for(j = 0; j < n; ++j)
+    {
+        wins[j].id = createwin(c, screen, (j * 7) % screen->width_in_pixels, (j * 5) % screen->height_in_pixels);
+        wins[j].index = j;
+        sethints(c, wins[j].id, kind == KindMixed ? j % KindMixed : kind, leader);
+    }
+    memcpy(r.sorted, wins, n * sizeof(Win));
+    qsort(r.sorted, n, sizeof(Win), wincmp);
+    /* creation is not what we are measuring */
+    roundtrip(c);
+
+    const u64 cpu0 = benchcpu(pid);
+    const u64 start = benchclock();
+    const u64 deadline = start + timeout;
+
+    r.last = start;
+    for(j = 0; j < n; ++j)
+    {
+        r.mapat[j] = benchclock();
+        xcb_map_window(c, wins[j].id);
+        xcb_flush(c);
+        /* dont let replies from the WM sit in the queue while we are still mapping */
+        while((ev = xcb_poll_for_event(c)))
+        {   onevent(&r, ev);
+        }
+    }
+    while((r.nmapped < n || r.nconfigured < n) && (ev = benchwaitevent(c, deadline)))
+    {   onevent(&r, ev);
+    }
+    /* let the WM finish whatever it queued after the last event we saw */
+    usleep(100000);
+    const u64 cpu = benchcpu(pid) - cpu0;
+
+    fputs("{\"bench\":\"maplat\",", stdout);
+    benchlabel(stdout);
+    printf(",\"kind\":\"%s\",\"windows\":%u,\"mapped\":%u,\"configured\":%u,\"wall_ns\":%"PRIu64",\"wm_cpu_ns\":%"PRIu64",\"wm_cpu_ns_per_window\":%"PRIu64",",
+            kinds[kind], n, r.nmapped, r.nconfigured, r.last - start, cpu, cpu / n);
+    distprint(stdout, "map_ns", &r.mapdist);
+    fputc(',', stdout);
+    distprint(stdout, "configure_ns", &r.configuredist);
+    fputs("}\n", stdout);
+    fflush(stdout);
+
+    for(j = 0; j < n; ++j)
+    {   xcb_destroy_window(c, wins[j].id);
+    }
+    if(leader)
+    {   xcb_destroy_window(c, leader);
+    }
+    roundtrip(c);
+    xcb_disconnect(c);
+    distfree(&r.mapdist);
+    distfree(&r.configuredist);
+    free(wins);
+    free(r.sorted);
+    free(r.mapat);
+    free(r.mapped);
+    free(r.configured);
+    return r.nmapped == n && r.nconfigured == n ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,39 @@
+#!/bin/sh
+# See LICENSE file for copyright and license details.
+#
+# Runs bench/maplat against the WM on a private Xvfb and prints one JSON object per run (jsonl).
+#
+# usage: bench/maplat.sh [wm] >> maplat.jsonl
+#
+# COUNTS    window counts to run            (default: 1 10 100 1000)
+# KINDS     window kinds to run             (default: plain transient dialog fullscreen sizehints mixed)
+# REPEAT    runs per count and kind         (default: 3)
+# TIMEOUT   ms to wait for a single run     (default: 30000)
+# BENCH_LABEL  label stored with every result (default: git describe of the tree)
+
+BENCH=$(dirname "$0")
+. "$BENCH/lib.sh"
+
+WM=${1:-$BENCH/../binary/dwm}
+COUNTS=${COUNTS:-"1 10 100 1000"}
+KINDS=${KINDS:-"plain transient dialog fullscreen sizehints mixed"}
+REPEAT=${REPEAT:-3}
+
+[ -x "$BENCH/maplat" ] || die "$BENCH/maplat not found, run make bench first"
+startwm "$WM"
+
+rc=0
+for n in $COUNTS
+do
+    for kind in $KINDS
+    do
+        i=0
+        while [ "$i" -lt "$REPEAT" ]
+        do
+            "$BENCH/maplat" -n "$n" -k "$kind" -p "$wm" -t "$TIMEOUT" || rc=1
+            checkwm
+            i=$((i + 1))
+        done
+    done
+done
+exit $rc
@@ -0,0 +1,223 @@
+/* See LICENSE file for copyright and license details. */
+
+/* Desktop switch benchmark.
+ * Maps N windows on desktop 0 and N on desktop 1, then switches back and forth with _NET_CURRENT_DESKTOP
+ * (what a pager sends) and measures per switch:
+ *
+ * switch_ns    from sending the ClientMessage until every one of the 2N windows was moved by the XServer
+ *              (a real, not synthetic, ConfigureNotify), the ones leaving and the ones coming.
+ * spread_ns    from the first to the last of those moves, how long a half switched screen could be seen.
+ *              With CFG_DESKTOP_SWITCH_GRAB this should be close to 0.
+ *
+ * usage: switchlat [-n windows] [-r runs] [-t timeoutms]
+ *
+ * See bench/switchlat.sh to run it against a private Xvfb.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <inttypes.h>
+
+#include "bench.h"
+
+/* events that arrive this long after a run are leftovers from it */
+#define SETTLE_NS       (50 * 1000000)
+
+typedef struct Bench Bench;
+
+struct Bench
+{
+    xcb_connection_t *c;
+    xcb_screen_t *screen;
+    xcb_atom_t current;         /* _NET_CURRENT_DESKTOP         */
+    xcb_window_t *wins;         /* n on desktop 0, n on 1       */
+    u8 *moved;                  /* per window, this run         */
+    u32 n;
+    u64 timeout;
+};
+
+static void
+settle(Bench *b)
+{
+    xcb_generic_event_t *ev;
+    while((ev = benchwaitevent(b->c, benchclock() + SETTLE_NS)))
+    {   free(ev);
+    }
+}
+
+static void
+setdesktop(Bench *b, u32 desktop)
+{
+    xcb_client_message_event_t ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.response_type = XCB_CLIENT_MESSAGE;
+    ev.format = 32;
+    ev.window = b->screen->root;
+    ev.type = b->current;
+    ev.data.data32[0] = desktop;
+    ev.data.data32[1] = XCB_CURRENT_TIME;
+    xcb_send_event(b->c, 0, b->screen->root,
+            XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT | XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY, (const char *)&ev);
+    xcb_flush(b->c);
+}
+
+static void
+createwins(Bench *b, xcb_window_t *wins, u32 n)
+{
+    const u32 mask = XCB_EVENT_MASK_STRUCTURE_NOTIFY;
+    u32 i;
+    for(i = 0; i < n; ++i)
+    {
+        wins[i] = xcb_generate_id(b->c);
+        xcb_create_window(b->c, XCB_COPY_FROM_PARENT, wins[i], b->screen->root, 0, 0, 300, 200, 0,
+                XCB_WINDOW_CLASS_INPUT_OUTPUT, b->screen->root_visual, XCB_CW_EVENT_MASK, &mask);
+        xcb_map_window(b->c, wins[i]);
+    }
+    xcb_flush(b->c);
+}
+
+static i32
+ours(const Bench *b, xcb_window_t win)
+{
+    u32 i;
+    for(i = 0; i < b->n * 2; ++i)
+    {
+        if(b->wins[i] == win)
+        {   return i;
+        }
+    }
+    return -1;
+}
+
+/* RETURN: 1 and the switch and spread times in ns on Success.
+ * RETURN: 0 on timeout.
+ */
+static int
+runswitch(Bench *b, u32 desktop, u64 *latency, u64 *spread)
+{
+    xcb_generic_event_t *ev;
+    u64 start;
+    u64 first = 0;
+    u32 left = b->n * 2;
+    i32 i;
+
+    memset(b->moved, 0, b->n * 2);
+    start = benchclock();
+    setdesktop(b, desktop);
+    while(left && (ev = benchwaitevent(b->c, start + b->timeout)))
+    {
+        const u64 now = benchclock();
+        /* the WM's own (synthetic) ConfigureNotify's say nothing about what is on screen */
+        if(ev->response_type == XCB_CONFIGURE_NOTIFY
+        && (i = ours(b, ((xcb_configure_notify_event_t *)ev)->window)) >= 0 && !b->moved[i])
+        {
+            b->moved[i] = 1;
+            first = first ? first : now;
+            if(!--left)
+            {
+                *latency = now - start;
+                *spread = now - first;
+            }
+        }
+        free(ev);
+    }
+    settle(b);
+    return !left;
+}
+
+static void
+usage(void)
+{
+    fputs("usage: switchlat [-n windows] [-r runs] [-t timeoutms]\n", stderr);
+    exit(EXIT_FAILURE);
+}
+
+int
+main(int argc, char **argv)
+{
+    Bench b;
+    u32 runs = 50;
+    u32 i;
+    u32 timeouts = 0;
+    u64 latency = 0;
+    u64 spread = 0;
+    Dist latencydist = { 0 };
+    Dist spreaddist = { 0 };
+
+    memset(&b, 0, sizeof(Bench));
+    b.n = 50;
+    b.timeout = 2000;
+    for(i = 1; i < (u32)argc; ++i)
+    {
+        if(i + 1 == (u32)argc)
+        {   usage();
+        }
+        else if(!strcmp(argv[i], "-n"))
+        {   b.n = strtoul(argv[++i], NULL, 0);
+        }
+        else if(!strcmp(argv[i], "-r"))
+        {   runs = strtoul(argv[++i], NULL, 0);
+        }
+        else if(!strcmp(argv[i], "-t"))
+        {   b.timeout = strtoull(argv[++i], NULL, 0);
+        }
+        else
+        {   usage();
+        }
+    }
+    if(!b.n)
+    {   usage();
+    }
+    b.timeout *= 1000000;
+
+    int scr;
+    b.c = xcb_connect(NULL, &scr);
+    if(xcb_connection_has_error(b.c))
+    {   DIE("%s", "cannot open display");
+    }
+    xcb_screen_iterator_t it = xcb_setup_roots_iterator(xcb_get_setup(b.c));
+    for(; scr > 0 && it.rem; --scr, xcb_screen_next(&it));
+    b.screen = it.data;
+    b.current = benchatom(b.c, "_NET_CURRENT_DESKTOP");
+    b.wins = calloc(b.n * 2, sizeof(xcb_window_t));
+    b.moved = calloc(b.n * 2, 1);
+    if(!b.wins || !b.moved)
+    {   DIE("%s", "out of memory");
+    }
+
+    /* new windows go on the current desktop */
+    setdesktop(&b, 0);
+    createwins(&b, b.wins, b.n);
+    settle(&b);
+    setdesktop(&b, 1);
+    settle(&b);
+    createwins(&b, b.wins + b.n, b.n);
+    settle(&b);
+
+    for(i = 0; i < runs; ++i)
+    {
+        if(runswitch(&b, i & 1, &latency, &spread))
+        {
+            distadd(&latencydist, latency);
+            distadd(&spreaddist, spread);
+        }
+        else
+        {   ++timeouts;
+        }
+    }
+    fputs("{\"bench\":\"switchlat\",", stdout);
+    benchlabel(stdout);
+    printf(",\"windows\":%u,\"runs\":%u,\"timeouts\":%u,", b.n, runs, timeouts);
+    distprint(stdout, "switch_ns", &latencydist);
+    fputc(',', stdout);
+    distprint(stdout, "spread_ns", &spreaddist);
+    fputs("}\n", stdout);
+    distfree(&latencydist);
+    distfree(&spreaddist);
+    free(b.wins);
+    free(b.moved);
+    xcb_disconnect(b.c);
+    return EXIT_SUCCESS;
+}
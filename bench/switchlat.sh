@@ -0,0 +1,35 @@
+#!/bin/sh
+# See LICENSE file for copyright and license details.
+#
+# Runs bench/switchlat against the WM on a private Xvfb and prints one JSON object per run (jsonl).
+# Build the WM once with and once without CFG_DESKTOP_SWITCH_GRAB and use BENCH_LABEL to tell them apart.
+#
+# usage: bench/switchlat.sh [wm] >> switchlat.jsonl
+#
+# WINDOWS   windows on each desktop         (default: 50)
+# RUNS      switches per run                (default: 50)
+# REPEAT    runs                            (default: 3)
+# BENCH_LABEL  label stored with every result (default: git describe of the tree)
+
+BENCH=$(dirname "$0")
+. "$BENCH/lib.sh"
+
+WM=${1:-$BENCH/../binary/dwm}
+WINDOWS=${WINDOWS:-50}
+RUNS=${RUNS:-50}
+REPEAT=${REPEAT:-3}
+
+[ -x "$BENCH/switchlat" ] || die "$BENCH/switchlat not found, run make bench first"
+[ -x "$BENCH/maplat" ] || die "$BENCH/maplat not found, run make bench first"
+
+startwm "$WM"
+
+rc=0
+i=0
+while [ "$i" -lt "$REPEAT" ]
+do
+    "$BENCH/switchlat" -n "$WINDOWS" -r "$RUNS" -t "$TIMEOUT" || rc=1
+    checkwm
+    i=$((i + 1))
+done
+exit $rc
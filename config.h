@@ -32,11 +32,23 @@
 #define CFG_DEFAULT_LAYOUT      Monocle     /* Default window layout Grid,Tiled,Monocle,Floating;               */
 #define CFG_DEFAULT_PREV_LAYOUT Tiled       /* See above; Sets previous layout when starting dwm                */
 #define CFG_DEFAULT_TAG_NUM     1           /* Tag number when starting dwm (1-9); 0 for default tag            */
+#define CFG_DESKTOP_COUNT       10          /* Desktops per monitor (_NET_NUMBER_OF_DESKTOPS)                   */
+#define CFG_DESKTOP_SWITCH_GRAB 0           /* 1 grab the server while switching desktops, no half switched frame; 0 to disable */
 /* Window */
 #define CFG_BORDER_PX           0           /* border pixel of windows                                          */
 #define CFG_GAP_PX              10          /* invisible border pixel of windows (CFG_BORDER_PX not affected)   */
 #define CFG_SNAP                15          /* snap window to border in pixels; 0 to disable (NOT RECOMMENDED) */
 #define CFG_WIN_RATE            120         /* max refresh rate when resizing, moving windows;  0 to disable    */
+#define CFG_SYNC_TIMEOUT        100         /* ms to wait for a _NET_WM_SYNC_REQUEST client to redraw a resize; 0 to disable */
+#define CFG_KEY_STEP            10          /* pixels an arrow key moves/resizes a window by; SHIFT for 1 pixel  */
+#define CFG_KEY_REPEAT_GAP      100         /* ms between presses of an arrow key that count as held; speeds it up */
+#define CFG_FOCUS_FIGHT_GAP     100         /* ms between FocusIn's of a window stealing focus that count as a fight */
+#define CFG_FOCUS_FIGHT_LIMIT   8           /* steals in a row before the WM backs off instead of taking focus back */
+#define CFG_FOCUS_FIGHT_BACKOFF 20          /* ms the first back off waits, doubles with every steal after           */
+#define CFG_FOCUS_FIGHT_MAX     2000        /* ms a back off waits at most                                          */
+#define CFG_CONFIGURE_LOOP_GAP  100         /* ms between identical ConfigureRequest's of a client that count as a loop */
+#define CFG_CONFIGURE_LOOP_LIMIT 4          /* identical ConfigureRequest's in a row answered before the rest are dropped */
+#define CFG_WITHDRAW_GRACE      500         /* ms an unmapped client is kept for a quick remap; 0 to disable     */
 #define CFG_HOVER_FOCUS         0           /* 1 on mouse hover focus that window; 0 to disable                 */
 #define CFG_RESIZE_BASE_WIDTH   0           /* Minimum size for resizing windows; while respecting sizehints    */
 #define CFG_RESIZE_BASE_HEIGHT  0           /* Minimum size for resizing windows; while respecting sizehints    */
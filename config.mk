@@ -7,7 +7,7 @@ PREFIX = /usr/local/
 MANPREFIX = ${PREFIX}/share/man
 
 # includes and libs
-INCS = `pkg-config --cflags --libs xcb` -lxcb-util -lxcb-icccm -lxcb-keysyms
+INCS = `pkg-config --cflags --libs xcb` -lxcb-util -lxcb-icccm -lxcb-keysyms -lxcb-sync -lxcb-xkb
 LIBS =  ${INCS}
 
 #X86 isnt explicitly supported and some code might need to be tweaked
@@ -9,6 +9,8 @@
 #include <errno.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
 #include <xcb/xcb.h>
 #include <xcb/xcb_aux.h>
 #include <xcb/xcb_atom.h>
@@ -50,9 +52,13 @@ argcvhandler(int argc, char *argv[])
             printf( "Usage: dwm [options]\n"
                     "  -h           Help Information.\n"
                     "  -v           Compiler Information.\n"
+                    "  -hotabort    Abort when a hot path blocks on the XServer (XCB_TRL_ENABLE_HOT_CHECK).\n"
                     );
             exit(EXIT_SUCCESS);
         }
+        else if(!strcmp(argv[i], "-hotabort"))
+        {   XCBSetHotPolicy(XCB_TRL_HOT_LOG | XCB_TRL_HOT_ABORT);
+        }
         else if (!strcmp(argv[i], "-v"))
         {
             char *compiler = "UNKNOWN";
@@ -105,6 +111,7 @@ argcvhandler(int argc, char *argv[])
                     printf( "Usage: dwm [options]\n"
                             "  -h           Help Information.\n"
                             "  -v           Compiler Information.\n"
+                            "  -hotabort    Abort when a hot path blocks on the XServer (XCB_TRL_ENABLE_HOT_CHECK).\n"
                           );
                     exit(EXIT_SUCCESS);
                 }
@@ -178,12 +185,9 @@ applygravity(u32 gravity, i16 *x, i16 *y, const u16 w, const u16 h, const u16 bw
 uint8_t
 applysizehints(Client *c, int16_t *x, int16_t *y, uint16_t *width, uint16_t *height, uint8_t interact)
 {
+    XCB_TRL_SCOPE();
     u8 baseismin;
     Monitor *m = c->mon;
-    XCBCookie sizehintscookie;
-    if(ISFLOATING(c))
-    {   sizehintscookie = XCBGetWMNormalHintsCookie(_wm.dpy, c->win);
-    }
 
     /* set minimum possible */
     *width = MAX(1, *width);
@@ -224,52 +228,48 @@ applysizehints(Client *c, int16_t *x, int16_t *y, uint16_t *width, uint16_t *hei
     if (*width  < m->bh)
     {   *width = m->bh;
     }
+    /* hints are cached by manage() and propertynotify(), this runs for every frame of a drag */
     if (ISFLOATING(c))
     {
-        XCBSizeHints hints;
-        u8 status = XCBGetWMNormalHintsReply(_wm.dpy, sizehintscookie, &hints);
-        /* On Failure clear flag and ignore hints */
-        hints.flags *= !!status;
-        updatesizehints(c, &hints);
         /* see last two sentences in ICCCM 4.1.2.3 */
-        baseismin = c->basew == c->minw && c->baseh == c->minh;
+        baseismin = c->info->basew == c->info->minw && c->info->baseh == c->info->minh;
         /* temporarily remove base dimensions */
         if (!baseismin)
         {
-            *width  -= c->basew;
-            *height -= c->baseh;
+            *width  -= c->info->basew;
+            *height -= c->info->baseh;
         }
         /* adjust for aspect limits */
-        if (c->mina > 0 && c->maxa > 0)
+        if (c->info->mina > 0 && c->info->maxa > 0)
         {
-            if (c->maxa < (float)*width / *height) 
-            {   *width = *height * c->maxa + 0.5;
+            if (c->info->maxa < (float)*width / *height) 
+            {   *width = *height * c->info->maxa + 0.5;
             }
-            else if (c->mina < (float)*height / *width) 
-            {   *height = *width * c->mina + 0.5;
+            else if (c->info->mina < (float)*height / *width) 
+            {   *height = *width * c->info->mina + 0.5;
             }
         }
         /* increment calculation requires this */
         if (baseismin)
         {
-            *width  -= c->basew;
-            *height -= c->baseh;
+            *width  -= c->info->basew;
+            *height -= c->info->baseh;
         }
         /* adjust for increment value */
-        if (c->incw)
-        {   *width -= *width % c->incw;
+        if (c->info->incw)
+        {   *width -= *width % c->info->incw;
         }
-        if (c->inch) 
-        {   *height -= *height % c->inch;
+        if (c->info->inch) 
+        {   *height -= *height % c->info->inch;
         }
         /* restore base dimensions */
-        *width = MAX(*width + c->basew, c->minw);
-        *height = MAX(*height + c->baseh, c->minh);
-        if (c->maxw) 
-        {   *width = MIN(*width, c->maxw);
+        *width = MAX(*width + c->info->basew, c->info->minw);
+        *height = MAX(*height + c->info->baseh, c->info->minh);
+        if (c->info->maxw) 
+        {   *width = MIN(*width, c->info->maxw);
         }
-        if (c->maxh) 
-        {   *height = MIN(*height, c->maxh);
+        if (c->info->maxh) 
+        {   *height = MIN(*height, c->info->maxh);
         }
     }
     return *x != c->x || *y != c->y || *width != c->w || *height != c->h;
@@ -278,6 +278,7 @@ applysizehints(Client *c, int16_t *x, int16_t *y, uint16_t *width, uint16_t *hei
 void
 arrange(Desktop *desk)
 {
+    XCB_TRL_SCOPE();
     Client *c;
     for(c = desk->stack; c; c = nextstack(c))
     {   showhide(c);
@@ -308,9 +309,63 @@ arrangemons(void)
 void
 arrangedesktop(Desktop *desk)
 {
-    if(layouts[desk->layout].symbol)
-    {   layouts[desk->layout].arrange(desk);
+    /* its clients may be part of the view, which desksel lays out (see viewtiled()) */
+    if(desk->ntagged || desk->mon->tagset & TAGBIT(desk))
+    {   desk = desk->mon->desksel;
+    }
+    /* the clients of a desktop that is not shown are off screen (see showhide()), they are laid out once it is */
+    if(desk->mon->desksel != desk)
+    {   return;
+    }
+    if(!layouts[desk->layout].symbol)
+    {   return;
+    }
+    LayoutCache *cache = desk->cache ? &desk->cache[desk->layout] : NULL;
+    Client **tiled;
+    Rect *geom;
+    Client *c;
+    u64 key;
+    u32 n;
+    u32 i;
+
+    tiled = viewtiled(desk, &n);
+    key = layoutkey(desk, tiled, n);
+    /* the same clients in the same area with the same settings, the layout would come up with the same geometry */
+    if(cache && n && cache->n == n && cache->key == key)
+    {
+        for(i = 0; i < n; ++i)
+        {
+            c = tiled[i];
+            geom = &cache->geom[i];
+            if(geom->x != c->x || geom->y != c->y || geom->w != c->w || geom->h != c->h)
+            {   resizeclient(c, geom->x, geom->y, geom->w, geom->h);
+            }
+        }
+        return;
+    }
+    layouts[desk->layout].arrange(desk);
+    if(!cache || !n)
+    {   return;
     }
+    if(n > cache->max)
+    {
+        geom = realloc(cache->geom, n * sizeof(Rect));
+        if(!geom)
+        {   /* just lays out again next time */
+            cache->n = 0;
+            return;
+        }
+        cache->geom = geom;
+        cache->max = n;
+    }
+    /* the layout only moves the clients of tiled, its own viewtiled() refills the view with the same ones */
+    for(i = 0; i < n; ++i)
+    {
+        c = tiled[i];
+        cache->geom[i] = (Rect){ .x = c->x, .y = c->y, .w = c->w, .h = c->h };
+    }
+    cache->key = key;
+    cache->n = n;
     /* update the bar or something */
 }
 
@@ -375,30 +430,16 @@ attach(Client *c)
     c->next = c->desktop->clients;
     c->desktop->clients = c;
     if(c->next)
-    {   c->next->prev = c;
+    {   c->next->info->prev = c;
     }
     else
     {   c->desktop->clast = c;
     }
     /* prevent circular linked list */
-    c->prev = NULL;
-}
-
-void
-attachdesktop(Monitor *m, Desktop *desktop)
-{
-    desktop->next = m->desktops;
-    m->desktops = desktop;
-    if(desktop->next)
-    {   desktop->next->prev = desktop;
-    }
-    else
-    {  
-         /* m->lastdesktop = desktop */
-    }
-    /* prevent circular linked list */
-    desktop->prev = NULL;
-    ++m->deskcount;
+    c->info->prev = NULL;
+    c->desktop->ntagged += c->tags != TAGBIT(c->desktop);
+    updatetiled(c);
+    CHECKCLIENTS(c->desktop);
 }
 
 void
@@ -409,36 +450,45 @@ attachstack(Client *c)
     desk->stack = c;
     if(c->snext)
     {   
-        c->snext->sprev = c;
+        c->snext->info->sprev = c;
     }
     else
     {   
         desk->slast = c;
     }
     /* prevent dangling pointers */
-    c->sprev = NULL;
+    c->info->sprev = NULL;
+    CHECKSTACK(desk);
 }
 
 void
 detach(Client *c)
 {
-    Client **tc;
-    for (tc = &c->desktop->clients; *tc && *tc != c; tc = &(*tc)->next);
-    *tc = c->next;
-    if(!(*tc)) 
-    {
-        c->desktop->clast = c->prev;
+    Desktop *desk = c->desktop;
+    Client *prev = c->info->prev;
+    /* it may not be in the list */
+    if(prev || desk->clients == c)
+    {   desk->ntagged -= c->tags != TAGBIT(desk);
+    }
+    if(prev)
+    {   prev->next = c->next;
     }
-    else if(c->next) 
-    {   c->next->prev = c->prev;
+    else if(desk->clients == c)
+    {   desk->clients = c->next;
     }
-    else if(c->prev) 
-    {   /* This should be UNREACHABLE but in case we do reach it then this should suffice*/
-        c->desktop->clast = c->prev;
-        c->prev->next = NULL;
+    else
+    {   c->next = NULL;
+    }
+    if(c->next)
+    {   c->next->info->prev = prev;
+    }
+    else if(desk->clast == c)
+    {   desk->clast = prev;
     }
     c->next = NULL;
-    c->prev = NULL;
+    c->info->prev = NULL;
+    updatetiled(c);
+    CHECKCLIENTS(desk);
 }
 
 void
@@ -449,63 +499,106 @@ detachcompletely(Client *c)
 }
 
 void
-detachdesktop(Monitor *m, Desktop *desktop)
+detachwithdrawn(Client *c)
 {
-    Desktop **td;
-    for(td = &m->desktops; *td && *td != desktop; td = &(*td)->next);
-    *td = desktop->next;
-    if(!(*td))
-    {
-        /* m->lastdesktop = desktop->prev; */
-    }
-    else if(desktop->next)
-    {
-        desktop->next->prev = desktop->prev;
-    }
-    else if(desktop->prev)
-    {
-        /* m->last = desktop->prev; */
-        desktop->prev->next = NULL;
+    Client **tc;
+    for(tc = &_wm.withdrawn; *tc && *tc != c; tc = &(*tc)->info->wnext);
+    if(*tc)
+    {   *tc = c->info->wnext;
     }
-    --m->deskcount;
-
-    desktop->next = NULL;
-    desktop->prev = NULL;
+    c->info->wnext = NULL;
 }
 
 void
 detachstack(Client *c)
 {
     Desktop *desk = c->desktop;
-    Client **tc, *t;
+    Client *sprev = c->info->sprev;
+    Desktop *d;
+    Client *t;
 
-    for(tc = &desk->stack; *tc && *tc != c; tc = &(*tc)->snext);
-    *tc = c->snext;
-    if(!(*tc))
-    {
-        desk->slast = c->sprev;
+    /* it may not be in the stack */
+    if(sprev)
+    {   sprev->snext = c->snext;
     }
-    else if(c->snext)
-    {   
-        c->snext->sprev = c->sprev;
+    else if(desk->stack == c)
+    {   desk->stack = c->snext;
+    }
+    else
+    {   c->snext = NULL;
+    }
+    if(c->snext)
+    {   c->snext->info->sprev = sprev;
     }
-    else if(c->sprev)
-    {   /* this should be UNREACHABLE but if it does this should suffice */
-        desk->slast = c->sprev;
-        c->sprev->snext = NULL;
+    else if(desk->slast == c)
+    {   desk->slast = sprev;
     }
-    if(c == desk->sel)
+    /* focus() keeps the view's focus in desksel, so c may be the sel of any desktop it was shown with */
+    for(d = desk->mon->desktops; d; d = nextdesktop(d))
     {
-        for(t = desk->stack; t && !ISVISIBLE(t); t = t->snext);
-        desk->sel = t;
+        if(c != d->sel)
+        {   continue;
+        }
+        if(d == d->mon->desksel)
+        {   d->sel = viewsel(d->mon);
+        }
+        else
+        {
+            for(t = d->stack; t && !ISVISIBLE(t); t = t->snext);
+            d->sel = t;
+        }
     }
-    c->sprev = NULL;
+    c->info->sprev = NULL;
     c->snext = NULL;
+    CHECKSTACK(desk);
+}
+
+void
+checkclients(Desktop *desk)
+{
+    Client *c;
+    Client *prev = NULL;
+    u32 n = 0;
+    u32 tiled = 0;
+    u32 tagged = 0;
+    for(c = desk->clients; c; prev = c, c = c->next)
+    {
+        if(++n > _wm.clientpool.used)
+        {   DIE("Desktop %d: client list has a cycle", desk->num);
+        }
+        if(c->desktop != desk)
+        {   DIE("Desktop %d: client 0x%x belongs to desktop %d", desk->num, c->win, c->desktop->num);
+        }
+        if(c->info->prev != prev)
+        {   DIE("Desktop %d: client 0x%x has a bad prev", desk->num, c->win);
+        }
+        if(!(c->tags & TAGBIT(desk)))
+        {   DIE("Desktop %d: client 0x%x is not tagged with it", desk->num, c->win);
+        }
+        tagged += c->tags != TAGBIT(desk);
+        if(!ISFLOATING(c) && !ISHIDDEN(c))
+        {
+            if(tiled >= desk->ntiled || desk->tiled[tiled] != c)
+            {   DIE("Desktop %d: client 0x%x is not tiled %u", desk->num, c->win, tiled);
+            }
+            ++tiled;
+        }
+    }
+    if(desk->clast != prev)
+    {   DIE("Desktop %d: clast is not the last client", desk->num);
+    }
+    if(tiled != desk->ntiled)
+    {   DIE("Desktop %d: %u tiled clients, %u in tiled", desk->num, tiled, desk->ntiled);
+    }
+    if(tagged != desk->ntagged)
+    {   DIE("Desktop %d: %u clients also shown elsewhere, ntagged is %u", desk->num, tagged, desk->ntagged);
+    }
 }
 
 u8
 checknewbar(XCBWindow win)
 {
+    XCB_TRL_SCOPE();
     u8 status = 0;
 
     if(_wm.selmon->barwin)
@@ -609,6 +702,7 @@ checknewbar(XCBWindow win)
 void
 checkotherwm(void)
 {
+    XCB_TRL_SCOPE();
     XCBGenericEvent *ev = NULL;
     i32 response;
     XCBSelectInput(_wm.dpy, XCBRootWindow(_wm.dpy, _wm.screen), XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT);
@@ -629,9 +723,33 @@ checkotherwm(void)
     /* The other edge case is if the display just doesnt work, however this is covered at startup() if(!_wm.dpy) { DIE(msg); } */
 }
 
+void
+checkstack(Desktop *desk)
+{
+    Client *c;
+    Client *sprev = NULL;
+    u32 n = 0;
+    for(c = desk->stack; c; sprev = c, c = c->snext)
+    {
+        if(++n > _wm.clientpool.used)
+        {   DIE("Desktop %d: stack has a cycle", desk->num);
+        }
+        if(c->desktop != desk)
+        {   DIE("Desktop %d: stacked client 0x%x belongs to desktop %d", desk->num, c->win, c->desktop->num);
+        }
+        if(c->info->sprev != sprev)
+        {   DIE("Desktop %d: client 0x%x has a bad sprev", desk->num, c->win);
+        }
+    }
+    if(desk->slast != sprev)
+    {   DIE("Desktop %d: slast is not the last stacked client", desk->num);
+    }
+}
+
 void
 cleanup(void)
 {
+    XCB_TRL_SCOPE();
     XCBCookie cookie = XCBDestroyWindow(_wm.dpy, _wm.wmcheckwin);
     XCBDiscardReply(_wm.dpy, cookie);
     if(_wm.syms)
@@ -639,7 +757,24 @@ cleanup(void)
         XCBKeySymbolsFree(_wm.syms);
         _wm.syms = NULL;
     }
+    while(_wm.withdrawn)
+    {   
+        Client *c = _wm.withdrawn;
+        detachwithdrawn(c);
+        cleanupclient(c);
+    }
     cleanupmons();
+    if(_wm.drag.alarm)
+    {   XCBSyncDestroyAlarm(_wm.dpy, _wm.drag.alarm);
+    }
+    timercleanup();
+    pooldestroy(&_wm.clientpool);
+    pooldestroy(&_wm.infopool);
+    pooldestroy(&_wm.monpool);
+    if(_wm.sigfd != -1)
+    {   close(_wm.sigfd);
+        _wm.sigfd = -1;
+    }
     XCBSync(_wm.dpy);
     XCBCloseDisplay(_wm.dpy);
     _wm.dpy = NULL;
@@ -657,30 +792,58 @@ cleanupdesktop(Desktop *desk)
         cleanupclient(c);
         c = next;
     }
-    free(desk);
-    desk = NULL;
+    free(desk->tiled);
+    desk->tiled = NULL;
+    desk->clients = NULL;
+    if(desk->cache)
+    {
+        u32 i;
+        for(i = 0; i < LENGTH(layouts); ++i)
+        {   free(desk->cache[i].geom);
+        }
+        free(desk->cache);
+        desk->cache = NULL;
+    }
 }
 
 void
 cleanupclient(Client *c)
 {
-    free(c);
+    idlecancel(&c->info->reconfigure);
+    timercancel(&c->info->grace);
+    timercancel(&c->info->fight.timer);
+    poolfree(&_wm.infopool, c->info);
+    poolfree(&_wm.clientpool, c);
     c = NULL;
 }
 
 void
 cleanupmon(Monitor *m)
 {
-    Desktop *desk = NULL;
-    Desktop *desknext = NULL;
-    desk = m->desktops;
-    while(desk)
+    Client **tc = &_wm.withdrawn;
+    Client *c;
+    u16 i;
+    /* remap() would put them back on m, the next map manage()'s them instead */
+    while((c = *tc))
     {
-        desknext = desk->next;
-        cleanupdesktop(desk);
-        desk = desknext;
+        if(c->mon == m)
+        {   
+            detachwithdrawn(c);
+            cleanupclient(c);
+        }
+        else
+        {   tc = &c->info->wnext;
+        }
+    }
+    for(i = 0; i < m->deskcount; ++i)
+    {   cleanupdesktop(&m->desktops[i]);
     }
-    free(m);
+    free(m->desktops);
+    free(m->view);
+    if(m->crosswin)
+    {   XCBDestroyWindow(_wm.dpy, m->crosswin);
+    }
+    poolfree(&_wm.monpool, m);
     m = NULL;
 }
 
@@ -702,6 +865,7 @@ cleanupmons(void)
 void
 configure(Client *c)
 {
+    XCB_TRL_SCOPE();
     XCBConfigureNotifyEvent ce;
     ce.response_type = XCB_CONFIGURE_NOTIFY;
     ce.event = c->win;
@@ -716,51 +880,64 @@ configure(Client *c)
     XCBSendEvent(_wm.dpy, c->win, False, XCB_EVENT_MASK_STRUCTURE_NOTIFY, (const char *)&ce);
 }
 
+void
+configureidle(Idle *task)
+{
+    XCB_TRL_SCOPE();
+    Client *c = task->data;
+    const u16 mask = c->info->confpending;
+    c->info->confpending = 0;
+    /* showhide() puts it where it belongs once it is visible */
+    if(!ISVISIBLE(c))
+    {   return;
+    }
+    XCBMoveResizeWindow(_wm.dpy, c->win, c->x, c->y, c->w, c->h);
+    if(mask & XCB_CONFIG_WINDOW_BORDER_WIDTH)
+    {   XCBSetWindowBorderWidth(_wm.dpy, c->win, c->bw);
+    }
+    /* only a resize gets a real ConfigureNotify */
+    if(!(mask & (XCB_CONFIG_WINDOW_WIDTH|XCB_CONFIG_WINDOW_HEIGHT)))
+    {   configure(c);
+    }
+}
+
 Client *
 createclient(Monitor *m)
 {
-    Client *c = calloc(1, sizeof(Client ));
+    /* grouped by desktop so a desktop's clients share slabs, a client moved later stays where it was allocated */
+    Client *c = poolallocgroup(&_wm.clientpool, m->desksel->num);
     if(!c)
     {   return NULL;
     }
+    c->info = poolalloc(&_wm.infopool);
+    if(!c->info)
+    {
+        poolfree(&_wm.clientpool, c);
+        return NULL;
+    }
     c->x = c->y = 0;
     c->w = c->h = 0;
-    c->oldx = c->oldy = 0;
-    c->oldw = c->oldh = 0;
+    c->info->oldx = c->info->oldy = 0;
+    c->info->oldw = c->info->oldh = 0;
     c->flags = 0;
-    c->bw = c->oldbw = 0;
+    c->bw = c->info->oldbw = 0;
     c->win = 0;
     c->mon = m;
-    c->mina = c->maxa = 0;
-    c->basew = c->baseh = 0;
-    c->incw = c->inch = 0;
-    c->maxw = c->maxh = 0;
-    c->pid = 0;
+    c->info->mina = c->info->maxa = 0;
+    c->info->basew = c->info->baseh = 0;
+    c->info->incw = c->info->inch = 0;
+    c->info->maxw = c->info->maxh = 0;
+    c->info->pid = 0;
     c->desktop = m->desksel;
+    /* shown on whatever is viewed, like dwm */
+    c->tags = m->tagset;
     return c;
 }
 
-Desktop *
-createdesktop(Monitor *m)
-{
-    Desktop *desk = calloc(1, sizeof(Desktop));
-    if(!desk)
-    {
-        DEBUG("%s", "WARN: FAILED TO CREATE DESKTOP");
-        return NULL;
-    }
-    desk->layout = 0;   /* TODO */
-    desk->olayout= 0;   /* TODO */
-    desk->clients= NULL;
-    desk->stack = NULL;
-    attachdesktop(m, desk);
-    return desk;
-}
-
 Monitor *
 createmon(void)
 {
-    Monitor *m = calloc(1, sizeof(Monitor ));
+    Monitor *m = poolalloc(&_wm.monpool);
     if(!m)
     {   /* while calling "DIE" may seem extreme frankly we cannot afford a monitor to fail alloc. */
         DIE("%s", "(OutOfMemory) Could not alloc enough memory for a Monitor");
@@ -774,12 +951,26 @@ createmon(void)
     m->barwin = 0;
     m->bx = m->by = 0;
     m->bw = m->bh = 0;
+    m->view = NULL;
+    m->viewmax = 0;
     u16 i;
-    /* TODO */
-    for(i = 0; i < 10; ++i)
-    {   createdesktop(m);
+    /* Never resized, Clients and desksel point into it */
+    m->deskcount = MIN(MAX(_cfg.deskcount, 1), TAGSLENGTH);
+    m->desktops = calloc(m->deskcount, sizeof(Desktop));
+    if(!m->desktops)
+    {   DIE("%s", "(OutOfMemory) Could not alloc enough memory for a Monitor's Desktops");
+    }
+    for(i = 0; i < m->deskcount; ++i)
+    {
+        m->desktops[i].num = i;
+        m->desktops[i].mon = m;
+        /* a Desktop without one just never remembers a layout, see arrangedesktop() */
+        m->desktops[i].cache = calloc(LENGTH(layouts), sizeof(LayoutCache));
+        m->desktops[i].layout = 0;   /* TODO */
+        m->desktops[i].olayout= 0;   /* TODO */
     }
     m->desksel = m->desktops;
+    m->tagset = TAGBIT(m->desksel);
     return m;
 }
 
@@ -812,11 +1003,332 @@ docked(Client *c)
     return dockd;
 }
 
+void
+dragapply(void)
+{
+    XCB_TRL_SCOPE();
+    Drag *d = &_wm.drag;
+    Client *c = d->c;
+    const i32 dx = d->rx - d->px;
+    const i32 dy = d->ry - d->py;
+    i16 x = d->ox + dx;
+    i16 y = d->oy + dy;
+    u16 w = c->w;
+    u16 h = c->h;
+
+    /* the client has not drawn the last resize yet, dragsync() picks the motion up */
+    if(d->syncwait)
+    {   return;
+    }
+    d->dirty = 0;
+    d->last = timernow();
+    if(d->mode == DragResize)
+    {
+        w = MAX(1, d->ow + d->horiz * dx);
+        h = MAX(1, d->oh + d->vert * dy);
+        x = d->ox;
+        y = d->oy;
+    }
+    if(applysizehints(c, &x, &y, &w, &h, 1))
+    {
+        /* keep the opposite edge where it was, after the hints changed the size */
+        if(d->mode == DragResize && d->horiz < 0)
+        {   x = d->ox + d->ow - w;
+        }
+        if(d->mode == DragResize && d->vert < 0)
+        {   y = d->oy + d->oh - h;
+        }
+        /* EWMH: the request goes out before the ConfigureNotify it is for */
+        if(d->sync)
+        {
+            XCBClientMessageEvent ev;
+            i64 value;
+            /* read here rather than in dragstart(), the reply had a frame to arrive */
+            if(d->counter.sequence)
+            {
+                if(XCBSyncQueryCounterReply(_wm.dpy, d->counter, &value) && value > 0 && (u64)value > d->syncvalue)
+                {   d->syncvalue = value;
+                }
+                d->counter.sequence = 0;
+            }
+            memset(&ev, 0, sizeof(ev));
+            ++d->syncvalue;
+            ev.response_type = XCB_CLIENT_MESSAGE;
+            ev.window = c->win;
+            ev.type = wmatom[WMProtocols];
+            ev.format = 32;
+            ev.data.data32[0] = netatom[NetWMSyncRequest];
+            ev.data.data32[1] = XCB_CURRENT_TIME;
+            ev.data.data32[2] = d->syncvalue & UINT32_MAX;
+            ev.data.data32[3] = d->syncvalue >> 32;
+            XCBSendEvent(_wm.dpy, c->win, False, XCB_NONE, (const char *)&ev);
+            /* the client sets its counter to the value once it drew the new size */
+            XCBSyncChangeAlarm(_wm.dpy, d->alarm, c->info->counter, d->syncvalue);
+            d->syncwait = 1;
+            timerset(&d->synctimeout, _cfg.synctimeout, dragsynctimeout, NULL);
+        }
+        resizeclient(c, x, y, w, h);
+    }
+}
+
+void
+dragcancel(void)
+{
+    XCB_TRL_SCOPE();
+    Drag *d = &_wm.drag;
+    Client *c = d->c;
+
+    if(!c)
+    {   return;
+    }
+    d->dirty = 0;
+    dragstop();
+    /* back into the layout it was taken out of */
+    if(d->floated)
+    {
+        setfloating(c, 0);
+        arrange(c->desktop);
+    }
+    else
+    {   resizeclient(c, d->ox, d->oy, d->ow, d->oh);
+    }
+}
+
+void
+dragframe(Timer *timer)
+{
+    (void)timer;
+    if(_wm.drag.c && _wm.drag.dirty)
+    {   dragapply();
+    }
+}
+
+void
+dragkey(XCBKeysym sym, uint16_t state, XCBTimestamp tim)
+{
+    Drag *d = &_wm.drag;
+    i32 dx = 0;
+    i32 dy = 0;
+    u16 step;
+
+    switch(sym)
+    {
+        case XK_Left:   dx = -1; break;
+        case XK_Right:  dx = 1; break;
+        case XK_Up:     dy = -1; break;
+        case XK_Down:   dy = 1; break;
+        case XK_Return:
+        case XK_KP_Enter:
+            dragstop();
+            return;
+        case XK_Escape:
+            dragcancel();
+            return;
+        default:
+            return;
+    }
+    /* autorepeat sends a press every few ms, so held keys double the step every 8 presses up to 8 times */
+    if(sym == d->key && tim - d->keytime < _cfg.keygap)
+    {   ++d->repeat;
+    }
+    else
+    {   d->repeat = 0;
+    }
+    d->key = sym;
+    d->keytime = tim;
+    step = state & XCB_MOD_MASK_SHIFT ? 1 : _cfg.keystep << MIN(d->repeat / 8, 3);
+    /* a virtual pointer, so repeats between frames are coalesced like motion */
+    dx = d->rx + dx * step;
+    dy = d->ry + dy * step;
+    dragmotion(MAX(INT16_MIN, MIN(dx, INT16_MAX)), MAX(INT16_MIN, MIN(dy, INT16_MAX)));
+}
+
+void
+dragkeygrab(Idle *task)
+{
+    XCB_TRL_SCOPE();
+    Drag *d = &_wm.drag;
+    XCBGrabKeyboard *grab = XCBGrabKeyboardReply(_wm.dpy, d->grab);
+    const u8 grabbed = grab && grab->status == XCB_GRAB_STATUS_SUCCESS;
+    (void)task;
+
+    free(grab);
+    /* without the grab the arrow keys go to the client, so the drag it was for is over */
+    if(!grabbed && d->c && d->keyboard)
+    {
+        DEBUG0("Failed to grab the keyboard.");
+        d->keyboard = 0;
+        dragcancel();
+    }
+}
+
+void
+dragkeystart(Client *c, uint8_t mode)
+{
+    XCB_TRL_SCOPE();
+    Drag *d = &_wm.drag;
+
+    /* dragstart() would stop it after the grab below and so ungrab the keyboard */
+    if(d->c)
+    {   dragstop();
+    }
+    /* still in flight from a drag started earlier in this batch */
+    if(idlepending(&d->grabcheck))
+    {   XCBDiscardReply(_wm.dpy, d->grab);
+    }
+    /* keypress() must not wait on the reply, dragkeygrab() checks it after the batch */
+    d->grab = XCBGrabKeyboardCookie(_wm.dpy, _wm.root, False, XCB_GRAB_MODE_ASYNC, XCB_GRAB_MODE_ASYNC, XCB_CURRENT_TIME);
+    idleadd(&d->grabcheck, dragkeygrab, NULL);
+    dragstart(c, mode, 0, 0, 0);
+    d->keyboard = 1;
+    /* arrows grow and shrink the right and bottom edges */
+    d->horiz = 1;
+    d->vert = 1;
+    d->key = 0;
+    d->repeat = 0;
+}
+
+void
+dragmotion(int16_t rootx, int16_t rooty)
+{
+    Drag *d = &_wm.drag;
+    /* no rate limit, apply every motion */
+    const u64 period = _cfg.rfrate ? 1000000000 / _cfg.rfrate : 0;
+    u64 elapsed;
+
+    d->rx = rootx;
+    d->ry = rooty;
+    d->dirty = 1;
+    /* coalesced into the frame already scheduled */
+    if(timerpending(&d->frame))
+    {   return;
+    }
+    elapsed = timernow() - d->last;
+    if(elapsed >= period)
+    {   dragapply();
+    }
+    else
+    {   timerset(&d->frame, (period - elapsed + 999999) / 1000000, dragframe, NULL);
+    }
+}
+
+void
+dragstart(Client *c, uint8_t mode, uint8_t button, int16_t rootx, int16_t rooty)
+{
+    XCB_TRL_SCOPE();
+    Drag *d = &_wm.drag;
+
+    if(d->c)
+    {   dragstop();
+    }
+    /* a dragged client leaves the layout */
+    d->floated = !ISFLOATING(c);
+    if(d->floated)
+    {   
+        setfloating(c, 1);
+        arrange(c->desktop);
+    }
+    d->c = c;
+    d->mode = mode;
+    d->button = button;
+    d->horiz = rootx - c->x < c->w / 2 ? -1 : 1;
+    d->vert = rooty - c->y < c->h / 2 ? -1 : 1;
+    d->dirty = 0;
+    d->px = d->rx = rootx;
+    d->py = d->ry = rooty;
+    d->ox = c->x;
+    d->oy = c->y;
+    d->ow = c->w;
+    d->oh = c->h;
+    d->last = 0;
+    d->sync = mode == DragResize && c->info->counter && d->alarm && _cfg.synctimeout;
+    d->syncwait = 0;
+    /* the counter may already be past syncvalue (a WM restart, a client chosen start), the alarm would trigger at once */
+    d->counter.sequence = 0;
+    if(d->sync)
+    {   d->counter = XCBSyncQueryCounterCookie(_wm.dpy, c->info->counter);
+    }
+    d->keyboard = 0;
+    /* the button press already grabbed the pointer, only add motion to it. Ends on its own on release */
+    if(button)
+    {   XCBChangeActivePointerGrab(_wm.dpy, XCB_NONE, XCB_CURRENT_TIME, MOUSEMASK);
+    }
+}
+
+void
+dragstop(void)
+{
+    Drag *d = &_wm.drag;
+    if(!d->c)
+    {   return;
+    }
+    timercancel(&d->frame);
+    timercancel(&d->synctimeout);
+    /* the final size goes out without waiting */
+    d->sync = 0;
+    d->syncwait = 0;
+    if(d->counter.sequence)
+    {   XCBDiscardReply(_wm.dpy, d->counter);
+    }
+    d->counter.sequence = 0;
+    /* never drop the final position */
+    if(d->dirty)
+    {   dragapply();
+    }
+    if(d->keyboard)
+    {   
+        XCBUngrabKeyboard(_wm.dpy, XCB_CURRENT_TIME);
+        /* keys still down release to the focused client now */
+        memset(_wm.keysheld, 0, sizeof(_wm.keysheld));
+    }
+    d->keyboard = 0;
+    d->c = NULL;
+}
+
+void
+dragsync(void)
+{
+    Drag *d = &_wm.drag;
+    /* late, dragsynctimeout() already gave up */
+    if(!d->syncwait)
+    {   return;
+    }
+    d->syncwait = 0;
+    timercancel(&d->synctimeout);
+    /* motion that came in meanwhile still goes through the usual rate limit */
+    if(d->c && d->dirty)
+    {   dragmotion(d->rx, d->ry);
+    }
+}
+
+void
+dragsynctimeout(Timer *timer)
+{
+    Drag *d = &_wm.drag;
+    (void)timer;
+    DEBUG0("Client did not answer _NET_WM_SYNC_REQUEST, resizing without it.");
+    /* rate limited for the rest of the drag */
+    d->sync = 0;
+    d->syncwait = 0;
+    if(d->c && d->dirty)
+    {   dragmotion(d->rx, d->ry);
+    }
+}
+
 void
 eventhandler(XCBGenericEvent *ev)
 {
     /* int for speed */
     int cleanev = XCB_EVENT_RESPONSE_TYPE(ev);
+    eventstatsadd(ev);
+    /* extension events are past the end of handler[] */
+    if(cleanev >= LASTEvent)
+    {
+        if(_wm.syncevent && cleanev == _wm.syncevent + XCB_SYNC_ALARM_NOTIFY)
+        {   alarmnotify(ev);
+        }
+        return;
+    }
     switch(cleanev)
     {
         case XCB_KEY_PRESS:
@@ -947,11 +1459,11 @@ floating(Desktop *desk)
 void
 focus(Client *c)
 {
+    XCB_TRL_HOT_SCOPE();
     Monitor *selmon = _wm.selmon;
     Desktop *desk  = selmon->desksel;
     if(!c || !ISVISIBLE(c))
-    {   /* selmon should have atleast 1 desktop so no need to check */
-        for(c = desk->stack; c && !ISVISIBLE(c); c = c->snext);
+    {   c = viewsel(selmon);
     }
     if(desk->sel && desk->sel != c)
     {   unfocus(desk->sel, 0);
@@ -983,9 +1495,67 @@ focus(Client *c)
     desk->sel = c;
 }
 
+void
+focusfight(XCBWindow win)
+{
+    XCB_TRL_HOT_SCOPE();
+    Client *c = wintoclient(win);
+    /* each client keeps its own streak so two of them stealing in turn do not reset each other */
+    FocusFight *f = c ? &c->info->fight : &_wm.fight;
+    const u64 now = timernow() / 1000000;
+
+    /* a new window or it calmed down */
+    if(win != f->win || now - f->last >= _cfg.fightgap)
+    {
+        f->win = win;
+        f->streak = 0;
+        f->backoff = 0;
+    }
+    f->last = now;
+    f->streak += f->streak != UINT16_MAX;
+    if(f->streak < _cfg.fightlimit)
+    {   
+        setfocus(_wm.selmon->desksel->sel);
+        return;
+    }
+    /* Taking focus back right away would just ping-pong with a client that takes it on every FocusOut,
+     * so retake it once the back off runs out and drop every steal until then.
+     */
+    if(timerpending(&f->timer))
+    {   
+        ++_wm.fightdropped;
+        return;
+    }
+    if(f->streak == _cfg.fightlimit)
+    {
+        ++_wm.fights;
+        if(c)
+        {   ++c->info->focusfights;
+        }
+        DEBUG("Window fighting focus: %u (%s)", win, c && c->info->name ? c->info->name : "unmanaged");
+    }
+    f->backoff = f->backoff ? MIN(f->backoff << 1, _cfg.fightmax) : _cfg.fightbackoff;
+    ++_wm.fightbackoffs;
+    timerset(&f->timer, f->backoff, focusfighttimeout, f);
+}
+
+void
+focusfighttimeout(Timer *timer)
+{
+    XCB_TRL_SCOPE();
+    FocusFight *f = timer->data;
+    Client *sel = _wm.selmon->desksel->sel;
+    /* the steal that answers this retake continues the streak */
+    f->last = timernow() / 1000000;
+    if(sel)
+    {   setfocus(sel);
+    }
+}
+
 i32
 getstate(XCBWindow win)
 {
+    XCB_TRL_SCOPE();
     i32 state = 0;
     const XCBCookie cookie = XCBGetWindowPropertyCookie(_wm.dpy, win, wmatom[WMState], 0L, 2L, False, wmatom[WMState]);
     XCBGetWindowAttributes *reply = XCBGetWindowAttributesReply(_wm.dpy, cookie);
@@ -1000,6 +1570,7 @@ getstate(XCBWindow win)
 i8
 getrootptr(i16 *x, i16 *y)
 {
+    XCB_TRL_SCOPE();
     u8 samescr;
 
     XCBCookie cookie = XCBQueryPointerCookie(_wm.dpy, _wm.root);
@@ -1019,7 +1590,8 @@ getrootptr(i16 *x, i16 *y)
 void
 grabbuttons(XCBWindow win, uint8_t focused)
 {
-    updatenumlockmask();
+    XCB_TRL_SCOPE();
+    /* _wm.numlockmask is kept up to date by grabkeys(), querying it here would block focus() */
     u16 i, j;
     /* numlock is int */
     int modifiers[4] = { 0, XCB_MOD_MASK_LOCK, _wm.numlockmask, _wm.numlockmask|XCB_MOD_MASK_LOCK};
@@ -1046,6 +1618,7 @@ grabbuttons(XCBWindow win, uint8_t focused)
 void
 grabkeys(void)
 {
+    XCB_TRL_SCOPE();
     updatenumlockmask();
     u32 i, j, k;
     u32 modifiers[4] = { 0, XCB_MOD_MASK_LOCK, _wm.numlockmask, _wm.numlockmask|XCB_MOD_MASK_LOCK };
@@ -1081,17 +1654,13 @@ grabkeys(void)
 void
 grid(Desktop *desk)
 {
-    if(!desk->clients)
-    {   return;
-    }
-
     i32 cx, cy;
-    u32 i, n, cw, ch, aw, ah, cols, rows;
+    u32 i, cw, ch, aw, ah, cols, rows;
     u32 tmpcw, tmpch;
+    u32 n;
     Client *c;
-    for(n = 0, c = nexttiled(desk->clients); c; c = nexttiled(c->next))
-    {   ++n;
-    }
+    Client **tiled = viewtiled(desk, &n);
+    const Monitor *m = desk->mon;
 
     if(!n) 
     {   return;
@@ -1106,15 +1675,16 @@ grid(Desktop *desk)
     }
     cols = rows - !!(rows && (rows - 1) * rows >= n);
     /* window geoms (cell height/width) */
-    ch = desk->clients->mon->wh / (rows + !rows);
-    cw = desk->clients->mon->ww / (cols + !cols);
-    for(i = 0, c = nexttiled(desk->clients); c; c = nexttiled(c->next))
+    ch = m->wh / (rows + !rows);
+    cw = m->ww / (cols + !cols);
+    for(i = 0; i < n; ++i)
     {
-        cx = desk->clients->mon->wx + (i / rows) * cw;
-        cy = desk->clients->mon->wy + (i % rows) * ch;
+        c = tiled[i];
+        cx = m->wx + (i / rows) * cw;
+        cy = m->wy + (i % rows) * ch;
         /* adjust height/width of last row/column's windows */
-        ah = !!((i + 1) % rows) * (desk->clients->mon->wh - ch * rows);
-        aw = !!(i >= rows * (cols - 1)) * (desk->clients->mon->ww - cw * cols);
+        ah = !!((i + 1) % rows) * (m->wh - ch * rows);
+        aw = !!(i >= rows * (cols - 1)) * (m->ww - cw * cols);
 
         /* _cfg.bgw without fucking everything else */
         cx += _cfg.bgw;
@@ -1130,17 +1700,37 @@ grid(Desktop *desk)
         tmpch -= !ah * _cfg.bgw;
 
         resize(c, cx, cy, tmpcw, tmpch, 0);
-        ++i;
     }
 }
 
+uint64_t
+layoutkey(Desktop *desk, Client **tiled, u32 count)
+{
+    const Monitor *m = desk->mon;
+    u32 mfact;
+    u64 key;
+    u32 i;
+
+    memcpy(&mfact, &_cfg.mfact, sizeof(mfact));
+    key = UI64Hash(((u64)(u16)m->wx << 48) | ((u64)(u16)m->wy << 32) | ((u64)m->ww << 16) | m->wh);
+    key = UI64Hash(key ^ (((u64)_cfg.nmaster << 48) | ((u64)_cfg.bgw << 32) | mfact));
+    /* applysizehints() keeps them atleast this big */
+    key = UI64Hash(key ^ m->bh);
+    /* in order, so a reordered set is another key */
+    for(i = 0; i < count; ++i)
+    {   key = UI64Hash(key ^ (((u64)tiled[i]->win << 16) | tiled[i]->bw));
+    }
+    return key;
+}
+
 Client *
 manage(XCBWindow win)
 {
+    XCB_TRL_SCOPE();
     Client *c, *t = NULL;
     XCBWindow trans = 0;
     u8 transstatus = 0;
-    u32 inputmask = XCB_EVENT_MASK_ENTER_WINDOW|XCB_EVENT_MASK_FOCUS_CHANGE|XCB_EVENT_MASK_PROPERTY_CHANGE|XCB_EVENT_MASK_STRUCTURE_NOTIFY;
+    u32 inputmask = CLIENTMASK;
     XCBWindowGeometry *wg;
 
     /* checks */
@@ -1158,6 +1748,8 @@ manage(XCBWindow win)
     XCBCookie statecookie = XCBGetWindowPropertyCookie(_wm.dpy, win, netatom[NetWMState], 0L, UINT32_MAX, False, XCB_ATOM_ATOM);
     XCBCookie sizehcookie = XCBGetWMNormalHintsCookie(_wm.dpy, win);
     XCBCookie wmhcookie   = XCBGetWMHintsCookie(_wm.dpy, win);
+    XCBCookie protocookie = XCBGetWindowPropertyCookie(_wm.dpy, win, wmatom[WMProtocols], 0L, UINT32_MAX, False, XCB_ATOM_ATOM);
+    XCBCookie synccookie  = XCBGetWindowPropertyCookie(_wm.dpy, win, netatom[NetWMSyncRequestCounter], 0L, 1L, False, XCB_ATOM_CARDINAL);
 
     XCBGetWindowAttributes *waattributes;
     XCBWindowProperty *wtypeunused;
@@ -1165,6 +1757,8 @@ manage(XCBWindow win)
     XCBSizeHints hints;
     u8 hintstatus = 0;
     XCBWMHints *wmh;
+    XCBWindowProperty *protocols;
+    XCBWindowProperty *counter;
 
     c = createclient(_wm.selmon);
     c->win = win;
@@ -1177,6 +1771,8 @@ manage(XCBWindow win)
     stateunused = XCBGetWindowPropertyReply(_wm.dpy, statecookie);
     hintstatus = XCBGetWMNormalHintsReply(_wm.dpy, sizehcookie, &hints);
     wmh = XCBGetWMHintsReply(_wm.dpy, wmhcookie);
+    protocols = XCBGetWindowPropertyReply(_wm.dpy, protocookie);
+    counter = XCBGetWindowPropertyReply(_wm.dpy, synccookie);
 
     /* On Failure clear flag and ignore hints */
     hints.flags *= !!hintstatus;    
@@ -1185,19 +1781,16 @@ manage(XCBWindow win)
     {   
         if(waattributes->override_redirect)
         {   
-            free(c);
+            cleanupclient(c);
             free(waattributes);
             free(wmh);
             free(stateunused);
             free(wtypeunused);
             free(wg);
+            free(protocols);
+            free(counter);
             return NULL;
         }
-        inputmask |= waattributes->your_event_mask; 
-        /* sometimes clients do dumb stuff that messes with out window managing
-         *
-         * inputmask &= ~waattributes->do_not_propagate_mask;
-         */
     }
 
     if(wtypeunused)
@@ -1213,17 +1806,19 @@ manage(XCBWindow win)
 
     if(wg)
     {   /* init geometry */
-        c->x = c->oldx = wg->x;
-        c->y = c->oldy = wg->y;
-        c->w = c->oldw = wg->width;
-        c->h = c->oldh = wg->height;
-        c->oldbw = wg->border_width;
+        c->x = c->info->oldx = wg->x;
+        c->y = c->info->oldy = wg->y;
+        c->w = c->info->oldw = wg->width;
+        c->h = c->info->oldh = wg->height;
+        c->info->oldbw = wg->border_width;
     }
 
     if(transstatus && trans && (t = wintoclient(trans)))
     {
         c->mon = t->mon;
         c->desktop = t->desktop;
+        /* not whatever was viewed, a dialog opened while viewing every desktop would be sticky */
+        c->tags = t->tags;
     }
     else
     {
@@ -1246,6 +1841,7 @@ manage(XCBWindow win)
     updatetitle(c);
     updatesizehints(c, &hints);
     updatewmhints(c, wmh);
+    updatesynccounter(c, protocols, counter);
     XCBSelectInput(_wm.dpy, win, inputmask);
     grabbuttons(win, 0);
 
@@ -1255,6 +1851,7 @@ manage(XCBWindow win)
     attachstack(c);
     XCBChangeProperty(_wm.dpy, _wm.root, netatom[NetClientList], XCB_ATOM_WINDOW, 32, XCB_PROP_MODE_APPEND, (unsigned char *)&win, 1);
     setclientstate(c, XCB_WINDOW_NORMAL_STATE);
+    updateclientdesktop(c);
     /* map the window or we get errors */
     XCBMapWindow(_wm.dpy, win);
 
@@ -1272,6 +1869,8 @@ manage(XCBWindow win)
     free(stateunused);
     free(wtypeunused);
     free(wg);
+    free(protocols);
+    free(counter);
 
     return c;
 }
@@ -1279,18 +1878,22 @@ manage(XCBWindow win)
 void
 monocle(Desktop *desk)
 {
-    if(!desk->clients)
+    u32 n;
+    Client **tiled = viewtiled(desk, &n);
+    if(!n)
     {   return;
     }
     Client *c;
+    u32 i;
     u32 nw, nh;
-    const u32 nx = desk->clients->mon->wx;
-    const u32 ny = desk->clients->mon->wy;
+    const u32 nx = desk->mon->wx;
+    const u32 ny = desk->mon->wy;
 
-    for(c = nexttiled(desk->clients); c; c = nexttiled(c->next))
+    for(i = 0; i < n; ++i)
     {
-        nw = desk->clients->mon->ww - (c->bw * 2);
-        nh = desk->clients->mon->wh - (c->bw * 2);
+        c = tiled[i];
+        nw = desk->mon->ww - (c->bw * 2);
+        nh = desk->mon->wh - (c->bw * 2);
         resize(c, nx, ny, nw, nh, 0); 
         if(docked(c))
         {   setfloating(c, 0);
@@ -1307,7 +1910,7 @@ nextclient(Client *c)
 Desktop *
 nextdesktop(Desktop *desk)
 {
-    return desk ? desk->next : desk;
+    return desk && desk->num + 1 < desk->mon->deskcount ? desk + 1 : NULL;
 }
 
 Monitor *
@@ -1338,10 +1941,16 @@ nextvisible(Client *c)
 Client *
 lastvisible(Client *c)
 {
-    for(; c && !ISVISIBLE(c); c = c->prev);
+    for(; c && !ISVISIBLE(c); c = c->info->prev);
     return c;
 }
 
+Desktop *
+numtodesktop(Monitor *m, u32 num)
+{
+    return num < m->deskcount ? &m->desktops[num] : NULL;
+}
+
 void
 quit(void)
 {
@@ -1362,6 +1971,24 @@ recttomon(i16 x, i16 y, u16 w, u16 h)
 	return r;
 }
 
+void
+remap(Client *c)
+{
+    XCB_TRL_SCOPE();
+    /* everything manage() would fetch is still in the Client, but what changed while it was withdrawn */
+    detachwithdrawn(c);
+    timercancel(&c->info->grace);
+    attach(c);
+    attachstack(c);
+    if(c->info->stale)
+    {   updatestale(c);
+    }
+    XCBMapWindow(_wm.dpy, c->win);
+    idleadd(&_wm.clientlist, updateclientlistidle, NULL);
+    arrange(c->desktop);
+    focus(c);
+}
+
 void
 resize(Client *c, int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t interact)
 {
@@ -1373,10 +2000,11 @@ resize(Client *c, int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t
 void 
 resizeclient(Client *c, int16_t x, int16_t y, uint16_t width, uint16_t height)
 {
-    c->oldx = c->x;
-    c->oldy = c->y;
-    c->oldw = c->w;
-    c->oldh = c->h;
+    XCB_TRL_SCOPE();
+    c->info->oldx = c->x;
+    c->info->oldy = c->y;
+    c->info->oldw = c->w;
+    c->info->oldh = c->h;
     c->x = x;
     c->y = y;
     c->w = width;
@@ -1389,55 +2017,54 @@ resizeclient(Client *c, int16_t x, int16_t y, uint16_t width, uint16_t height)
 void
 restack(Desktop *desk)
 {
-    Client *c;
+    XCB_TRL_SCOPE();
+    /* raised in this order, floating ones only if the layout tiles */
+    const u16 raise[] = { _FLOATING, _ALWAYSONTOP, _DIALOG, _MODAL };
+    Desktop *desks[TAGSLENGTH];
     XCBWindowChanges wc;
+    Client *c;
+    u32 n = 1;
+    u32 i;
+    u32 r;
 
-    c = desk->stack;
-    if(!c)
-    {   return;
+    desks[0] = desk;
+    /* a desktop of the view restacks all of it, desksel lays it out (see viewtiled()) */
+    if(desk->ntagged || desk->mon->tagset & TAGBIT(desk))
+    {
+        n = viewdesktops(desk->mon, desks);
+        desk = desk->mon->desksel;
     }
 
     wc.stack_mode = XCB_STACK_MODE_BELOW;
-    if(c->mon->barwin)
-    {   wc.sibling = c->mon->barwin;
-    }
-    else
-    {   
-        wc.sibling = c->win;
-        c = nextstack(c);
-    }
+    /* without a bar the topmost client is what the rest go below */
+    wc.sibling = desk->mon->barwin;
     /* configure windows */
-    for(; c; c = nextstack(c))
+    for(i = 0; i < n; ++i)
     {
-        XCBConfigureWindow(_wm.dpy, c->win, XCB_CONFIG_WINDOW_SIBLING|XCB_CONFIG_WINDOW_STACK_MODE, &wc);
-        wc.sibling = c->win;
-    }
-
-    if(layouts[desk->layout].arrange != floating)
-    {
-        for(c = desk->stack; c; c = nextstack(c))
+        for(c = desks[i]->stack; c; c = nextstack(c))
         {
-            if(ISFLOATING(c) && ISVISIBLE(c))
-            {   XCBRaiseWindow(_wm.dpy, c->win);
+            /* the other desktops' hidden clients are off screen and left alone */
+            if(desks[i] != desk && !ISVISIBLE(c))
+            {   continue;
             }
+            if(wc.sibling)
+            {   XCBConfigureWindow(_wm.dpy, c->win, XCB_CONFIG_WINDOW_SIBLING|XCB_CONFIG_WINDOW_STACK_MODE, &wc);
+            }
+            wc.sibling = c->win;
         }
     }
-    for(c = desk->stack; c; c = nextstack(c))
-    {
-        if(ISALWAYSONTOP(c) && ISVISIBLE(c))
-        {   XCBRaiseWindow(_wm.dpy, c->win);
-        }
-    }
-    for(c = desk->stack; c; c = nextstack(c))
-    {
-        if(ISDIALOG(c) && ISVISIBLE(c))
-        {   XCBRaiseWindow(_wm.dpy, c->win);
-        }
-    }
-    for(c = desk->stack; c; c = nextstack(c))
+
+    /* bottom up, the last one raised ends up on top so the top of the stack goes last */
+    for(r = layouts[desk->layout].arrange == floating; r < LENGTH(raise); ++r)
     {
-        if(ISMODAL(c) && ISVISIBLE(c))
-        {   XCBRaiseWindow(_wm.dpy, c->win);
+        for(i = n; i--;)
+        {
+            for(c = desks[i]->slast; c; c = c->info->sprev)
+            {
+                if(c->flags & raise[r] && ISVISIBLE(c))
+                {   XCBRaiseWindow(_wm.dpy, c->win);
+                }
+            }
         }
     }
 }
@@ -1448,24 +2075,82 @@ restart(void)
     _wm.restart = 1;
 }
 
-void 
+void
 run(void)
 {
+    XCB_TRL_SCOPE();
     XCBGenericEvent *ev = NULL;
+    struct epoll_event ready[WakeLast];
+    struct epoll_event add;
+    /* indexed by the Wake* enum */
+    const int fds[WakeLast] = { XCBConnectionNumber(_wm.dpy), _wm.sigfd, timerinit() };
+    int i;
+    int n;
+
+    if((_wm.epfd = epoll_create1(EPOLL_CLOEXEC)) == -1)
+    {   DIECAT("%s", "FATAL: CANNOT_CREATE_EPOLL");
+    }
+    for(i = 0; i < WakeLast; ++i)
+    {
+        add.events = EPOLLIN;
+        add.data.u32 = i;
+        if(fds[i] == -1 || epoll_ctl(_wm.epfd, EPOLL_CTL_ADD, fds[i], &add) == -1)
+        {   DIECAT("%s", "FATAL: CANNOT_POLL_FD");
+        }
+    }
     XCBSync(_wm.dpy);
-    while((_wm.running && !_wm.restart) && (((ev = XCBPollForEvent(_wm.dpy))) || (XCBNextEvent(_wm.dpy, &ev))))
+    while(_wm.running && !_wm.restart)
     {
-        eventhandler(ev);
-        free(ev);
-        ev = NULL;
+        /* handle everything the XServer sent before going idle */
+        while(_wm.running && !_wm.restart && (ev = XCBPollForEvent(_wm.dpy)))
+        {
+            eventhandler(ev);
+            free(ev);
+        }
+        if((_wm.has_error = XCBCheckDisplayError(_wm.dpy)) || !_wm.running || _wm.restart)
+        {   break;
+        }
+        /* work the handlers deferred to after this batch */
+        _wm.idletasks += idlerun();
+        /* idle, so everything the handlers queued goes out in one write */
+        XCBFlush(_wm.dpy);
+        ++_wm.idleflushes;
+        /* flushing may read events into the queue without the fd becoming readable */
+        if((ev = XCBPollForQueuedEvent(_wm.dpy)))
+        {
+            eventhandler(ev);
+            free(ev);
+            continue;
+        }
+        /* tasks queued by idle tasks run in the next batch without waiting */
+        n = epoll_wait(_wm.epfd, ready, WakeLast, idlequeued() ? 0 : -1);
+        if(n == -1 && errno != EINTR)
+        {   DEBUG("%s", "epoll_wait() failed");
+            break;
+        }
+        for(i = 0; i < n; ++i)
+        {
+            ++_wm.wakeups[ready[i].data.u32];
+            switch(ready[i].data.u32)
+            {
+                case WakeSignal:
+                    sigfdhandler();
+                    break;
+                case WakeTimer:
+                    timerrun();
+                    break;
+            }
+        }
     }
-    _wm.has_error = XCBCheckDisplayError(_wm.dpy);
+    close(_wm.epfd);
+    _wm.epfd = -1;
 }
 
 /* scan for clients initally */
 void
 scan(void)
 {
+    XCB_TRL_SCOPE();
     u16 i, num;
     XCBWindow *wins = NULL;
     const XCBCookie cookie = XCBQueryTreeCookie(_wm.dpy, _wm.root);
@@ -1537,10 +2222,12 @@ sendmon(Client *c, Monitor *m)
     }
     unfocus(c, 1);
     detachcompletely(c);
+    c->tags = ISSTICKY(c) ? TAGMASK(m) : TAGBIT(m->desksel);
     c->mon = m;
     c->desktop = m->desksel;
     attach(c);
     attachstack(c);
+    updateclientdesktop(c);
     focus(NULL);
     /* arrangeall() */
 }
@@ -1555,29 +2242,72 @@ setalwaysontop(Client *c, u8 state)
 void
 setborderwidth(Client *c, uint16_t border_width)
 {
-    c->oldbw = c->bw;
+    c->info->oldbw = c->bw;
     c->bw = border_width;
 }
 
 void
 setclientdesktop(Client *c, Desktop *desk)
 {
-    if(c->next || c->prev)
+    if(c->next || c->info->prev || c->desktop->clients == c)
     {   detach(c);
     }
+    /* it is only shown there */
+    c->tags = TAGBIT(desk);
     c->desktop = desk;
     attach(c);
+    updateclientdesktop(c);
 }
 
 void
 setclientstate(Client *c, u8 state)
 {
+    XCB_TRL_SCOPE();
     i32 data[2] = { state, XCB_NONE };
     
     XCBChangeProperty(_wm.dpy, c->win, wmatom[WMState], wmatom[WMState],
             32, XCB_PROP_MODE_REPLACE, (unsigned char *)data, 2);
 }
 
+void
+setclienttags(Client *c, u32 tags)
+{
+    Desktop *desk = c->desktop;
+    const u8 attached = c->next || c->info->prev || desk->clients == c;
+    const u8 sticky = ISSTICKY(c);
+
+    tags &= TAGMASK(c->mon);
+    if(!tags)
+    {   return;
+    }
+    /* its lists live on one of its desktops, the lowest one once it leaves this one */
+    if(!(tags & TAGBIT(desk)))
+    {
+        if(attached)
+        {   detachcompletely(c);
+        }
+        c->desktop = numtodesktop(c->mon, __builtin_ctz(tags));
+        c->tags = tags;
+        if(attached)
+        {
+            attach(c);
+            attachstack(c);
+        }
+    }
+    else
+    {
+        if(attached)
+        {   desk->ntagged += (tags != TAGBIT(desk)) - (c->tags != TAGBIT(desk));
+        }
+        c->tags = tags;
+    }
+    updateclientdesktop(c);
+    /* every tag is sticky, however it got there */
+    if(sticky != ISSTICKY(c))
+    {   updatenetwmstate(c);
+    }
+}
+
 void
 updatedesktop(void)
 {
@@ -1591,6 +2321,12 @@ setdesktoplayout(Desktop *desk, uint8_t layout)
     desk->olayout = layout;
     desk->layout = layout;
 }
+
+void
+setdesktopsel(Monitor *m, Desktop *desk)
+{
+    setview(m, TAGBIT(desk));
+}
 void
 updatedesktopnames(void)
 {
@@ -1632,15 +2368,20 @@ setfloating(Client *c, uint8_t state)
 
     c->flags &= (~_FLOATING);
     c->flags |= (_FLOATING * !!state);
+    if(!!WASFLOATING(c) != !!state)
+    {   updatetiled(c);
+    }
+    CHECKCLIENTS(c->desktop);
 }
 
 void
 setfullscreen(Client *c, u8 state)
 {
+    XCB_TRL_SCOPE();
     if(state && !ISFULLSCREEN(c))
     {
-        XCBChangeProperty(_wm.dpy, c->win, netatom[NetWMState], XCB_ATOM_ATOM, 32,
-        XCB_PROP_MODE_REPLACE, (unsigned char *)&netatom[NetWMStateFullscreen], 1);
+        c->flags |= _FULLSCREEN;
+        updatenetwmstate(c);
         setborderwidth(c, c->bw);
         setborderwidth(c, 0);
         resizeclient(c, c->mon->mx, c->mon->wy, c->mon->mw, c->mon->mh);
@@ -1648,38 +2389,88 @@ setfullscreen(Client *c, u8 state)
     }
     else if(!state && ISFULLSCREEN(c))
     {
-        XCBChangeProperty(_wm.dpy, c->win, netatom[NetWMState], XCB_ATOM_ATOM, 32, 
-        XCB_PROP_MODE_REPLACE, (unsigned char *)0, 0);
-        setborderwidth(c, c->oldbw);
-        resizeclient(c, c->oldx, c->oldy, c->oldw, c->oldh);
+        c->flags &= (~_FULLSCREEN);
+        updatenetwmstate(c);
+        setborderwidth(c, c->info->oldbw);
+        resizeclient(c, c->info->oldx, c->info->oldy, c->info->oldw, c->info->oldh);
+    }
+}
+
+void
+setfocus(Client *c)
+{
+    XCB_TRL_HOT_SCOPE();
+    if(!NEVERFOCUS(c))
+    {
+        XCBSetInputFocus(_wm.dpy, c->win, XCB_INPUT_FOCUS_POINTER_ROOT, XCB_CURRENT_TIME);
+        XCBChangeProperty(_wm.dpy, _wm.root, netatom[NetActiveWindow], XCB_ATOM_WINDOW, 32, XCB_PROP_MODE_REPLACE, (unsigned char *)&(c->win), 1);
+        XCBClientMessageEvent ev;
+        ev.type = wmatom[WMProtocols];
+        ev.response_type = XCB_CLIENT_MESSAGE;
+        ev.window = c->win;
+        ev.format = 32;
+        ev.data.data32[0] = wmatom[WMTakeFocus];
+        ev.data.data32[1] = XCB_CURRENT_TIME;
+        XCBSendEvent(_wm.dpy, c->win, False, XCB_NONE, (const char *)&ev);
+    }
+}
+
+void
+setmaximizedhorz(Client *c, uint8_t state)
+{
+    XCB_TRL_SCOPE();
+    if(!!state == !!ISMAXIMIZEDHORZ(c))
+    {   return;
+    }
+    if(state)
+    {
+        c->info->savex = c->x;
+        c->info->savew = c->w;
+        /* the layout would undo it */
+        setfloating(c, 1);
+        resizeclient(c, c->mon->wx, c->y, c->mon->ww - c->bw * 2, c->h);
+    }
+    else
+    {   resizeclient(c, c->info->savex, c->y, c->info->savew, c->h);
     }
-    c->flags &= (~_FULLSCREEN);
-    c->flags |= (_FULLSCREEN * !!state);
+    c->flags &= (~_MAXIMIZEDHORZ);
+    c->flags |= (_MAXIMIZEDHORZ * !!state);
+    updatenetwmstate(c);
 }
 
 void
-setfocus(Client *c)
+setmaximizedvert(Client *c, uint8_t state)
 {
-    if(!NEVERFOCUS(c))
+    XCB_TRL_SCOPE();
+    if(!!state == !!ISMAXIMIZEDVERT(c))
+    {   return;
+    }
+    if(state)
     {
-        XCBSetInputFocus(_wm.dpy, c->win, XCB_INPUT_FOCUS_POINTER_ROOT, XCB_CURRENT_TIME);
-        XCBChangeProperty(_wm.dpy, _wm.root, netatom[NetActiveWindow], XCB_ATOM_WINDOW, 32, XCB_PROP_MODE_REPLACE, (unsigned char *)&(c->win), 1);
-        XCBClientMessageEvent ev;
-        ev.type = wmatom[WMProtocols];
-        ev.response_type = XCB_CLIENT_MESSAGE;
-        ev.window = c->win;
-        ev.format = 32;
-        ev.data.data32[0] = wmatom[WMTakeFocus];
-        ev.data.data32[1] = XCB_CURRENT_TIME;
-        XCBSendEvent(_wm.dpy, c->win, False, XCB_NONE, (const char *)&ev);
+        c->info->savey = c->y;
+        c->info->saveh = c->h;
+        /* the layout would undo it */
+        setfloating(c, 1);
+        resizeclient(c, c->x, c->mon->wy, c->w, c->mon->wh - c->bw * 2);
+    }
+    else
+    {   resizeclient(c, c->x, c->info->savey, c->w, c->info->saveh);
     }
+    c->flags &= (~_MAXIMIZEDVERT);
+    c->flags |= (_MAXIMIZEDVERT * !!state);
+    updatenetwmstate(c);
 }
 
 void 
 sethidden(Client *c, uint8_t state)
 {
+    const u8 washidden = !!ISHIDDEN(c);
     c->flags &= (~_HIDDEN);
     c->flags |= (_HIDDEN * !!state);
+    if(washidden != !!state)
+    {   updatetiled(c);
+    }
+    CHECKCLIENTS(c->desktop);
 }
 void
 setmodal(Client *c, uint8_t state)
@@ -1705,13 +2496,9 @@ setshowbar(Monitor *m, uint8_t state)
 void
 setsticky(Client *c, u8 sticky)
 {
-    const XCBWindow win = c->win;
-    const XCBAtom replace = !!sticky * netatom[NetWMStateSticky];
-    XCBChangeProperty(_wm.dpy, win, netatom[NetWMState], XCB_ATOM_ATOM, 32, 
-            XCB_PROP_MODE_REPLACE, (unsigned char *)&replace, !!replace);
-
-    c->flags &= (~_STICKY);
-    c->flags |= (_STICKY * !!sticky);
+    XCB_TRL_SCOPE();
+    /* sticky is every tag, setclienttags() updates _NET_WM_STATE */
+    setclienttags(c, sticky ? TAGMASK(c->mon) : TAGBIT(c->desktop));
 }
 
 void 
@@ -1724,9 +2511,17 @@ settopbar(Monitor *m, uint8_t state)
 void
 setup(void)
 {
+    XCB_TRL_SCOPE();
     /* clean up any zombies immediately */
     sighandler();
 
+    /* Slabs are sized for the usual case and grow when it is exceeded, Desktops live in their Monitor (see createmon()).
+     * Clients get a slab per desktop (see createclient()) so the usual count is spread over them.
+     */
+    poolinit(&_wm.clientpool, sizeof(Client), MAX(CFG_MAX_CLIENT_COUNT / CFG_DESKTOP_COUNT, 1));
+    poolinit(&_wm.infopool, sizeof(ClientInfo), CFG_MAX_CLIENT_COUNT);
+    poolinit(&_wm.monpool, sizeof(Monitor), 4);
+
     /* startup wm */
     _wm.running = 1;
     _wm.syms = XCBKeySymbolsAlloc(_wm.dpy);
@@ -1736,6 +2531,17 @@ setup(void)
 
     updatesettings();
 
+    /* _NET_WM_SYNC_REQUEST needs an alarm on the client counter */
+    _wm.syncevent = XCBSyncInit(_wm.dpy);
+    if(_wm.syncevent)
+    {   _wm.drag.alarm = XCBSyncCreateAlarm(_wm.dpy);
+    }
+    /* held keys send only KeyPress's instead of KeyRelease/KeyPress pairs, see keypress() */
+    _wm.detectablerepeat = XCBSetDetectableAutoRepeat(_wm.dpy, 1);
+    if(!_wm.detectablerepeat)
+    {   DEBUG0("Detectable autorepeat unsupported, falling back to matching KeyRelease/KeyPress pairs.");
+    }
+
     updategeom();
     const XCBCookie utf8cookie = XCBInternAtomCookie(_wm.dpy, "UTF8_STRING", False);
     XCBInitAtoms(_wm.dpy, wmatom, netatom);
@@ -1761,7 +2567,6 @@ setup(void)
     wa.event_mask = 
                     XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT|XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY
                     |XCB_EVENT_MASK_BUTTON_PRESS|XCB_EVENT_MASK_BUTTON_RELEASE
-                    |XCB_EVENT_MASK_POINTER_MOTION
                     |XCB_EVENT_MASK_ENTER_WINDOW|XCB_EVENT_MASK_LEAVE_WINDOW
                     |XCB_EVENT_MASK_STRUCTURE_NOTIFY
                     |XCB_EVENT_MASK_PROPERTY_CHANGE
@@ -1797,61 +2602,144 @@ updateviewport(void)
 }
 
 
+void
+setview(Monitor *m, u32 tagset)
+{
+    XCB_TRL_SCOPE();
+    Desktop *desk = m->desksel;
+    const u32 old = m->tagset;
+
+    tagset &= TAGMASK(m);
+    if(!tagset || tagset == old)
+    {   return;
+    }
+    /* the lowest shown desktop lays out the view, unless the selected one is still shown */
+    if(!(tagset & TAGBIT(desk)))
+    {   desk = numtodesktop(m, __builtin_ctz(tagset));
+    }
+    if(m->desksel != desk && m->desksel->sel)
+    {   unfocus(m->desksel->sel, 0);
+    }
+    m->desksel = desk;
+    m->tagset = tagset;
+    /* Nothing below waits on a reply, so the whole switch goes out back to back in the next flush.
+     * The new clients are stacked on top while still off screen and shown before the old ones leave,
+     * so no frame shows the bare root in between.
+     */
+    if(_cfg.switchgrab)
+    {   XCBGrabServer(_wm.dpy);
+    }
+    restack(desk);
+    showhideview(m, old, tagset);
+    arrangedesktop(desk);
+    showhideview(m, tagset, old);
+    focus(NULL);
+    if(m == _wm.selmon)
+    {   updatedesktop();
+    }
+    if(_cfg.switchgrab)
+    {   XCBUngrabServer(_wm.dpy);
+    }
+}
+
+void
+showhideview(Monitor *m, u32 from, u32 tagset)
+{
+    Desktop *d;
+    Client *c;
+    for(d = m->desktops; d; d = nextdesktop(d))
+    {
+        /* none of its clients can change unless its own bit did or it has clients shown elsewhere */
+        if(!d->ntagged && !(TAGBIT(d) & tagset & ~from))
+        {   continue;
+        }
+        for(c = d->stack; c; c = nextstack(c))
+        {
+            if(!ISHIDDEN(c) && c->tags & tagset && !(c->tags & from))
+            {   showhide(c);
+            }
+        }
+    }
+}
+
 void
 showhide(const Client *restrict c)
 {
+    XCB_TRL_SCOPE();
     if(ISVISIBLE(c))
     {   XCBMoveWindow(_wm.dpy, c->win, c->x, c->y);
     }
     else
-    {   
-        const i16 x = (c->mon->mx - (WIDTH(c) / 2));
+    {   /* left of the root window, no monitor shows any part of it (like dwm) */
+        const i32 x = MAX(WIDTH(c) * -2, INT16_MIN);
         XCBMoveWindow(_wm.dpy, c->win, x, c->y);
     }
 }
 
 void
-sigchld(int signo) /* signal */
+sigchld(int signo)
 {
     /* wait for childs (zombie proccess) to die */
     (void)signo;
     while (0 < waitpid(-1, NULL, WNOHANG));
 }
 
+void
+sigfdhandler(void)
+{
+    struct signalfd_siginfo info;
+    /* pending signals of the same kind are merged, read until empty */
+    while(read(_wm.sigfd, &info, sizeof(info)) == sizeof(info))
+    {
+        switch(info.ssi_signo)
+        {
+            case SIGCHLD:
+                sigchld(info.ssi_signo);
+                break;
+            case SIGHUP:
+                sighup(info.ssi_signo);
+                break;
+            case SIGTERM:
+            case SIGINT:
+                sigterm(info.ssi_signo);
+                break;
+        }
+    }
+}
+
 void
 sighandler(void)
 {
-    if(signal(SIGCHLD, &sigchld) == SIG_ERR)
-    {   DIECAT("%s", "FATAL: CANNOT_INSTALL_SIGCHLD_HANDLER");
+    sigset_t set;
+    /* signals are read from a signalfd in run() instead of interrupting it,
+     * SpawnWindow() restores the mask for its children.
+     */
+    sigemptyset(&set);
+    sigaddset(&set, SIGCHLD);
+    sigaddset(&set, SIGTERM);
+    sigaddset(&set, SIGHUP);
+    sigaddset(&set, SIGINT);
+    if(sigprocmask(SIG_BLOCK, &set, NULL) == -1)
+    {   DIECAT("%s", "FATAL: CANNOT_BLOCK_SIGNALS");
+    }
+    if((_wm.sigfd = signalfd(-1, &set, SFD_NONBLOCK | SFD_CLOEXEC)) == -1)
+    {   DIECAT("%s", "FATAL: CANNOT_CREATE_SIGNALFD");
     }
     /* wait for zombies to die */
     sigchld(0);
-    if(signal(SIGTERM, &sigterm) == SIG_ERR) 
-    {   
-        DIECAT("%s", "FATAL: CANNOT_INSTALL_SIGTERM_HANDLER");
-        signal(SIGTERM, SIG_DFL); /* default signal */
-    }
-    if(signal(SIGHUP, &sighup) == SIG_ERR) 
-    {   
-        DEBUG("%s", "WARNING: CANNOT_INSTALL_SIGHUP_HANDLER");
-        signal(SIGHUP, SIG_DFL); /* default signal */
-    }
-    if(signal(SIGINT, &sigterm) == SIG_ERR)
-    {   
-        DEBUG("%s", "WARNING: CANNOT_INSTALL_SIGINT_HANDLER");
-        signal(SIGINT, SIG_DFL);
-    }
 }
 
 void
-sighup(int signo) /* signal */
+sighup(int signo)
 {
+    (void)signo;
     restart();
 }
 
 void
 sigterm(int signo)
 {
+    (void)signo;
     quit();
 }
 
@@ -1962,26 +2850,20 @@ void
 tile(Desktop *desk)
 {
     unsigned int h, mw, my, ty;
-    int n, i;
+    int i;
     int nx, ny;
     int nw, nh;
     Client *c = NULL;
     Monitor *m = NULL;
-
-    if(!desk->clients)
-    {   return;
-    }
-
-
-    m = desk->clients->mon;
-
-    for(n = 0, c = nexttiled(desk->clients); c; c = nexttiled(c->next))
-    {   ++n;
-    }
+    u32 count;
+    Client **tiled = viewtiled(desk, &count);
+    const int n = count;
 
     if(!n) 
     {   return;
     }
+
+    m = desk->mon;
     
     if(n > _cfg.nmaster)
     {   mw = _cfg.nmaster ? m->ww * _cfg.mfact: 0;
@@ -1990,8 +2872,9 @@ tile(Desktop *desk)
     {   mw = m->ww;
     }
 
-    for (i = my = ty = 0, c = nexttiled(desk->clients); c; c = nexttiled(c->next), ++i)
+    for (i = my = ty = 0; i < n; ++i)
     {
+        c = tiled[i];
         if (i < _cfg.nmaster)
         {
             h = (m->wh - my) / (MIN(n, _cfg.nmaster) - i);
@@ -2035,6 +2918,7 @@ tile(Desktop *desk)
 void
 unfocus(Client *c, uint8_t setfocus)
 {
+    XCB_TRL_HOT_SCOPE();
     if(!c)   
     {   return;
     }
@@ -2063,6 +2947,7 @@ isuniquegeom(XCBXineramaScreenInfo *unique, size_t n, XCBXineramaScreenInfo *inf
 int
 updategeom(void)
 {
+    XCB_TRL_SCOPE();
 	int dirty = 0;
 
 #ifdef XINERAMA
@@ -2171,6 +3056,10 @@ updategeom(void)
 	}
 	if (dirty) 
     {
+        Monitor *m;
+        for(m = _wm.mons; m; m = m->next)
+        {   updatecrosswin(m);
+        }
 		_wm.selmon = _wm.mons;
 		_wm.selmon = wintomon(_wm.root);
 	}
@@ -2180,6 +3069,7 @@ updategeom(void)
 void
 unmanage(Client *c, uint8_t destroyed)
 {
+    XCB_TRL_SCOPE();
     Desktop *desk = c->desktop;
     if(!c)
     {   return;
@@ -2195,10 +3085,16 @@ unmanage(Client *c, uint8_t destroyed)
      * Memory leak if a client is unmaped and maped again
      * (cause we would get the same input focus twice)
      */
+    if(_wm.drag.c == c)
+    {   
+        _wm.drag.dirty = 0;
+        dragstop();
+    }
     detachcompletely(c);
     cleanupclient(c);
     focus(NULL);
-    updateclientlist();
+    /* several clients usually go at once */
+    idleadd(&_wm.clientlist, updateclientlistidle, NULL);
     arrange(desk);
     c = NULL;
 }
@@ -2228,9 +3124,19 @@ updatebarpos(Monitor *m)
     }
 }
 
+void
+updateclientdesktop(Client *c)
+{
+    XCB_TRL_SCOPE();
+    /* 0xFFFFFFFF is every desktop */
+    const u32 data[1] = { ISSTICKY(c) ? 0xFFFFFFFF : (u32)c->desktop->num };
+    XCBChangeProperty(_wm.dpy, c->win, netatom[NetWMDesktop], XCB_ATOM_CARDINAL, 32, XCB_PROP_MODE_REPLACE, (unsigned char *)data, 1);
+}
+
 void
 updateclientlist(void)
 {
+    XCB_TRL_SCOPE();
     Client *c;
     Monitor *m;
     Desktop *desk;
@@ -2250,24 +3156,89 @@ updateclientlist(void)
 }
 
 
+void
+updateclientlistidle(Idle *task)
+{
+    (void)task;
+    updateclientlist();
+}
+
+void
+updatecrosswin(Monitor *m)
+{
+    XCB_TRL_SCOPE();
+    /* Monitor changes are noticed by crossing into a window instead of root pointer motion,
+     * a client's EnterNotify covers clients and this covers the monitor background.
+     * Being InputOnly and below every client it draws nothing, and clicks on it propagate to the root.
+     */
+    if(!m->crosswin)
+    {
+        const u32 values[] = { 1, XCB_EVENT_MASK_ENTER_WINDOW };
+        m->crosswin = XCBCreateWindow(_wm.dpy, _wm.root, m->mx, m->my, m->mw, m->mh, 0, 0, 
+                XCB_WINDOW_CLASS_INPUT_ONLY, XCB_COPY_FROM_PARENT, XCB_CW_OVERRIDE_REDIRECT|XCB_CW_EVENT_MASK, values);
+        XCBLowerWindow(_wm.dpy, m->crosswin);
+        XCBMapWindow(_wm.dpy, m->crosswin);
+    }
+    else
+    {   
+        XCBMoveResizeWindow(_wm.dpy, m->crosswin, m->mx, m->my, m->mw, m->mh);
+        XCBLowerWindow(_wm.dpy, m->crosswin);
+    }
+}
+
+void
+updatenetwmstate(Client *c)
+{
+    XCB_TRL_SCOPE();
+    /* the property is every state at once, so a replace has to carry the ones we did not change */
+    XCBAtom state[8];
+    u8 n = 0;
+
+    if(ISFULLSCREEN(c))
+    {   state[n++] = netatom[NetWMStateFullscreen];
+    }
+    if(ISALWAYSONTOP(c))
+    {   state[n++] = netatom[NetWMStateAbove];
+    }
+    if(ISURGENT(c))
+    {   state[n++] = netatom[NetWMStateDemandAttention];
+    }
+    if(ISMAXIMIZEDVERT(c))
+    {   state[n++] = netatom[NetWMStateMaximizedVert];
+    }
+    if(ISMAXIMIZEDHORZ(c))
+    {   state[n++] = netatom[NetWMStateMaximizedHorz];
+    }
+    if(ISSTICKY(c))
+    {   state[n++] = netatom[NetWMStateSticky];
+    }
+    if(ISMODAL(c))
+    {   state[n++] = netatom[NetWMStateModal];
+    }
+    if(ISHIDDEN(c))
+    {   state[n++] = netatom[NetWMStateHidden];
+    }
+    XCBChangeProperty(_wm.dpy, c->win, netatom[NetWMState], XCB_ATOM_ATOM, 32, 
+            XCB_PROP_MODE_REPLACE, (unsigned char *)state, n);
+}
 
 void
 updatenumlockmask(void)
 {
+    XCB_TRL_SCOPE();
     /* taken from i3 */
     XCBKeyboardModifier *reply;
-    XCBGenericError *err;
 
-    reply = xcb_get_modifier_mapping_reply(_wm.dpy, xcb_get_modifier_mapping(_wm.dpy), &err);
-    if(err)
+    reply = XCBGetModifierMappingReply(_wm.dpy, XCBGetModifierMappingCookie(_wm.dpy));
+    if(!reply)
     {   return;
     }
 
-	xcb_keycode_t *codes = xcb_get_modifier_mapping_keycodes(reply);
-	xcb_keycode_t target, *temp = NULL;
+	XCBKeyCode *codes = XCBGetModifierMappingKeyCodes(reply);
+	XCBKeyCode target, *temp = NULL;
 	unsigned int i, j;
 
-    if(!(temp = xcb_key_symbols_get_keycode(_wm.syms, XK_Num_Lock)))
+    if(!(temp = XCBKeySymbolsGetKeyCode(_wm.syms, XK_Num_Lock)))
     {   free(reply);
         return;
     }
@@ -2290,7 +3261,19 @@ updatesettings(void)
     _cfg.bw = 0;
     _cfg.bgw = 15;
     _cfg.snap = 10;
-    _cfg.rfrate = 120;
+    _cfg.rfrate = CFG_WIN_RATE;
+    _cfg.synctimeout = CFG_SYNC_TIMEOUT;
+    _cfg.keystep = CFG_KEY_STEP;
+    _cfg.keygap = CFG_KEY_REPEAT_GAP;
+    _cfg.fightgap = CFG_FOCUS_FIGHT_GAP;
+    _cfg.fightlimit = CFG_FOCUS_FIGHT_LIMIT;
+    _cfg.fightbackoff = CFG_FOCUS_FIGHT_BACKOFF;
+    _cfg.fightmax = CFG_FOCUS_FIGHT_MAX;
+    _cfg.confgap = CFG_CONFIGURE_LOOP_GAP;
+    _cfg.conflimit = CFG_CONFIGURE_LOOP_LIMIT;
+    _cfg.withdrawgrace = CFG_WITHDRAW_GRACE;
+    _cfg.deskcount = CFG_DESKTOP_COUNT;
+    _cfg.switchgrab = CFG_DESKTOP_SWITCH_GRAB;
     _cfg.bh = 10;
     _cfg.maxcc = 256;
     _cfg.hoverfocus = 0;
@@ -2302,58 +3285,207 @@ void
 updatesizehints(Client *c, XCBSizeHints *size)
 {
     /* init values */
-    c->basew = c->baseh = 0;
-    c->incw = c->inch = 0;
-    c->maxw = c->maxh = 0;
-    c->minw = c->minh = 0;
-    c->maxa = c->mina = 0.0;
+    c->info->basew = c->info->baseh = 0;
+    c->info->incw = c->info->inch = 0;
+    c->info->maxw = c->info->maxh = 0;
+    c->info->minw = c->info->minh = 0;
+    c->info->maxa = c->info->mina = 0.0;
 
     /* size is uninitialized, ensure that size.flags aren't used */
     size->flags += !size->flags * XCB_SIZE_HINT_P_SIZE;
 
     if(size->flags & XCB_SIZE_HINT_P_MIN_SIZE)
     {
-        c->minw = size->min_width;
-        c->minh = size->min_height;
+        c->info->minw = size->min_width;
+        c->info->minh = size->min_height;
     }
     else if(size->flags & XCB_SIZE_HINT_P_BASE_SIZE)
     {
-        c->minw = size->base_width;
-        c->minh = size->base_height;
+        c->info->minw = size->base_width;
+        c->info->minh = size->base_height;
     }
 
     if(size->flags & XCB_SIZE_HINT_P_BASE_SIZE)
     {
-        c->basew = size->base_width;
-        c->baseh = size->base_height;
+        c->info->basew = size->base_width;
+        c->info->baseh = size->base_height;
     }
     else if(size->flags & XCB_SIZE_HINT_P_MIN_SIZE)
     {
-        c->basew = c->minw;
-        c->baseh = c->minh;
+        c->info->basew = c->info->minw;
+        c->info->baseh = c->info->minh;
     }
 
     if(size->flags & XCB_SIZE_HINT_P_RESIZE_INC)
     {
-        c->incw = size->width_inc;
-        c->inch = size->height_inc;
+        c->info->incw = size->width_inc;
+        c->info->inch = size->height_inc;
     }
-    if(size->flags & XCB_SIZE_HINT_P_MIN_SIZE)
+    if(size->flags & XCB_SIZE_HINT_P_MAX_SIZE)
     {
-        c->maxw = size->max_width;
-        c->maxh = size->max_height;
+        c->info->maxw = size->max_width;
+        c->info->maxh = size->max_height;
     }
     if(size->flags & XCB_SIZE_HINT_P_ASPECT)
     {
-        c->mina = (float)size->min_aspect_den / size->min_aspect_num;
-        c->maxa = (float)size->max_aspect_num / size->max_aspect_den;
+        c->info->mina = (float)size->min_aspect_den / size->min_aspect_num;
+        c->info->maxa = (float)size->max_aspect_num / size->max_aspect_den;
     }
 
-    if((c->maxw && c->maxh && c->maxw == c->minw && c->maxh == c->minh))
+    if((c->info->maxw && c->info->maxh && c->info->maxw == c->info->minw && c->info->maxh == c->info->minh))
     {   setfixed(c, 1);
     }
 }
 
+void
+updatestale(Client *c)
+{
+    XCB_TRL_SCOPE();
+    const u8 stale = c->info->stale;
+    XCBCookie sizehcookie = { 0 };
+    XCBCookie wmhcookie = { 0 };
+    XCBCookie statecookie = { 0 };
+    XCBCookie protocookie = { 0 };
+    XCBCookie synccookie = { 0 };
+    u32 i, j;
+
+    c->info->stale = 0;
+    /* get cookies first, one round trip like manage() */
+    if(stale & StaleSizeHints)
+    {   sizehcookie = XCBGetWMNormalHintsCookie(_wm.dpy, c->win);
+    }
+    if(stale & StaleWMHints)
+    {   wmhcookie = XCBGetWMHintsCookie(_wm.dpy, c->win);
+    }
+    if(stale & StaleState)
+    {   statecookie = XCBGetWindowPropertyCookie(_wm.dpy, c->win, netatom[NetWMState], 0L, UINT32_MAX, False, XCB_ATOM_ATOM);
+    }
+    if(stale & StaleProtocols)
+    {
+        protocookie = XCBGetWindowPropertyCookie(_wm.dpy, c->win, wmatom[WMProtocols], 0L, UINT32_MAX, False, XCB_ATOM_ATOM);
+        synccookie = XCBGetWindowPropertyCookie(_wm.dpy, c->win, netatom[NetWMSyncRequestCounter], 0L, 1L, False, XCB_ATOM_CARDINAL);
+    }
+
+    if(stale & StaleSizeHints)
+    {
+        XCBSizeHints hints;
+        const u8 status = XCBGetWMNormalHintsReply(_wm.dpy, sizehcookie, &hints);
+        /* On Failure clear flag and ignore hints */
+        hints.flags *= !!status;
+        updatesizehints(c, &hints);
+    }
+    if(stale & StaleWMHints)
+    {
+        XCBWMHints *wmh = XCBGetWMHintsReply(_wm.dpy, wmhcookie);
+        updatewmhints(c, wmh);
+        free(wmh);
+    }
+    if(stale & StaleState)
+    {
+        XCBWindowProperty *state = XCBGetWindowPropertyReply(_wm.dpy, statecookie);
+        XCBAtom *atoms = state ? XCBGetPropertyValue(state) : NULL;
+        const u32 length = state ? XCBGetPropertyValueLength(state, sizeof(XCBAtom)) : 0;
+        const struct { XCBAtom atom; u8 set; } states[] =
+        {
+            { netatom[NetWMStateFullscreen], !!ISFULLSCREEN(c) },
+            { netatom[NetWMStateAbove], !!ISALWAYSONTOP(c) },
+            { netatom[NetWMStateDemandAttention], !!ISURGENT(c) },
+            { netatom[NetWMStateMaximizedVert], !!ISMAXIMIZEDVERT(c) },
+            { netatom[NetWMStateMaximizedHorz], !!ISMAXIMIZEDHORZ(c) },
+            { netatom[NetWMStateSticky], !!ISSTICKY(c) },
+            { netatom[NetWMStateModal], !!ISMODAL(c) },
+            { netatom[NetWMStateHidden], !!ISHIDDEN(c) },
+        };
+        /* unlike a _NET_WM_STATE message the property is the whole set, so what left it is off */
+        for(i = 0; i < LENGTH(states); ++i)
+        {
+            for(j = 0; j < length && atoms[j] != states[i].atom; ++j);
+            if(states[i].set && j == length)
+            {   updatewindowstate(c, states[i].atom, 0);
+            }
+        }
+        updatewindowstates(c, atoms, length);
+        free(state);
+    }
+    if(stale & StaleProtocols)
+    {
+        XCBWindowProperty *protocols = XCBGetWindowPropertyReply(_wm.dpy, protocookie);
+        XCBWindowProperty *counter = XCBGetWindowPropertyReply(_wm.dpy, synccookie);
+        updatesynccounter(c, protocols, counter);
+        free(protocols);
+        free(counter);
+    }
+    if(stale & StaleTitle)
+    {   updatetitle(c);
+    }
+}
+
+void
+updatesynccounter(Client *c, XCBWindowProperty *protocols, XCBWindowProperty *counter)
+{
+    u32 i;
+    u32 len;
+    XCBAtom *atoms;
+
+    c->info->counter = 0;
+    if(!protocols || !counter || !XCBGetPropertyValueLength(counter, sizeof(XCBSyncCounter)))
+    {   return;
+    }
+    atoms = XCBGetPropertyValue(protocols);
+    len = XCBGetPropertyValueLength(protocols, sizeof(XCBAtom));
+    for(i = 0; i < len; ++i)
+    {
+        if(atoms[i] == netatom[NetWMSyncRequest])
+        {   
+            c->info->counter = *(XCBSyncCounter *)XCBGetPropertyValue(counter);
+            break;
+        }
+    }
+}
+
+void
+updatetiled(Client *c)
+{
+    Desktop *desk = c->desktop;
+    Client **tiled;
+    Client *t;
+    u32 i, pos;
+    const u8 attached = c->next || c->info->prev || desk->clients == c;
+    const u8 tiledc = attached && !ISFLOATING(c) && !ISHIDDEN(c);
+
+    /* a flat scan, no pointer chasing */
+    for(i = 0; i < desk->ntiled && desk->tiled[i] != c; ++i);
+    if(tiledc == (i < desk->ntiled))
+    {   return;
+    }
+    if(!tiledc)
+    {
+        --desk->ntiled;
+        memmove(desk->tiled + i, desk->tiled + i + 1, (desk->ntiled - i) * sizeof(Client *));
+        return;
+    }
+    if(desk->ntiled == desk->tiledmax)
+    {
+        i = desk->tiledmax ? desk->tiledmax * 2 : 8;
+        tiled = realloc(desk->tiled, i * sizeof(Client *));
+        if(!tiled)
+        {   /* it just keeps its geometry */
+            DEBUG("%s", "WARN: FAILED TO GROW TILED CLIENTS");
+            return;
+        }
+        desk->tiled = tiled;
+        desk->tiledmax = i;
+    }
+    /* keep list order, attach() prepends so this usually stops right away */
+    for(pos = 0, t = desk->clients; t && t != c; t = t->next)
+    {   pos += !ISFLOATING(t) && !ISHIDDEN(t);
+    }
+    pos = MIN(pos, desk->ntiled);
+    memmove(desk->tiled + pos + 1, desk->tiled + pos, (desk->ntiled - pos) * sizeof(Client *));
+    desk->tiled[pos] = c;
+    ++desk->ntiled;
+}
+
 void
 updatetitle(Client *c)
 {
@@ -2415,9 +3547,25 @@ updatewindowstate(Client *c, XCBAtom state, uint8_t add_remove_toggle)
     }
     else if (state == netatom[NetWMStateMaximizedHorz])
     {
+        if(toggle)
+        {
+            setmaximizedhorz(c, !ISMAXIMIZEDHORZ(c));
+        }
+        else
+        {
+            setmaximizedhorz(c, add_remove_toggle);
+        }
     }
     else if (state == netatom[NetWMStateMaximizedVert])
     {
+        if(toggle)
+        {
+            setmaximizedvert(c, !ISMAXIMIZEDVERT(c));
+        }
+        else
+        {
+            setmaximizedvert(c, add_remove_toggle);
+        }
     }
     else if (state == netatom[NetWMStateSticky])
     {
@@ -2440,6 +3588,8 @@ updatewindowstate(Client *c, XCBAtom state, uint8_t add_remove_toggle)
         {
             /* attach last */
             XCBLowerWindow(_wm.dpy, c->win);
+            /* an InputOnly window above it would take its input */
+            XCBLowerWindow(_wm.dpy, c->mon->crosswin);
         }
     }
     else if (state == netatom[NetWMStateSkipTaskbar])
@@ -2605,6 +3755,7 @@ updatewindowtypes(Client *c, XCBAtom wtypes[], uint32_t atomslength)
 void
 updatewmhints(Client *c, XCBWMHints *wmh)
 {
+    XCB_TRL_SCOPE();
     if(wmh)
     {
         if(c == c->desktop->sel && wmh->flags & XCB_WM_HINT_URGENCY)
@@ -2624,9 +3775,112 @@ updatewmhints(Client *c, XCBWMHints *wmh)
     }
 }
 
+u32
+viewdesktops(Monitor *m, Desktop *desks[TAGSLENGTH])
+{
+    /* focus() keeps the focused client in desksel, its own desktop may be another one of the view */
+    Desktop *top = m->desksel->sel ? m->desksel->sel->desktop : m->desksel;
+    Desktop *d;
+    u32 n = 0;
+    /* every desktop whose clients may be shown, the focused client's first then desksel */
+    desks[n++] = top;
+    if(top != m->desksel)
+    {   desks[n++] = m->desksel;
+    }
+    for(d = m->desktops; d; d = nextdesktop(d))
+    {
+        if(d != top && d != m->desksel && (d->ntagged || m->tagset & TAGBIT(d)))
+        {   desks[n++] = d;
+        }
+    }
+    return n;
+}
+
+Client *
+viewsel(Monitor *m)
+{
+    Desktop *desks[TAGSLENGTH];
+    Client *c;
+    u32 n = viewdesktops(m, desks);
+    u32 i;
+    /* the first shown client of the view's stacks, desksel's first */
+    for(i = 0; i < n; ++i)
+    {
+        for(c = desks[i]->stack; c && !ISVISIBLE(c); c = c->snext);
+        if(c)
+        {   return c;
+        }
+    }
+    return NULL;
+}
+
+Client **
+viewtiled(Desktop *desk, u32 *count)
+{
+    Monitor *m = desk->mon;
+    Desktop *d;
+    Client **view;
+    Client *c;
+    u32 n = 0;
+    u32 max = 0;
+    u32 i;
+
+    /* usually only desk's own clients are shown, nothing to merge then */
+    for(d = m->desktops; d; d = nextdesktop(d))
+    {
+        if(d != desk && (d->ntagged || m->tagset & TAGBIT(d)))
+        {   max += d->ntiled;
+        }
+    }
+    if(!max)
+    {
+        *count = desk->ntiled;
+        return desk->tiled;
+    }
+    max += desk->ntiled;
+    if(max > m->viewmax)
+    {
+        i = MAX(max, m->viewmax * 2);
+        view = realloc(m->view, i * sizeof(Client *));
+        if(!view)
+        {   /* the others just keep their geometry */
+            DEBUG("%s", "WARN: FAILED TO GROW VIEW");
+            *count = desk->ntiled;
+            return desk->tiled;
+        }
+        m->view = view;
+        m->viewmax = i;
+    }
+    /* desktop order then list order, every tiled client of a shown desktop is shown */
+    for(d = m->desktops; d; d = nextdesktop(d))
+    {
+        if(!d->ntiled)
+        {   continue;
+        }
+        if(m->tagset & TAGBIT(d))
+        {
+            memcpy(m->view + n, d->tiled, d->ntiled * sizeof(Client *));
+            n += d->ntiled;
+        }
+        else if(d->ntagged)
+        {
+            for(i = 0; i < d->ntiled; ++i)
+            {
+                c = d->tiled[i];
+                if(c->tags & m->tagset)
+                {   m->view[n++] = c;
+                }
+            }
+        }
+    }
+    *count = n;
+    return m->view;
+}
+
 void
 winsetstate(XCBWindow win, i32 state)
 {
+    XCB_TRL_SCOPE();
     i32 data[] = { state, XCB_NONE };
     XCBChangeProperty(_wm.dpy, win, wmatom[WMState], wmatom[WMState], 32, XCB_PROP_MODE_REPLACE, (unsigned char *)data, 2);
 }
@@ -2662,11 +3916,54 @@ wintomon(XCBWindow win)
     Monitor *m;
     if(win == _wm.root && getrootptr(&x, &y)) return recttomon(x, y, 1, 1);
     for (m = _wm.mons; m; m = m->next)
-        if (win == m->barwin) return m;
+        if (win == m->barwin || win == m->crosswin) return m;
     if ((c = wintoclient(win))) return c->mon;
     return _wm.selmon;
 }
 
+Client *
+wintowithdrawn(XCBWindow win)
+{
+    Client *c;
+    for(c = _wm.withdrawn; c && c->win != win; c = c->info->wnext);
+    return c;
+}
+
+void
+withdraw(Client *c)
+{
+    XCB_TRL_SCOPE();
+    Desktop *desk = c->desktop;
+    /* Toolkits unmap and remap a window to rebuild it or change its state.
+     * Keeping the Client for a while turns that remap into remap() instead of manage() and its round trips.
+     */
+    if(_wm.lastfocused == c)
+    {   _wm.lastfocused = NULL;
+    }
+    if(_wm.drag.c == c)
+    {   
+        _wm.drag.dirty = 0;
+        dragstop();
+    }
+    idlecancel(&c->info->reconfigure);
+    c->info->confpending = 0;
+    detachcompletely(c);
+    c->info->wnext = _wm.withdrawn;
+    _wm.withdrawn = c;
+    timerset(&c->info->grace, _cfg.withdrawgrace, withdrawntimeout, c);
+    focus(NULL);
+    idleadd(&_wm.clientlist, updateclientlistidle, NULL);
+    arrange(desk);
+}
+
+void
+withdrawntimeout(Timer *timer)
+{
+    Client *c = timer->data;
+    detachwithdrawn(c);
+    cleanupclient(c);
+}
+
 void
 xerror(XCBDisplay *display, XCBGenericError *err)
 {
@@ -2680,6 +3977,10 @@ xerror(XCBDisplay *display, XCBGenericError *err)
            err->error_code, err->major_code, err->minor_code, 
            err->sequence, err->response_type, err->resource_id, 
            err->full_sequence);
+        XCBRequestOrigin origin;
+        if(XCBErrorOrigin(err, &origin))
+        {   DEBUG("Occured at: %s() window: [%u] scope: %s() caller: [%p]", origin.wrapper, origin.window, origin.scope ? origin.scope : "(none)", origin.caller);
+        }
     }
 }
 
@@ -6,6 +6,8 @@
 
 #include "xcb_trl.h"
 #include "xcb_winutil.h"
+#include "timer.h"
+#include "pool.h"
 
 
 #ifndef VERSION
@@ -17,6 +19,9 @@
 #endif
 
 #define BUTTONMASK              (XCB_EVENT_MASK_BUTTON_PRESS|XCB_EVENT_MASK_BUTTON_RELEASE)
+/* everything the WM selects on a client window, features that need more add it where they need it */
+#define CLIENTMASK              (XCB_EVENT_MASK_ENTER_WINDOW|XCB_EVENT_MASK_FOCUS_CHANGE \
+                                |XCB_EVENT_MASK_PROPERTY_CHANGE|XCB_EVENT_MASK_STRUCTURE_NOTIFY)
 #define CLEANMASK(mask)         (mask & ~(_wm.numlockmask|XCB_MOD_MASK_LOCK) & \
                                 (XCB_MOD_MASK_SHIFT|XCB_MOD_MASK_CONTROL| \
                                  XCB_MOD_MASK_1|XCB_MOD_MASK_2|XCB_MOD_MASK_3|XCB_MOD_MASK_4|XCB_MOD_MASK_5))
@@ -26,10 +31,21 @@
 #define WIDTH(C)                ((C)->w + ((C)->bw << 1))
 #define HEIGHT(C)               ((C)->h + ((C)->bw << 1))
 #define LENGTH(X)               (sizeof X / sizeof X[0])
-#define TAGMASK                 ((1 << LENGTH(tags)) - 1)
-#define TAGSLENGTH              (LENGTH(tags))
+/* bit n of a tag mask is desktops[n], so a Monitor has at most TAGSLENGTH Desktops */
+#define TAGSLENGTH              (sizeof(uint32_t) * 8)
+#define TAGMASK(M)              ((uint32_t)((1ULL << (M)->deskcount) - 1))
+#define TAGBIT(D)               ((uint32_t)1 << (D)->num)
 #define SESSION_FILE            "/tmp/dwm-session"
+#define STATS_FILE              "/tmp/dwm-stats"
 #define MAX_QUEUE_SIZE          1024
+/* validate a Desktop's lists after every change in debug and test (CHECK_LISTS) builds, see checkclients() */
+#if defined(ENABLE_DEBUG) || defined(CHECK_LISTS)
+#define CHECKCLIENTS(D)         checkclients(D)
+#define CHECKSTACK(D)           checkstack(D)
+#else
+#define CHECKCLIENTS(D)         ((void)0)
+#define CHECKSTACK(D)           ((void)0)
+#endif
 
 /* Client struct flags */
 #define _ALWAYSONTOP        ((1 << 0))
@@ -40,9 +56,10 @@
 #define _URGENT             ((1 << 5))
 #define _NEVERFOCUS         ((1 << 6))
 #define _HIDDEN             ((1 << 7))
-#define _STICKY             ((1 << 8))
 #define _DIALOG             ((1 << 9))
 #define _MODAL              ((1 << 10))
+#define _MAXIMIZEDVERT      ((1 << 11))
+#define _MAXIMIZEDHORZ      ((1 << 12))
 
 /* Client macros */
 
@@ -53,7 +70,7 @@
 /* This returns non zero on true, but not necessarly 1 */
 #define WASFLOATING(C)          (((C)->flags & _WASFLOATING))
 /* This returns non zero on true, but not necessarly 1 */
-#define ISFLOATING(C)           (((C)->flags & _WASFLOATING))
+#define ISFLOATING(C)           (((C)->flags & _FLOATING))
 /* This returns non zero on true, but not necessarly 1 */
 #define ISFIXED(C)              (((C)->flags & _FIXED))
 /* This returns non zero on true, but not necessarly 1 */
@@ -63,13 +80,17 @@
 /* This returns non zero on true, but not necessarly 1 */
 #define ISHIDDEN(C)             (((C)->flags & _HIDDEN))
 /* This returns non zero on true, but not necessarly 1 */
-#define ISSTICKY(C)             (((C)->flags & _STICKY))
+#define ISSTICKY(C)             (((C)->tags == TAGMASK((C)->mon)))
 /* This returns non zero on true, but not necessarly 1 */
 #define ISDIALOG(C)             (((C)->flags & _DIALOG))
 /* This returns non zero on true, but not necessarly 1 */
 #define ISMODAL(C)              (((C)->flags & _MODAL))
+/* This returns non zero on true, but not necessarly 1 */
+#define ISMAXIMIZEDVERT(C)      (((C)->flags & _MAXIMIZEDVERT))
+/* This returns non zero on true, but not necessarly 1 */
+#define ISMAXIMIZEDHORZ(C)      (((C)->flags & _MAXIMIZEDHORZ))
 /* This returns 1 when true */
-#define ISVISIBLE(C)            ((((C)->mon->desksel == (C)->desktop || ISSTICKY(c)) & (!ISHIDDEN(c))))
+#define ISVISIBLE(C)            ((!!((C)->tags & (C)->mon->tagset) & (!ISHIDDEN(C))))
 
 /* Monitor struct flags */
 #define _SHOWBAR            ((1 << 0))
@@ -86,6 +107,10 @@
 #define TOPBAR(M)               (((M)->flags & _TOPBAR))
 
 enum { CurNormal, CurResize, CurMove, CurLast }; /* cursor */
+enum { WakeXServer, WakeSignal, WakeTimer, WakeLast }; /* run() wakeup sources */
+enum { DragMove, DragResize }; /* interactive move/resize */
+enum { KeyRepeatOnce, KeyRepeatAlways, KeyRepeatRate }; /* Key.repeat, what a held key does */
+enum { StaleSizeHints = 1 << 0, StaleWMHints = 1 << 1, StaleState = 1 << 2, StaleProtocols = 1 << 3, StaleTitle = 1 << 4 }; /* ClientInfo.stale */
 enum { SchemeNorm, SchemeSel }; /* color schemes */
 enum { ClkTagBar, ClkLtSymbol, ClkStatusText, ClkWinTitle,
        ClkClientWin, ClkRootWin, ClkLast }; /* clicks */
@@ -95,9 +120,14 @@ typedef struct Key Key;
 typedef struct Button Button;
 typedef struct Monitor Monitor;
 typedef struct Client Client;
+typedef struct ClientInfo ClientInfo;
 typedef struct Stack Stack;
 typedef struct Layout Layout;
+typedef struct LayoutCache LayoutCache;
+typedef struct Rect Rect;
 typedef struct Desktop Desktop;
+typedef struct Drag Drag;
+typedef struct FocusFight FocusFight;
 typedef struct WM WM;
 typedef struct CFG CFG;
 
@@ -119,7 +149,9 @@ struct Key
     XCBKeysym keysym;           /* Key symbol           */
     void (*func)(const Arg *);  /* Function             */
     Arg arg;                    /* Argument             */
-    uint8_t pad0[8];
+    uint8_t repeat;             /* Autorepeat policy, KeyRepeatOnce by default  */
+    uint16_t rate;              /* KeyRepeatRate: min ms between repeats        */
+    uint8_t pad0[4];
 };
 
 struct Button
@@ -131,28 +163,51 @@ struct Button
     Arg arg;                        /* Argument                     */
 };
 
+/* Only what layouts, restack() and the list walks read, one cache line (the Client pool is line aligned).
+ * Everything else lives in info, keep this at 64 bytes.
+ */
 struct Client
 {
     int16_t x;          /* X coordinate             */
     int16_t y;          /* Y coordinate             */
     uint16_t w;         /* Width                    */
     uint16_t h;         /* height                   */
-    int16_t oldx;       /* Previous X coordinate    */
-    int16_t oldy;       /* Previous Y coordinate    */
-    uint16_t oldw;      /* Previous Width           */
-    uint16_t oldh;      /* Previous Height          */
-
     uint16_t flags;     /* Flags for client         */
+    uint16_t bw;        /* Border Width             */
     XCBWindow win;      /* Client Window            */
 
     Client *next;       /* The next client in list  */
     Client *snext;      /* The next client in stack */
-    Client *prev;       /* The previous client      */
-    Client *sprev;      /* The prev stack order clnt*/
     Monitor *mon;       /* Client Monitor           */
     Desktop *desktop;   /* Client Associated Desktop*/
+    ClientInfo *info;   /* The rest of the client   */
+    uint32_t tags;      /* Desktops it is shown on  */
+    uint8_t pad0[4];
+};
 
-    uint16_t bw;        /* Border Width             */
+#if UINTPTR_MAX == UINT64_MAX
+_Static_assert(sizeof(Client) == 64, "Client must stay one cache line, move fields to ClientInfo");
+#endif
+
+struct FocusFight
+{
+    XCBWindow win;              /* Window taking focus from sel, 0 if none      */
+    uint16_t streak;            /* Its steals less than _cfg.fightgap apart     */
+    uint16_t backoff;           /* ms the pending back off waits, doubles       */
+    uint64_t last;              /* ms of its last steal or our last retake      */
+    Timer timer;                /* Takes focus back after backoff               */
+};
+
+/* Rarely used part of a Client, from its own pool so Clients stay packed */
+struct ClientInfo
+{
+    Client *prev;       /* The previous client      */
+    Client *sprev;      /* The prev stack order clnt*/
+
+    int16_t oldx;       /* Previous X coordinate    */
+    int16_t oldy;       /* Previous Y coordinate    */
+    uint16_t oldw;      /* Previous Width           */
+    uint16_t oldh;      /* Previous Height          */
     uint16_t oldbw;     /* Old Border Width         */
 
     float mina;         /* Minimum Aspect           */
@@ -166,10 +221,29 @@ struct Client
     uint16_t minw;      /* Minimum Width            */
     uint16_t minh;      /* Minimum Height           */
 
+    XCBSyncCounter counter; /* Sync counter, 0 if none  */
+    int16_t savex;      /* X before maximizing horz */
+    int16_t savey;      /* Y before maximizing vert */
+    uint16_t savew;     /* W before maximizing horz */
+    uint16_t saveh;     /* H before maximizing vert */
     pid_t pid;          /* Client Pid               */
     char *name;         /* Client Name              */
 
-    uint8_t pad0[16];
+    uint32_t focusfights; /* Times it fought our focus, see focusfight() */
+    FocusFight fight;   /* Its current fight, see focusfight()   */
+    Idle reconfigure;   /* Applies its ConfigureRequest's, see configureidle() */
+    uint16_t confpending; /* value_mask's waiting for reconfigure        */
+    uint16_t confmask;  /* value_mask of the last ConfigureRequest       */
+    int16_t confx;      /* Its X                    */
+    int16_t confy;      /* Its Y                    */
+    uint16_t confw;     /* Its Width                */
+    uint16_t confh;     /* Its Height               */
+    uint16_t confbw;    /* Its Border Width         */
+    uint16_t confrepeat;/* Identical ones in a row  */
+    uint64_t conftime;  /* ms it arrived            */
+    Client *wnext;      /* Next withdrawn client, see withdraw() */
+    uint8_t stale;      /* Properties changed while withdrawn, Stale* */
+    Timer grace;        /* Frees it once withdrawn for too long  */
 };
 
 struct Monitor
@@ -184,10 +258,13 @@ struct Monitor
     uint16_t wh;                /* Monitor Height (Window Area)             */
 
     uint16_t flags;             /* Monitor flags                            */
-    uint16_t deskcount;         /* Desktop Counter                          */
+    uint16_t deskcount;         /* Desktops in desktops                     */
 
-    Desktop *desktops;          /* First Desktop in linked list             */
-    Desktop *desksel;           /* Selected Desktop                         */
+    Desktop *desktops;          /* Its Desktops, desktops[i].num == i       */
+    Desktop *desksel;           /* Selected Desktop, lays out the view      */
+    uint32_t tagset;            /* Shown Desktops, always has desksel       */
+    uint32_t viewmax;           /* Room in view                             */
+    Client **view;              /* Tiled clients of the view, see viewtiled() */
     Monitor *next;              /* Next Monitor                             */
 
     int16_t bx;                 /* Bar X                                    */
@@ -195,6 +272,7 @@ struct Monitor
     uint16_t bw;                /* Bar Width                                */
     uint16_t bh;                /* Bar Height                               */
     XCBWindow barwin;           /* The managed status bar                   */
+    XCBWindow crosswin;         /* InputOnly window under every client, see updatecrosswin() */
 };
 
 struct Layout
@@ -203,6 +281,23 @@ struct Layout
     void (*arrange)(Desktop *);
 };
 
+struct Rect
+{
+    int16_t x;
+    int16_t y;
+    uint16_t w;
+    uint16_t h;
+};
+
+/* What a layout gave the tiled clients of a view last time, see arrangedesktop() */
+struct LayoutCache
+{
+    uint64_t key;               /* layoutkey() it was laid out for  */
+    uint32_t n;                 /* Clients in geom                  */
+    uint32_t max;               /* Room in geom                     */
+    Rect *geom;                 /* Geometry of the nth tiled client */
+};
+
 struct Desktop
 {
     int16_t num;                /* The Desktop Number           */
@@ -214,8 +309,46 @@ struct Desktop
     Client *stack;              /* Client Stack Order           */
     Client *slast;              /* Last client in stack order   */
     Client *sel;                /* Selected Client              */
-    Desktop *next;              /* Next Client in linked list   */
-    Desktop *prev;              /* Previous Client in list      */
+    Client **tiled;             /* Tiled clients in list order, see updatetiled() */
+    uint32_t ntiled;            /* Clients in tiled             */
+    uint32_t tiledmax;          /* Room in tiled                */
+    uint32_t ntagged;           /* Clients also shown elsewhere */
+    LayoutCache *cache;         /* One per layout               */
+    Monitor *mon;               /* Monitor it belongs to        */
+};
+
+/* Interactive move/resize, driven by motionnotify() and buttonrelease() from run() */
+struct Drag
+{
+    Client *c;                  /* Client being moved or resized, NULL if none  */
+    uint8_t mode;               /* DragMove or DragResize                       */
+    uint8_t button;             /* Button whose release ends it                 */
+    int8_t horiz;               /* Resized edge -1 left, 1 right                */
+    int8_t vert;                /* Resized edge -1 top, 1 bottom                */
+    uint8_t dirty;              /* Motion not applied yet                       */
+    uint8_t floated;            /* Was tiled, dragstart() floated it            */
+    int16_t px;                 /* Pointer root X at start                      */
+    int16_t py;                 /* Pointer root Y at start                      */
+    int16_t rx;                 /* Latest pointer root X                        */
+    int16_t ry;                 /* Latest pointer root Y                        */
+    int16_t ox;                 /* Client X at start                            */
+    int16_t oy;                 /* Client Y at start                            */
+    uint16_t ow;                /* Client Width at start                        */
+    uint16_t oh;                /* Client Height at start                       */
+    uint64_t last;              /* timernow() of the last applied update        */
+    Timer frame;                /* Applies coalesced motion, see _cfg.rfrate    */
+    uint8_t sync;               /* Resize paced by the client, see dragsync()   */
+    uint8_t syncwait;           /* Waiting for the client to draw a resize      */
+    XCBSyncAlarm alarm;         /* Triggers when the client drew, 0 if no SYNC  */
+    uint64_t syncvalue;         /* Last _NET_WM_SYNC_REQUEST value sent         */
+    XCBCookie counter;          /* Client counter value, read by the first sync request, sequence 0 once read */
+    Timer synctimeout;          /* Gives up on the client, see _cfg.synctimeout */
+    uint8_t keyboard;           /* Driven by arrow keys, see dragkey()          */
+    uint16_t repeat;            /* Presses of key in a row, speeds up the step  */
+    XCBKeysym key;              /* Last arrow key                               */
+    XCBTimestamp keytime;       /* Time of the last arrow key                   */
+    XCBCookie grab;             /* Keyboard grab of a keyboard drag             */
+    Idle grabcheck;             /* Checks its reply, see dragkeygrab()          */
 };
 
 struct WM
@@ -234,6 +367,26 @@ struct WM
     Monitor *mons;                  /* Monitors             */
     Client *lastfocused;            /* Last focused client  */
     XCBKeySymbols *syms;            /* keysym alloc         */
+    int epfd;                       /* run() epoll fd       */
+    int sigfd;                      /* signalfd             */
+    uint64_t wakeups[WakeLast];     /* run() wakeups by fd  */
+    uint64_t idleflushes;           /* run() flushes        */
+    uint64_t idletasks;             /* run() idle tasks run */
+    Idle clientlist;                /* _NET_CLIENT_LIST rewrite after the batch */
+    Drag drag;                      /* Interactive move/resize */
+    uint8_t syncevent;              /* SYNC first event, 0 if unsupported */
+    uint8_t detectablerepeat;       /* XKB detectable autorepeat is on */
+    uint8_t keysheld[32];           /* Bit per keycode that is down */
+    XCBKeyCode lastrelease;         /* Keycode of the last KeyRelease */
+    XCBTimestamp lastreleasetime;   /* Its time, a repeat KeyPress has the same one */
+    FocusFight fight;               /* Unmanaged window fighting our focus */
+    uint64_t fights;                /* Streaks that reached _cfg.fightlimit */
+    uint64_t fightbackoffs;         /* Retakes delayed */
+    uint64_t fightdropped;          /* Steals ignored while backing off */
+    Client *withdrawn;              /* Unmapped clients kept for a remap, see withdraw() */
+    Pool clientpool;                /* Every Client */
+    Pool infopool;                  /* Every ClientInfo */
+    Pool monpool;                   /* Every Monitor */
 };
 
 /* 
@@ -248,6 +401,17 @@ struct CFG
 
     uint16_t snap;
     uint16_t rfrate;
+    uint16_t synctimeout;
+    uint16_t keystep;
+    uint16_t keygap;
+    uint16_t fightgap;
+    uint16_t fightlimit;
+    uint16_t fightbackoff;
+    uint16_t fightmax;
+    uint16_t confgap;
+    uint16_t conflimit;
+    uint16_t withdrawgrace;
+    uint16_t deskcount;
 
     uint16_t bh;
     uint16_t maxcc;
@@ -255,6 +419,7 @@ struct CFG
 
     uint8_t hoverfocus;
     uint8_t topbar;
+    uint8_t switchgrab;
 
 
 
@@ -271,35 +436,50 @@ void arrangemons(void);
 void arrangedesktop(Desktop *desk);
 void attachbar(Monitor *m, XCBWindow barwin);
 void detachbar(Monitor *m);
-void attachdesktop(Monitor *m, Desktop *desk);
-void detachdesktop(Monitor *m, Desktop *desk);
 void attach(Client *c);
 void attachstack(Client *c);
 void detach(Client *c);
 void detachcompletely(Client *c);
 void detachstack(Client *c);
+void detachwithdrawn(Client *c);
+void checkclients(Desktop *desk);
 uint8_t checknewbar(XCBWindow win);
 void checkotherwm(void);
+void checkstack(Desktop *desk);
 void cleanup(void);
 void cleanupclient(Client *c);
 void cleanupdesktop(Desktop *desk);
 void cleanupmon(Monitor *m);
 void cleanupmons(void);
 void configure(Client *c);
+void configureidle(Idle *task);
 Client *createclient(Monitor *m);
-Desktop *createdeskop(Monitor *m);
 Monitor *createmon(void);
 Stack *createstack(void);
 Monitor *dirtomon(uint8_t dir);
 uint8_t docked(Client *c);
+void dragapply(void);
+void dragcancel(void);
+void dragframe(Timer *timer);
+void dragkey(XCBKeysym sym, uint16_t state, XCBTimestamp tim);
+void dragkeygrab(Idle *task);
+void dragkeystart(Client *c, uint8_t mode);
+void dragmotion(int16_t rootx, int16_t rooty);
+void dragstart(Client *c, uint8_t mode, uint8_t button, int16_t rootx, int16_t rooty);
+void dragstop(void);
+void dragsync(void);
+void dragsynctimeout(Timer *timer);
 void eventhandler(XCBGenericEvent *ev);
 void exithandler(void);
 void floating(Desktop *desk);
 void focus(Client *c);
+void focusfight(XCBWindow win);
+void focusfighttimeout(Timer *timer);
 int32_t getstate(XCBWindow win);
 void grabbuttons(XCBWindow window, uint8_t focused);
 void grabkeys(void);
 void grid(Desktop *desk);
+uint64_t layoutkey(Desktop *desk, Client **tiled, uint32_t count);
 Client *manage(XCBWindow window);
 void monocle(Desktop *desk);
 Client *nextclient(Client *c);
@@ -308,9 +488,11 @@ Monitor *nextmonitor(Monitor *monitor);
 Client *nextstack(Client *c);
 Client *nexttiled(Client *c);
 Client *nextvisible(Client *c);
+Desktop *numtodesktop(Monitor *m, uint32_t num);
 Client *lastvisible(Client *c);
 void quit(void);
 Monitor *recttomon(int16_t x, int16_t y, uint16_t width, uint16_t height);
+void remap(Client *c);
 void resize(Client *c, int16_t x, int16_t y, uint16_t width, uint16_t height, uint8_t interact);
 void resizeclient(Client *c, int16_t x, int16_t y, uint16_t width, uint16_t height);
 void restack(Desktop *desk);
@@ -321,12 +503,16 @@ void setalwaysontop(Client *c, uint8_t isalwaysontop);
 void setborderwidth(Client *c, uint16_t border_width);
 void setclientdesktop(Client *c, Desktop *desktop);
 void setclientstate(Client *c, uint8_t state);
+void setclienttags(Client *c, uint32_t tags);
 void setdesktoplayout(Desktop *desk, uint8_t layout);
+void setdesktopsel(Monitor *m, Desktop *desk);
 void setdialog(Client *c, uint8_t state);
 void setfixed(Client *c, uint8_t state);
 void setfloating(Client *c, uint8_t isfloating);
 void setfullscreen(Client *c, uint8_t isfullscreen);
 void setfocus(Client *c);
+void setmaximizedhorz(Client *c, uint8_t state);
+void setmaximizedvert(Client *c, uint8_t state);
 void sethidden(Client *c, uint8_t state);
 void setmodal(Client *c, uint8_t state);
 void setneverfocus(Client *c, uint8_t state);
@@ -335,8 +521,11 @@ void setsticky(Client *c, uint8_t state);
 void settopbar(Monitor *m, uint8_t state);
 void setup(void);
 void seturgent(Client *c, uint8_t isurgent);
+void setview(Monitor *m, uint32_t tagset);
 void showhide(const Client *c);
+void showhideview(Monitor *m, uint32_t from, uint32_t tagset);
 void sigchld(int signo);
+void sigfdhandler(void);
 void sighandler(void);
 void sighup(int signo);
 void sigterm(int signo);
@@ -345,12 +534,19 @@ void startup(void);
 void tile(Desktop *desk);
 void unfocus(Client *c, uint8_t setfocus);
 void updatebarpos(Monitor *m);
+void updateclientdesktop(Client *c);
 void updateclientlist(void);
+void updateclientlistidle(Idle *task);
+void updatecrosswin(Monitor *m);
 int  updategeom(void);
 void updateicon(Client *c);
+void updatenetwmstate(Client *c);
 void updatenumlockmask(void);
 void updatesettings(void);
 void updatesizehints(Client *c, XCBSizeHints *size);
+void updatestale(Client *c);
+void updatesynccounter(Client *c, XCBWindowProperty *protocols, XCBWindowProperty *counter);
+void updatetiled(Client *c);
 void updatetitle(Client *c);
 void updateviewport(void);
 void updatewindowstate(Client *c, XCBAtom state, uint8_t add_remove_toggle);
@@ -358,9 +554,15 @@ void updatewindowstates(Client *c, XCBAtom state[], uint32_t atomslength);
 void updatewindowtype(Client *c, XCBAtom wtype, uint8_t add_remove_toggle);
 void updatewindowtypes(Client *c, XCBAtom wtype[], uint32_t atomslength);
 void updatewmhints(Client *c, XCBWMHints *hints);
+uint32_t viewdesktops(Monitor *m, Desktop *desks[TAGSLENGTH]);
+Client *viewsel(Monitor *m);
+Client **viewtiled(Desktop *desk, uint32_t *count);
 void winsetstate(XCBWindow win, int32_t state);
 Client *wintoclient(XCBWindow win);
 Monitor *wintomon(XCBWindow win);
+Client *wintowithdrawn(XCBWindow win);
+void withdraw(Client *c);
+void withdrawntimeout(Timer *timer);
 
 
 void unmanage(Client *c, uint8_t destroyed);
@@ -6,6 +6,7 @@
 #include "dwm.h"
 
 extern WM _wm;
+extern CFG _cfg;
 extern XCBAtom netatom[NetLast];
 extern XCBAtom wmatom[WMLast];
 
@@ -64,6 +65,7 @@ void (*handler[LASTEvent]) (XCBGenericEvent *) =
 void
 keypress(XCBGenericEvent *event)
 {
+    XCB_TRL_HOT_SCOPE();
     XCBKeyPressEvent *ev = (XCBKeyPressEvent *)event;
     const i16 rootx             = ev->root_x;
     const i16 rooty             = ev->root_y;
@@ -98,7 +100,21 @@ keypress(XCBGenericEvent *event)
      */
     DEBUG("%d", sym);
     int i;
-    u8 sync = 0;
+    /* last time each binding fired, for KeyRepeatRate */
+    static XCBTimestamp fired[LENGTH(keys)];
+    /* With detectable autorepeat a held key only sends KeyPress's, otherwise every repeat is a
+     * KeyRelease/KeyPress pair with the same timestamp.
+     */
+    const u8 repeat = (_wm.keysheld[keydetail >> 3] & (1 << (keydetail & 7)))
+                    || (keydetail == _wm.lastrelease && tim == _wm.lastreleasetime);
+    _wm.keysheld[keydetail >> 3] |= 1 << (keydetail & 7);
+    /* the keyboard is grabbed for a keyboard move/resize, see dragkeystart() */
+    if(_wm.drag.keyboard)
+    {   
+        dragkey(sym, state, tim);
+        return;
+    }
+    /* hot path, never wait on the XServer. run() flushes once the event queue is drained */
     for(i = 0; i < LENGTH(keys); ++i)
     {
         if(keys[i].type == XCB_KEY_PRESS)
@@ -107,20 +123,35 @@ keypress(XCBGenericEvent *event)
                     && CLEANMASK(keys[i].mod) == cleanstate
                     && keys[i].func) 
             {   
+                if(repeat)
+                {
+                    switch(keys[i].repeat)
+                    {
+                        case KeyRepeatAlways:
+                            break;
+                        case KeyRepeatRate:
+                            if((XCBTimestamp)(tim - fired[i]) >= keys[i].rate)
+                            {   break;
+                            }
+                            /* FALLTHROUGH */
+                        case KeyRepeatOnce:
+                        default:
+                            DEBUG("Dropped repeat of key: %d", sym);
+                            return;
+                    }
+                }
+                fired[i] = tim;
                 keys[i].func(&(keys[i].arg));
-                sync = 1;
                 break;
             }
         }
     }
-    if(sync)
-    {   XCBSync(_wm.dpy);
-    }
 }
 
 void
 keyrelease(XCBGenericEvent *event)
 {
+    XCB_TRL_SCOPE();
     XCBKeyReleaseEvent *ev = (XCBKeyReleaseEvent *)event;
     const i16 rootx             = ev->root_x;
     const i16 rooty             = ev->root_y;
@@ -156,6 +187,13 @@ keyrelease(XCBGenericEvent *event)
      */
     int i;
     u8 sync = 0;
+    _wm.keysheld[keydetail >> 3] &= ~(1 << (keydetail & 7));
+    _wm.lastrelease = keydetail;
+    _wm.lastreleasetime = tim;
+    /* releases of the keys that started or drive a keyboard move/resize */
+    if(_wm.drag.keyboard)
+    {   return;
+    }
     for(i = 0; i < LENGTH(keys); ++i)
     {
         if(keys[i].type == XCB_KEY_RELEASE)
@@ -178,6 +216,7 @@ keyrelease(XCBGenericEvent *event)
 void
 buttonpress(XCBGenericEvent *event)
 {
+    XCB_TRL_SCOPE();
     XCBButtonPressEvent *ev = (XCBButtonPressEvent *)event;
     const i16 rootx             = ev->root_x;
     const i16 rooty             = ev->root_y;
@@ -207,7 +246,7 @@ buttonpress(XCBGenericEvent *event)
     u8 sync = 0;
     Monitor *m;
     /* focus monitor if necessary */
-    if ((m = wintomon(eventwin)))
+    if ((m = eventwin == _wm.root ? recttomon(rootx, rooty, 1, 1) : wintomon(eventwin)))
     {
         if(m != _wm.selmon)
         {
@@ -259,6 +298,7 @@ buttonpress(XCBGenericEvent *event)
 void
 buttonrelease(XCBGenericEvent *event)
 {
+    XCB_TRL_SCOPE();
     XCBButtonReleaseEvent *ev = (XCBButtonReleaseEvent *)event;
     const i16 rootx             = ev->root_x;
     const i16 rooty             = ev->root_y;
@@ -287,6 +327,10 @@ buttonrelease(XCBGenericEvent *event)
 
     u8 sync = 0;
 
+    if(_wm.drag.c && _wm.drag.button == keydetail)
+    {   dragstop();
+    }
+
     i16 i;
     for(i = 0; i < LENGTH(buttons); ++i)
     {   
@@ -312,6 +356,7 @@ buttonrelease(XCBGenericEvent *event)
 void
 motionnotify(XCBGenericEvent *event)
 {
+    XCB_TRL_HOT_SCOPE();
     XCBMotionNotifyEvent *ev = (XCBMotionNotifyEvent *)event;
     const i16 rootx             = ev->root_x;
     const i16 rooty             = ev->root_y;
@@ -336,36 +381,20 @@ motionnotify(XCBGenericEvent *event)
     (void)tim;
 
 
-    /* due to the mouse being able to move a ton we want to limit the cycles burnt for non root events */
-    if(eventwin != _wm.root)
-    {   return;
-    }
-
-
-    u8 sync = 0;
-    static Monitor *mon = NULL;
-    Monitor *m;
-
-    if((m = recttomon(rootx, rooty, 1, 1)) != mon && mon)
-    {
-        Client *c = _wm.selmon->desksel->sel;
-        if(c)
-        {   unfocus(c, 1);
-        }
-        _wm.selmon = m;
-        focus(NULL);
-        sync = 1;
-    }
-    mon = m;
+    (void)eventwin;
 
-    if(sync)
-    {   XCBSync(_wm.dpy);
+    /* Only a drag grab selects pointer motion, monitor changes come from crossings (see updatecrosswin()).
+     * The grab sends every motion of a drag to the dragged client.
+     */
+    if(_wm.drag.c && !_wm.drag.keyboard)
+    {   dragmotion(rootx, rooty);
     }
 }
 
 void
 enternotify(XCBGenericEvent *event)
 {
+    XCB_TRL_HOT_SCOPE();
     XCBEnterNotifyEvent *ev = (XCBEnterNotifyEvent *)event;
     const uint8_t detail    = ev->detail;
     const XCBTimestamp tim  = ev->time;
@@ -395,42 +424,54 @@ enternotify(XCBGenericEvent *event)
     (void)mode;
     (void)samescreenfocus;
 
-    if(!CFG_HOVER_FOCUS) return;
-
-
-    /* hover focus */
-
-
     Client *c;
     Monitor *m;
-    u8 sync = 0;
+
+    /* the pointer moved onto the background of a monitor */
+    for(m = _wm.mons; m && m->crosswin != eventwin; m = m->next);
+    if(m)
+    {
+        if(m != _wm.selmon)
+        {
+            unfocus(_wm.selmon->desksel->sel, 1);
+            _wm.selmon = m;
+            /* hot path, never wait on the XServer. run() flushes once the event queue is drained */
+            focus(NULL);
+        }
+        return;
+    }
 
     if((mode != XCB_NOTIFY_MODE_NORMAL || detail == XCB_NOTIFY_DETAIL_INFERIOR) && eventwin != _wm.root)
     {   return;
     }
 
     c = wintoclient(eventwin);
-    m = c ? c->mon : wintomon(eventwin);
+    /* wintomon(root) would query the pointer */
+    m = c ? c->mon : eventwin == _wm.root ? recttomon(rootx, rooty, 1, 1) : wintomon(eventwin);
 
+    /* crosswin is below every client, so a pointer going from a client straight to a client on another monitor
+     * only shows up here. The monitor follows it with or without hover focus.
+     */
     if(m != _wm.selmon)
     {
         unfocus(_wm.selmon->desksel->sel, 1);
         _wm.selmon = m;
-        sync = 1;
+        /* hot path, never wait on the XServer. run() flushes once the event queue is drained */
+        focus(CFG_HOVER_FOCUS ? c : NULL);
+        return;
     }
-    else if(!c || c == _wm.selmon->desksel->sel)
+
+    /* hover focus */
+    if(!CFG_HOVER_FOCUS || !c || c == _wm.selmon->desksel->sel)
     {   return;
     }
     focus(c);
-    sync = 1;
-    if(sync)
-    {   XCBSync(_wm.dpy);
-    }
 }
 
 void
 leavenotify(XCBGenericEvent *event)
 {
+    XCB_TRL_SCOPE();
     XCBLeaveNotifyEvent *ev = (XCBLeaveNotifyEvent *)event;
     const uint8_t detail    = ev->detail;
     const XCBTimestamp tim  = ev->time;
@@ -464,6 +505,7 @@ leavenotify(XCBGenericEvent *event)
 void
 focusin(XCBGenericEvent *event)
 {
+    XCB_TRL_HOT_SCOPE();
     XCBFocusInEvent *ev = (XCBFocusInEvent *)event;
     const u8 detail = ev->detail;
     const XCBWindow eventwin = ev->event;
@@ -472,22 +514,16 @@ focusin(XCBGenericEvent *event)
     (void)detail;
     (void)mode;
 
-    u8 sync = 0;
-
+    /* hot path, never wait on the XServer. run() flushes once the event queue is drained */
     if(_wm.selmon->desksel->sel && eventwin != _wm.selmon->desksel->sel->win)
-    {   
-        setfocus(_wm.selmon->desksel->sel);
-        sync = 1;
-    }
-
-    if(sync)
-    {   XCBSync(_wm.dpy);
+    {   focusfight(eventwin);
     }
 }
 
 void
 focusout(XCBGenericEvent *event)
 {
+    XCB_TRL_SCOPE();
     XCBFocusOutEvent *ev = (XCBFocusOutEvent *)event;
     const u8 detail = ev->detail;
     const XCBWindow eventwin = ev->event;
@@ -590,6 +626,7 @@ circulaterequest(XCBGenericEvent *event)
 void
 configurerequest(XCBGenericEvent *event)
 {   
+    XCB_TRL_HOT_SCOPE();
     XCBConfigureRequestEvent *ev = (XCBConfigureRequestEvent *)event;
     const i16 x     = ev->x;
     const i16 y     = ev->y;
@@ -607,9 +644,39 @@ configurerequest(XCBGenericEvent *event)
 
     Client *c;
     Monitor *m;
-    u8 sync = 0;
     if((c = wintoclient(win)))
     {
+        const u64 now = timernow() / 1000000;
+        /* asking again for the same thing right after the answer, the client is fighting us */
+        if(mask == c->info->confmask && x == c->info->confx && y == c->info->confy && w == c->info->confw && h == c->info->confh 
+                && bw == c->info->confbw && now - c->info->conftime < _cfg.confgap)
+        {   
+            c->info->conftime = now;
+            if(++c->info->confrepeat >= _cfg.conflimit)
+            {   
+                DEBUG("Dropped looping ConfigureRequest of window: %u", win);
+                return;
+            }
+        }
+        else
+        {
+            c->info->confmask = mask;
+            c->info->confx = x;
+            c->info->confy = y;
+            c->info->confw = w;
+            c->info->confh = h;
+            c->info->confbw = bw;
+            c->info->confrepeat = 0;
+            c->info->conftime = now;
+        }
+        /* The layout (or a drag) owns the geometry, moving the window would only make arrange() move it back.
+         * A synthetic ConfigureNotify tells the client what it has without a request to the XServer.
+         */
+        if(!ISFLOATING(c) || ISFULLSCREEN(c) || _wm.drag.c == c)
+        {   
+            configure(c);
+            return;
+        }
         m = c->mon;
         if(mask & XCB_CONFIG_WINDOW_BORDER_WIDTH)
         {                           /* Border width should NEVER be bigger than the screen */
@@ -617,22 +684,22 @@ configurerequest(XCBGenericEvent *event)
         }
         if(mask & XCB_CONFIG_WINDOW_X)
         {
-            c->oldx = c->x;
+            c->info->oldx = c->x;
             c->x = m->mx + x;
         }
         if(mask & XCB_CONFIG_WINDOW_Y)
         {
-            c->oldy = c->y;
+            c->info->oldy = c->y;
             c->y = m->my + y;
         }
         if(mask & XCB_CONFIG_WINDOW_WIDTH)
         {
-            c->oldw = c->w;
+            c->info->oldw = c->w;
             c->w = w;
         }
         if(mask & XCB_CONFIG_WINDOW_HEIGHT)
         {
-            c->oldh = c->h;
+            c->info->oldh = c->h;
             c->h = h;
         }
         if(mask & XCB_CONFIG_WINDOW_SIBLING)
@@ -657,21 +724,17 @@ configurerequest(XCBGenericEvent *event)
         }
         if((c->x + c->w) > m->mx + m->mw && ISFLOATING(c))
         {   
-            c->oldx = c->x;
+            c->info->oldx = c->x;
             c->x = m->mx + ((m->mw >> 1) - (WIDTH(c) >> 1)); /* center in x direction */
         }
         if((c->y + c->h) > m->my + m->mh && ISFLOATING(c))
         {   
-            c->oldy = c->y;
+            c->info->oldy = c->y;
             c->y = m->my + ((m->mh >> 1) - (HEIGHT(c) >> 1)); /* center in y direction */
         }
-        if(mask & (XCB_CONFIG_WINDOW_X|XCB_CONFIG_WINDOW_Y) && !(mask & (XCB_CONFIG_WINDOW_WIDTH|XCB_CONFIG_WINDOW_HEIGHT)))
-        {    configure(c);
-        }
-        if(ISVISIBLE(c))
-        {   XCBMoveResizeWindow(_wm.dpy, c->win, c->x, c->y, c->w, c->h);
-        }
-        sync = 1;
+        /* every request of the batch goes out as one configure */
+        c->info->confpending |= mask;
+        idleadd(&c->info->reconfigure, configureidle, c);
     }
     else
     {
@@ -685,27 +748,30 @@ configurerequest(XCBGenericEvent *event)
         wc.stack_mode = stack;
         /* some windows need to be mapped before configuring */
         XCBConfigureWindow(_wm.dpy, win, mask, &wc);
-        sync = 1;
-    }
-    if(sync)
-    {   XCBSync(_wm.dpy);
     }
 }
 
 void
 maprequest(XCBGenericEvent *event)
 {
+    XCB_TRL_SCOPE();
     XCBMapRequestEvent *ev  = (XCBMapRequestEvent *)event;
     const XCBWindow parent  = ev->parent;
     const XCBWindow win     = ev->window;
 
     (void)parent;
 
+    Client *c;
     u8 sync = 0;
 
     if(!wintoclient(win))
     {   
-        manage(win);
+        if((c = wintowithdrawn(win)))
+        {   remap(c);
+        }
+        else
+        {   manage(win);
+        }
         sync = 1;
     }
 
@@ -717,6 +783,7 @@ maprequest(XCBGenericEvent *event)
 void
 resizerequest(XCBGenericEvent *event)
 {
+    XCB_TRL_SCOPE();
     XCBResizeRequestEvent *ev = (XCBResizeRequestEvent *)event;
     const XCBWindow win = ev->window;
     const u16 w         = ev->width;
@@ -763,6 +830,7 @@ circulatenotify(XCBGenericEvent *event)
 void
 configurenotify(XCBGenericEvent *event)
 {
+    XCB_TRL_SCOPE();
     XCBConfigureNotifyEvent *ev = (XCBConfigureNotifyEvent *)event;
     const XCBWindow eventwin = ev->event;
     const XCBWindow win = ev->window;
@@ -859,6 +927,7 @@ createnotify(XCBGenericEvent *event)
 void
 destroynotify(XCBGenericEvent *event)
 {
+    XCB_TRL_SCOPE();
     XCBDestroyNotifyEvent *ev = (XCBDestroyNotifyEvent *)event;
     const XCBWindow win         = ev->window;
     const XCBWindow eventwin    = ev->event;        /* The Event win is the window that sent the message */
@@ -873,6 +942,11 @@ destroynotify(XCBGenericEvent *event)
         unmanage(c, 1);
         sync = 1;
     }
+    else if((c = wintowithdrawn(win)))
+    {   
+        detachwithdrawn(c);
+        cleanupclient(c);
+    }
     if(sync)
     {   XCBSync(_wm.dpy);
     }
@@ -909,6 +983,7 @@ mapnotify(XCBGenericEvent *event)
 void
 mappingnotify(XCBGenericEvent *event)
 {
+    XCB_TRL_SCOPE();
     XCBMappingNotifyEvent *ev = (XCBMappingNotifyEvent *)event;
     const XCBKeyCode first_keycode = ev->first_keycode;
     const uint8_t count            = ev->count;
@@ -927,6 +1002,7 @@ mappingnotify(XCBGenericEvent *event)
 void
 unmapnotify(XCBGenericEvent *event)
 {
+    XCB_TRL_SCOPE();
     XCBUnMapNotifyEvent *ev = (XCBUnMapNotifyEvent *)event;
     const XCBWindow eventwin    = ev->event;
     const XCBWindow win         = ev->window;
@@ -939,7 +1015,12 @@ unmapnotify(XCBGenericEvent *event)
     u8 sync = 0;
     if((c = wintoclient(win)))
     {   
-        unmanage(c, 0);
+        if(_cfg.withdrawgrace)
+        {   withdraw(c);
+        }
+        else
+        {   unmanage(c, 0);
+        }
         sync = 1;
     }
 
@@ -997,6 +1078,7 @@ colormapnotify(XCBGenericEvent *event)
 void
 clientmessage(XCBGenericEvent *event)
 {
+    XCB_TRL_SCOPE();
     XCBClientMessageEvent *ev = (XCBClientMessageEvent *)event;
     const XCBWindow win             = ev->window;
     const XCBAtom atom              = ev->type;
@@ -1046,6 +1128,19 @@ clientmessage(XCBGenericEvent *event)
      *      data.l[0]       _NET_WM_SYNC_REQUEST
      */
 
+    /* pagers */
+    if(win == _wm.root)
+    {
+        if(atom == netatom[NetCurrentDesktop])
+        {
+            Desktop *desk = numtodesktop(_wm.selmon, data.data32[0]);
+            if(desk)
+            {   setdesktopsel(_wm.selmon, desk);
+            }
+        }
+        return;
+    }
+
     Client *c = wintoclient(win);
     if(c)
     {
@@ -1063,8 +1158,13 @@ clientmessage(XCBGenericEvent *event)
                                      */
             const XCBAtom prop1 = l1;
             const XCBAtom prop2 = l2;
+            const u16 floating = ISFLOATING(c);
             updatewindowstate(c, prop1, action);
             updatewindowstate(c, prop2, action);
+            /* maximizing floats the client */
+            if(ISFLOATING(c) != floating)
+            {   arrange(c->desktop);
+            }
         }
         else if(atom == netatom[NetActiveWindow])
         {
@@ -1130,10 +1230,15 @@ clientmessage(XCBGenericEvent *event)
                 case _NET_WM_MOVERESIZE_MOVE:
                     break;
                 case _NET_WM_MOVERESIZE_SIZE_KEYBOARD: 
+                    dragkeystart(c, DragResize);
                     break;
                 case _NET_WM_MOVERESIZE_MOVE_KEYBOARD: 
+                    dragkeystart(c, DragMove);
                     break;
                 case _NET_WM_MOVERESIZE_CANCEL: 
+                    if(_wm.drag.c == c)
+                    {   dragcancel();
+                    }
                     break;
             }
         }
@@ -1146,23 +1251,6 @@ clientmessage(XCBGenericEvent *event)
         else if (atom == netatom[NetDesktopViewport])
         {   /* TODO */
         }
-        else if (atom == netatom[NetCurrentDesktop])
-        {   
-            u32 target = l0;
-            Monitor *m = c->mon;
-            detachcompletely(c);
-            if(m)
-            {
-                Desktop *desk;
-                u32 i = 0;
-                for(desk = m->desktops; desk && i != target; desk = nextdesktop(desk), ++i);
-                if(desk)
-                {  
-                    attachstack(c);
-                    attach(c);
-                }
-            }
-        }
         else if (atom == netatom[NetShowingDesktop])
         {   /* TODO */
         }
@@ -1176,6 +1264,20 @@ clientmessage(XCBGenericEvent *event)
                 setsticky(c, 1);
                 return;
             }
+            Desktop *desk = numtodesktop(c->mon, l0);
+            Desktop *old = c->desktop;
+            if(desk && desk != old)
+            {
+                if(ISSTICKY(c))
+                {   setsticky(c, 0);
+                }
+                detachstack(c);
+                setclientdesktop(c, desk);
+                attachstack(c);
+                arrange(old);
+                arrange(desk);
+                focus(NULL);
+            }
         }
         else if (atom == netatom[WMProtocols])
         {   /* Protocol handler */
@@ -1189,6 +1291,7 @@ clientmessage(XCBGenericEvent *event)
 void
 propertynotify(XCBGenericEvent *event)
 {
+    XCB_TRL_SCOPE();
     XCBPropertyNotifyEvent *ev = (XCBPropertyNotifyEvent *)event;
     const XCBAtom atom          = ev->atom;
     const XCBWindow win         = ev->window;
@@ -1204,6 +1307,31 @@ propertynotify(XCBGenericEvent *event)
     if((win == _wm.root) && atom == XCB_ATOM_WM_NAME)
     {   /* updatestatus */
     }
+    /* Toolkits rewrite these while unmapped (a fullscreen toggle), remap() fetches them again */
+    if((c = wintowithdrawn(win)))
+    {   
+        if(atom == XCB_ATOM_WM_TRANSIENT_FOR || atom == netatom[NetWMWindowType])
+        {   /* where it goes and how it floats, let the next map manage() it from scratch */
+            detachwithdrawn(c);
+            cleanupclient(c);
+        }
+        else if(atom == XCB_ATOM_WM_NORMAL_HINTS)
+        {   c->info->stale |= StaleSizeHints;
+        }
+        else if(atom == XCB_ATOM_WM_HINTS)
+        {   c->info->stale |= StaleWMHints;
+        }
+        else if(atom == netatom[NetWMState])
+        {   c->info->stale |= StaleState;
+        }
+        else if(atom == wmatom[WMProtocols] || atom == netatom[NetWMSyncRequestCounter])
+        {   c->info->stale |= StaleProtocols;
+        }
+        else if(atom == XCB_ATOM_WM_NAME || atom == netatom[NetWMName])
+        {   c->info->stale |= StaleTitle;
+        }
+        return;
+    }
 
     if(state == XCB_PROPERTY_DELETE)
     {   return;
@@ -1218,15 +1346,41 @@ propertynotify(XCBGenericEvent *event)
             case XCB_ATOM_WM_TRANSIENT_FOR:
                 break;
             case XCB_ATOM_WM_NORMAL_HINTS:
+                {
+                    XCBSizeHints hints;
+                    cookie = XCBGetWMNormalHintsCookie(_wm.dpy, c->win);
+                    const u8 status = XCBGetWMNormalHintsReply(_wm.dpy, cookie, &hints);
+                    /* On Failure clear flag and ignore hints */
+                    hints.flags *= !!status;
+                    /* cached for applysizehints() */
+                    updatesizehints(c, &hints);
+                }
                 break;
             case XCB_ATOM_WM_HINTS:
                 cookie = XCBGetWMHintsCookie(_wm.dpy, c->win);
                 wmh = XCBGetWMHintsReply(_wm.dpy, cookie);
                 updatewmhints(c, wmh);
+                free(wmh);
                 sync = 1;
                 break;
             default:
-                  break;
+                if(atom == wmatom[WMProtocols] || atom == netatom[NetWMSyncRequestCounter])
+                {
+                    XCBCookie synccookie;
+                    XCBWindowProperty *protocols;
+                    XCBWindowProperty *counter;
+                    cookie = XCBGetWindowPropertyCookie(_wm.dpy, c->win, wmatom[WMProtocols], 0L, UINT32_MAX, False, XCB_ATOM_ATOM);
+                    synccookie = XCBGetWindowPropertyCookie(_wm.dpy, c->win, netatom[NetWMSyncRequestCounter], 0L, 1L, False, XCB_ATOM_CARDINAL);
+                    protocols = XCBGetWindowPropertyReply(_wm.dpy, cookie);
+                    counter = XCBGetWindowPropertyReply(_wm.dpy, synccookie);
+                    updatesynccounter(c, protocols, counter);
+                    free(protocols);
+                    free(counter);
+                }
+                else if(atom == XCB_ATOM_WM_NAME || atom == netatom[NetWMName])
+                {   updatetitle(c);
+                }
+                break;
         }
     }
     if(sync)
@@ -1290,7 +1444,151 @@ genericevent(XCBGenericEvent *event)
 {
 }
 
+void
+alarmnotify(XCBGenericEvent *event)
+{
+    XCB_TRL_HOT_SCOPE();
+    XCBSyncAlarmNotifyEvent *ev = (XCBSyncAlarmNotifyEvent *)event;
+    const XCBSyncAlarm alarm = ev->alarm;
+
+    /* the only alarm we create, the dragged client drew the last resize */
+    if(alarm == _wm.drag.alarm)
+    {   dragsync();
+    }
+}
+
 void
 errorhandler(XCBGenericEvent *event)
 {   xerror(_wm.dpy, (XCBGenericError *)event);
 }
+
+#ifdef ENABLE_DEBUG
+/* windows past it are counted under window 0 */
+#define EVENT_STATS_SIZE    256
+
+typedef struct EventStats EventStats;
+struct EventStats
+{
+    XCBWindow win;
+    uint32_t count[LASTEvent];
+};
+
+static EventStats _eventstats[EVENT_STATS_SIZE];
+/* window 0, for events without one and windows that did not fit */
+static EventStats _eventstatsother;
+
+static const char *const _eventnames[LASTEvent] =
+{
+    [XCB_KEY_PRESS] = "KeyPress", [XCB_KEY_RELEASE] = "KeyRelease",
+    [XCB_BUTTON_PRESS] = "ButtonPress", [XCB_BUTTON_RELEASE] = "ButtonRelease",
+    [XCB_MOTION_NOTIFY] = "MotionNotify", [XCB_ENTER_NOTIFY] = "EnterNotify", [XCB_LEAVE_NOTIFY] = "LeaveNotify",
+    [XCB_FOCUS_IN] = "FocusIn", [XCB_FOCUS_OUT] = "FocusOut", [XCB_KEYMAP_NOTIFY] = "KeymapNotify",
+    [XCB_EXPOSE] = "Expose", [XCB_GRAPHICS_EXPOSURE] = "GraphicsExpose", [XCB_NO_EXPOSURE] = "NoExpose",
+    [XCB_VISIBILITY_NOTIFY] = "VisibilityNotify", [XCB_CREATE_NOTIFY] = "CreateNotify",
+    [XCB_DESTROY_NOTIFY] = "DestroyNotify", [XCB_UNMAP_NOTIFY] = "UnmapNotify", [XCB_MAP_NOTIFY] = "MapNotify",
+    [XCB_MAP_REQUEST] = "MapRequest", [XCB_REPARENT_NOTIFY] = "ReparentNotify",
+    [XCB_CONFIGURE_NOTIFY] = "ConfigureNotify", [XCB_CONFIGURE_REQUEST] = "ConfigureRequest",
+    [XCB_GRAVITY_NOTIFY] = "GravityNotify", [XCB_RESIZE_REQUEST] = "ResizeRequest",
+    [XCB_CIRCULATE_NOTIFY] = "CirculateNotify", [XCB_CIRCULATE_REQUEST] = "CirculateRequest",
+    [XCB_PROPERTY_NOTIFY] = "PropertyNotify", [XCB_SELECTION_CLEAR] = "SelectionClear",
+    [XCB_SELECTION_REQUEST] = "SelectionRequest", [XCB_SELECTION_NOTIFY] = "SelectionNotify",
+    [XCB_COLORMAP_NOTIFY] = "ColormapNotify", [XCB_CLIENT_MESSAGE] = "ClientMessage",
+    [XCB_MAPPING_NOTIFY] = "MappingNotify", [XCB_GE_GENERIC] = "GenericEvent",
+};
+
+/* the window whose event mask selected the event, 0 if none */
+static XCBWindow
+eventwindow(XCBGenericEvent *event, int type)
+{
+    switch(type)
+    {
+        /* every device event has the same layout */
+        case XCB_KEY_PRESS: case XCB_KEY_RELEASE: case XCB_BUTTON_PRESS:
+        case XCB_BUTTON_RELEASE: case XCB_MOTION_NOTIFY: 
+            return ((XCBKeyPressEvent *)event)->event;
+        case XCB_ENTER_NOTIFY: case XCB_LEAVE_NOTIFY:
+            return ((XCBEnterNotifyEvent *)event)->event;
+        case XCB_FOCUS_IN: case XCB_FOCUS_OUT:
+            return ((XCBFocusInEvent *)event)->event;
+        case XCB_EXPOSE:            return ((XCBExposeEvent *)event)->window;
+        case XCB_GRAPHICS_EXPOSURE: return ((XCBGraphicsExposeEvent *)event)->drawable;
+        case XCB_NO_EXPOSURE:       return ((XCBNoExposure *)event)->drawable;
+        case XCB_VISIBILITY_NOTIFY: return ((XCBVisibilityNotifyEvent *)event)->window;
+        case XCB_CREATE_NOTIFY:     return ((XCBCreateNotifyEvent *)event)->parent;
+        case XCB_DESTROY_NOTIFY:    return ((XCBDestroyNotifyEvent *)event)->event;
+        case XCB_UNMAP_NOTIFY:      return ((XCBUnMapNotifyEvent *)event)->event;
+        case XCB_MAP_NOTIFY:        return ((XCBMapNotifyEvent *)event)->event;
+        case XCB_MAP_REQUEST:       return ((XCBMapRequestEvent *)event)->parent;
+        case XCB_REPARENT_NOTIFY:   return ((XCBReparentNotifyEvent *)event)->event;
+        case XCB_CONFIGURE_NOTIFY:  return ((XCBConfigureNotifyEvent *)event)->event;
+        case XCB_CONFIGURE_REQUEST: return ((XCBConfigureRequestEvent *)event)->parent;
+        case XCB_GRAVITY_NOTIFY:    return ((XCBGravityNotifyEvent *)event)->event;
+        case XCB_RESIZE_REQUEST:    return ((XCBResizeRequestEvent *)event)->window;
+        case XCB_CIRCULATE_NOTIFY:  return ((XCBCirculateNotifyEvent *)event)->event;
+        case XCB_CIRCULATE_REQUEST: return ((XCBCirculateRequestEvent *)event)->event;
+        case XCB_PROPERTY_NOTIFY:   return ((XCBPropertyNotifyEvent *)event)->window;
+        case XCB_SELECTION_CLEAR:   return ((XCBSelectionClearEvent *)event)->owner;
+        case XCB_SELECTION_REQUEST: return ((XCBSelectionRequestEvent *)event)->owner;
+        case XCB_SELECTION_NOTIFY:  return ((XCBSelectionNotifyEvent *)event)->requestor;
+        case XCB_COLORMAP_NOTIFY:   return ((XCBColormapNotifyEvent *)event)->window;
+        case XCB_CLIENT_MESSAGE:    return ((XCBClientMessageEvent *)event)->window;
+        default:                    return 0;
+    }
+}
+#endif
+
+void
+eventstatsadd(XCBGenericEvent *event)
+{
+#ifdef ENABLE_DEBUG
+    const int type = XCB_EVENT_RESPONSE_TYPE(event);
+    if(type >= LASTEvent)
+    {   return;
+    }
+    const XCBWindow win = eventwindow(event, type);
+    EventStats *stats = &_eventstatsother;
+    /* XIDs differ in the high (client) bits just as much as the low ones */
+    u32 i = ((u32)win * 2654435761u) % EVENT_STATS_SIZE;
+    u32 probe;
+    if(win)
+    {
+        for(probe = 0; probe < EVENT_STATS_SIZE; ++probe, i = (i + 1) % EVENT_STATS_SIZE)
+        {
+            if(_eventstats[i].win == win || !_eventstats[i].win)
+            {
+                _eventstats[i].win = win;
+                stats = _eventstats + i;
+                break;
+            }
+        }
+    }
+    ++stats->count[type];
+#else
+    (void)event;
+#endif
+}
+
+int
+eventstatsdump(FILE *file)
+{
+    int ret = 0;
+    ret |= fprintf(file, "window\tevent\tcount\n") < 0;
+#ifdef ENABLE_DEBUG
+    const EventStats *stats;
+    u32 i;
+    int type;
+    for(i = 0; i < EVENT_STATS_SIZE + 1; ++i)
+    {
+        stats = i < EVENT_STATS_SIZE ? _eventstats + i : &_eventstatsother;
+        for(type = 0; type < LASTEvent; ++type)
+        {
+            if(stats->count[type])
+            {
+                ret |= fprintf(file, "0x%x\t%s\t%u\n", stats->win, 
+                        _eventnames[type] ? _eventnames[type] : "Unknown", stats->count[type]) < 0;
+            }
+        }
+    }
+#endif
+    return !ret;
+}
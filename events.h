@@ -37,9 +37,19 @@ void selectionclear(XCBGenericEvent *event);
 void selectionnotify(XCBGenericEvent *event);
 void selectionrequest(XCBGenericEvent *event);
 void genericevent(XCBGenericEvent *event);
+/* SYNC extension, not in handler[], see eventhandler() */
+void alarmnotify(XCBGenericEvent *event);
 
 void errorhandler(XCBGenericEvent *error);
 
+/* Counts event per type and the window that selected it, only in debug builds (ENABLE_DEBUG). */
+void eventstatsadd(XCBGenericEvent *event);
+/* Writes the counts of eventstatsadd() to file as tab separated values with a header line.
+ * RETURN: 1 on Success.
+ * RETURN: 0 on Failure.
+ */
+int eventstatsdump(FILE *file);
+
 #ifndef LASTEvent
 #define LASTEvent   40      /* XCB has a max event count of roughly ~35 however that is a estimate which is why 50 is used (just in case) .
                              * The reason it isnt 33 like in xlib is cause xcb skips ~2 before assigning event opcodes.
@@ -14,11 +14,18 @@
 #define SHIFT       XCB_MOD_MASK_SHIFT
 #define CAPSLOCK    XCB_MOD_MASK_LOCK
 #define TAB         XK_Tab
-#define LMB         XCB_BUTTON_MASK_1
-#define MMB         XCB_BUTTON_MASK_2
-#define RMB         XCB_BUTTON_MASK_3
-#define BUTTON4     XCB_BUTTON_MASK_4
-#define BUTTON5     XCB_BUTTON_MASK_5
+#define LMB         XCB_BUTTON_INDEX_1
+#define MMB         XCB_BUTTON_INDEX_2
+#define RMB         XCB_BUTTON_INDEX_3
+#define BUTTON4     XCB_BUTTON_INDEX_4
+#define BUTTON5     XCB_BUTTON_INDEX_5
+
+/* SUPER + n views desktop n, with SHIFT the window goes there, CTRL toggles either instead */
+#define TAGKEYS(KEY,TAG) \
+    { XCB_KEY_PRESS,            SUPER,                  KEY,        View,               { .ui = 1 << TAG } }, \
+    { XCB_KEY_PRESS,            CTRL|SUPER,             KEY,        ToggleView,         { .ui = 1 << TAG } }, \
+    { XCB_KEY_PRESS,            SHIFT|SUPER,            KEY,        TagWindow,          { .ui = 1 << TAG } }, \
+    { XCB_KEY_PRESS,            CTRL|SHIFT|SUPER,       KEY,        ToggleTag,          { .ui = 1 << TAG } },
 
 /* helper for spawning shell commands in the pre dwm-5.0 fashion */
 #define SHCMD(cmd) { .v = (const char*[]){ "/bin/sh", "-c", cmd, NULL } }
@@ -35,21 +42,40 @@ static const char *dmenucmd[] =
 static const char *termcmd[]        = { "st", NULL };
 static const Key keys[] =
 {
-    /* KeyType                  modifier                 key        function        argument */
+    /* KeyType                  modifier                 key        function        argument        repeat  rate(ms) 
+     * repeat is what holding the key does: KeyRepeatOnce (default) fires once per press, 
+     * KeyRepeatAlways fires on every autorepeat, KeyRepeatRate at most once every rate ms.
+     */
     { XCB_KEY_PRESS,            SUPER,                  XK_Return,  SpawnWindow,        { .v = termcmd  }  },
     { XCB_KEY_PRESS,            SUPER,                  XK_d,       SpawnWindow,        { .v = dmenucmd }  },
     { XCB_KEY_PRESS,            SUPER,                  XK_z,       SetWindowLayout,    { .ui = Tiled}  },
     { XCB_KEY_PRESS,            SUPER,                  XK_x,       SetWindowLayout,    { .ui = Floating }  },
     { XCB_KEY_PRESS,            SUPER,                  XK_c,       SetWindowLayout,    { .ui = Monocle}  },
     { XCB_KEY_PRESS,            SUPER,                  XK_g,       SetWindowLayout,    { .ui = Grid}  },
+    { XCB_KEY_PRESS,            SUPER,                  XK_m,       MaximizeWindow,     { 0 }  },
+    { XCB_KEY_PRESS,            SUPER,                  XK_F7,      KeyboardDragWindow, { 0 }  },
+    { XCB_KEY_PRESS,            SUPER,                  XK_F8,      KeyboardResizeWindow, { 0 }  },
+    { XCB_KEY_PRESS,            SUPER,                  XK_0,       View,               { .ui = ~0 }  },
+    { XCB_KEY_PRESS,            SHIFT|SUPER,            XK_0,       TagWindow,          { .ui = ~0 }  },
+    TAGKEYS(                                            XK_1,                           0)
+    TAGKEYS(                                            XK_2,                           1)
+    TAGKEYS(                                            XK_3,                           2)
+    TAGKEYS(                                            XK_4,                           3)
+    TAGKEYS(                                            XK_5,                           4)
+    TAGKEYS(                                            XK_6,                           5)
+    TAGKEYS(                                            XK_7,                           6)
+    TAGKEYS(                                            XK_8,                           7)
+    TAGKEYS(                                            XK_9,                           8)
 
     { XCB_KEY_PRESS,            CTRL|SUPER,             XK_p,       Restart,            { 0 }  },
+    { XCB_KEY_PRESS,            CTRL|SUPER,             XK_s,       UserStats,          { 0 },  KeyRepeatRate,  500 },
     { XCB_KEY_RELEASE,          SHIFT|SUPER,            XK_p,       Quit,               { 0 }  }
 };
 /* button definitions */
 /* click can be ClkTagBar, ClkLtSymbol, ClkStatusText, ClkWinTitle, ClkClientWin, or ClkRootWin */
 static const Button buttons[] = 
 {
+    { XCB_BUTTON_PRESS,     SUPER,      LMB,        DragWindow,     {.i = LMB} },
     { XCB_BUTTON_PRESS,     SUPER,      RMB,        ResizeWindow,   {.i = RMB} },
 };
 
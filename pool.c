@@ -0,0 +1,117 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "util.h"
+#include "pool.h"
+
+/* objects are aligned to this (a cache line) so none straddles more lines than it has to, must be a power of 2 */
+#define POOL_ALIGN              64
+#define POOL_ROUND(X)           (((X) + POOL_ALIGN - 1) & ~(size_t)(POOL_ALIGN - 1))
+
+typedef struct PoolSlab PoolSlab;
+
+/* start of every slab, the objects follow at POOL_ROUND(sizeof(PoolSlab)) */
+struct PoolSlab
+{
+    PoolSlab *next;
+    uint32_t group;             /* Free list its objects go back to */
+};
+
+void
+poolinit(Pool *pool, size_t size, uint32_t count)
+{
+    const size_t header = POOL_ROUND(sizeof(PoolSlab));
+    memset(pool, 0, sizeof(Pool));
+    /* a free object holds the free list link */
+    pool->size = POOL_ROUND(MAX(size, sizeof(void *)));
+    /* poolfree() finds the slab by masking the address, so slabs are a power of 2 and aligned to it */
+    pool->slabsize = POOL_ALIGN;
+    while(pool->slabsize < header + pool->size * MAX(count, 1))
+    {   pool->slabsize <<= 1;
+    }
+    /* the rounding up is free objects */
+    pool->count = (pool->slabsize - header) / pool->size;
+}
+
+static int
+_poolgrow(Pool *pool, uint32_t group)
+{
+    const size_t header = POOL_ROUND(sizeof(PoolSlab));
+    PoolSlab *slab;
+    u8 *objects;
+    void **obj;
+    u32 i;
+
+    if(posix_memalign((void **)&slab, pool->slabsize, pool->slabsize))
+    {   return 0;
+    }
+    slab->next = pool->slabs;
+    slab->group = group;
+    pool->slabs = slab;
+    objects = (u8 *)slab + header;
+    /* linked back to front so the slab is handed out in address order */
+    for(i = pool->count; i--;)
+    {
+        obj = (void **)(objects + pool->size * i);
+        *obj = pool->free[group];
+        pool->free[group] = obj;
+    }
+    ++pool->slabcount;
+    pool->capacity += pool->count;
+    return 1;
+}
+
+void *
+poolalloc(Pool *pool)
+{
+    return poolallocgroup(pool, 0);
+}
+
+void *
+poolallocgroup(Pool *pool, uint32_t group)
+{
+    void **obj;
+    group &= POOL_GROUPS - 1;
+    if(!pool->free[group] && !_poolgrow(pool, group))
+    {   return NULL;
+    }
+    obj = pool->free[group];
+    pool->free[group] = *obj;
+    ++pool->used;
+    ++pool->allocs;
+    pool->peak = MAX(pool->peak, pool->used);
+    memset(obj, 0, pool->size);
+    return obj;
+}
+
+void
+poolfree(Pool *pool, void *ptr)
+{
+    PoolSlab *slab;
+    if(!ptr)
+    {   return;
+    }
+    slab = (PoolSlab *)((uintptr_t)ptr & ~(uintptr_t)(pool->slabsize - 1));
+    *(void **)ptr = pool->free[slab->group];
+    pool->free[slab->group] = ptr;
+    --pool->used;
+    ++pool->frees;
+}
+
+void
+pooldestroy(Pool *pool)
+{
+    PoolSlab *slab = pool->slabs;
+    PoolSlab *next;
+    while(slab)
+    {
+        next = slab->next;
+        free(slab);
+        slab = next;
+    }
+    memset(pool->free, 0, sizeof(pool->free));
+    pool->slabs = NULL;
+    pool->slabcount = 0;
+    pool->capacity = 0;
+    pool->used = 0;
+}
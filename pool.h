@@ -0,0 +1,59 @@
+#ifndef POOL_H_
+#define POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Fixed size object pools.
+ *
+ * Objects are carved out of slabs of count objects each, a new slab is only allocated once every object is in use.
+ * Every object starts on a cache line, sizes are rounded up to a multiple of one.
+ * Freed objects go on an intrusive free list (the link lives in the object itself) and are handed out again first,
+ * so allocating and freeing is O(1) without touching malloc() and live objects stay packed together.
+ *
+ * Every slab belongs to one of POOL_GROUPS groups with its own free list, poolallocgroup() only hands out
+ * objects from slabs of the group asked for, so objects of one group (Clients of one desktop) sit together.
+ * A freed object goes back to the group of its slab, found from its address since slabs are aligned to their size.
+ *
+ * A Pool must be poolinit()'d before use, slabs are only released by pooldestroy().
+ */
+
+#define POOL_GROUPS             32
+
+typedef struct Pool Pool;
+
+struct Pool
+{
+    size_t size;                /* Object size, rounded up for alignment    */
+    size_t slabsize;            /* Slab size, a power of 2 it is aligned to */
+    uint32_t count;             /* Objects per slab                         */
+    void *free[POOL_GROUPS];    /* Free list of each group                  */
+    void *slabs;                /* Slab list                                */
+    uint64_t slabcount;         /* Slabs allocated                          */
+    uint64_t capacity;          /* Objects in every slab                    */
+    uint64_t used;              /* Objects in use                           */
+    uint64_t peak;              /* Most objects in use at once              */
+    uint64_t allocs;            /* poolalloc() calls that succeeded         */
+    uint64_t frees;             /* poolfree() calls                         */
+};
+
+/* Sets up pool for objects of size bytes, at least count per slab (the slab is filled up to its power of 2).
+ * No memory is allocated until the first poolalloc().
+ */
+void poolinit(Pool *pool, size_t size, uint32_t count);
+/* Same as poolallocgroup(pool, 0).
+ * RETURN: a zeroed object on Success.
+ * RETURN: NULL on Failure (out of memory).
+ */
+void *poolalloc(Pool *pool);
+/* group is taken modulo POOL_GROUPS.
+ * RETURN: a zeroed object from a slab of group on Success.
+ * RETURN: NULL on Failure (out of memory).
+ */
+void *poolallocgroup(Pool *pool, uint32_t group);
+/* Gives ptr back to the group of its slab, does nothing if ptr is NULL. */
+void poolfree(Pool *pool, void *ptr);
+/* Frees every slab, every object of pool must be unused. pool can be poolalloc()'d from again. */
+void pooldestroy(Pool *pool);
+
+#endif
@@ -0,0 +1,93 @@
+#!/bin/sh
+# See LICENSE file for copyright and license details.
+#
+# Golden request stream tests.
+# Runs every tests/*.txt script against the WM built with the fake backend (make fake) and compares
+# the request log with the checked in tests/*.log.
+# Every section of a script (from one mark to the next) must make exactly as many requests, blocking replies
+# and syncs as it did in the golden log, and the logs must match line for line.
+#
+# usage: tests/run.sh [-u] [wm]
+#
+# -u    Rewrites the golden logs from this build instead of comparing, review their diff before committing it.
+
+TESTS=$(dirname "$0")
+update=0
+if [ "$1" = "-u" ]
+then
+    update=1
+    shift
+fi
+WM=${1:-$TESTS/../binary/fake/dwm-fake}
+
+die()
+{
+    echo "$(basename "$0"): $*" >&2
+    exit 1
+}
+
+[ -x "$WM" ] || die "$WM not found, run make fake first"
+tmp=$(mktemp -d) || die "mktemp failed"
+trap 'rm -rf "$tmp"' EXIT
+trap 'exit 1' INT TERM
+
+# one line per section: mark, requests, replies, syncs
+counts()
+{
+    awk -F '\t' '
+        function section() { printf "%s\t%d\t%d\t%d\n", mark, r, b, s }
+        BEGIN { mark = "startup" }
+        $1 == "M" { section(); mark = $2; r = b = s = 0 }
+        $1 == "R" { ++r }
+        $1 == "B" { ++b; if($4 == "XCBSync") ++s }
+        END { section() }' "$1"
+}
+
+rc=0
+for script in "$TESTS"/*.txt
+do
+    name=$(basename "$script" .txt)
+    golden="$TESTS/$name.log"
+    log="$tmp/$name.log"
+
+    XCB_FAKE_SCRIPT="$script" XCB_FAKE_LOG="$log" "$WM" >/dev/null 2>"$tmp/$name.err"
+    status=$?
+    if [ "$status" -ne 0 ]
+    then
+        echo "FAIL $name: exited with $status"
+        sed 's/^/    /' "$tmp/$name.err"
+        rc=1
+        continue
+    fi
+
+    if [ "$update" -eq 1 ]
+    then
+        cp "$log" "$golden"
+        echo "updated $golden"
+        continue
+    fi
+    if [ ! -f "$golden" ]
+    then
+        echo "FAIL $name: no $golden, run $0 -u"
+        rc=1
+        continue
+    fi
+    if cmp -s "$golden" "$log"
+    then
+        echo "ok   $name"
+        continue
+    fi
+
+    rc=1
+    echo "FAIL $name"
+    counts "$golden" > "$tmp/$name.want"
+    counts "$log" > "$tmp/$name.got"
+    paste "$tmp/$name.want" "$tmp/$name.got" | awk -F '\t' '
+        $1 != $5 { printf "    sections differ from \"%s\" on, the script changed?\n", $1; exit }
+        $2 != $6 || $3 != $7 || $4 != $8 {
+            printf "    %s: %d requests (golden %d), %d replies (golden %d), %d syncs (golden %d)\n",
+                    $1, $6, $2, $7, $3, $8, $4
+        }'
+    diff -u "$golden" "$log" | head -n 40 | sed 's/^/    /'
+done
+exit $rc
@@ -0,0 +1,342 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/timerfd.h>
+
+#include "util.h"
+#include "timer.h"
+
+#define SLOTBITS                6       /* log2(TIMER_SLOTS) */
+#define SLOTMASK                (TIMER_SLOTS - 1)
+/* ticks covered by the whole wheel, later timers wait in the last level and get placed again */
+#define WHEELSPAN               ((u64)1 << (SLOTBITS * TIMER_LEVELS))
+
+static int _fd = -1;
+/* CLOCK_MONOTONIC ns of tick 0 */
+static u64 _base = 0;
+/* last tick processed */
+static u64 _tick = 0;
+/* what the timerfd is armed for, 0 if disarmed */
+static u64 _armed = 0;
+static u32 _pending = 0;
+static Timer *_wheel[TIMER_LEVELS][TIMER_SLOTS];
+/* bit n set if _wheel[level][n] is not empty */
+static u64 _used[TIMER_LEVELS];
+
+static Idle *_idle = NULL;
+static Idle **_idletail = &_idle;
+static u32 _batch = 0;
+
+static u64
+_timertick(void)
+{
+    return (timernow() - _base) / 1000000;
+}
+
+/* links timer in the slot its expiry falls in relative to _tick. */
+static void
+_timerplace(Timer *timer)
+{
+    /* due (cascaded at its tick) timers go in the current slot, which is run next */
+    const u64 delta = timer->when > _tick ? MIN(timer->when - _tick, WHEELSPAN - 1) : 0;
+    const u64 when = _tick + delta;
+    u8 level = 0;
+    u8 slot;
+
+    while(delta >> (SLOTBITS * (level + 1)))
+    {   ++level;
+    }
+    slot = (when >> (SLOTBITS * level)) & SLOTMASK;
+    timer->level = level;
+    timer->slot = slot;
+    timer->next = _wheel[level][slot];
+    if(timer->next)
+    {   timer->next->pprev = &timer->next;
+    }
+    _wheel[level][slot] = timer;
+    timer->pprev = &_wheel[level][slot];
+    _used[level] |= (u64)1 << slot;
+}
+
+/* unlinks timer without touching _pending. */
+static void
+_timerunlink(Timer *timer)
+{
+    *timer->pprev = timer->next;
+    if(timer->next)
+    {   timer->next->pprev = timer->pprev;
+    }
+    if(!_wheel[timer->level][timer->slot])
+    {   _used[timer->level] &= ~((u64)1 << timer->slot);
+    }
+    timer->next = NULL;
+    timer->pprev = NULL;
+}
+
+/* moves every timer in the current slot of level down the wheel. */
+static void
+_timercascade(u8 level)
+{
+    const u8 slot = (_tick >> (SLOTBITS * level)) & SLOTMASK;
+    Timer *t = _wheel[level][slot];
+    Timer *next;
+
+    _wheel[level][slot] = NULL;
+    _used[level] &= ~((u64)1 << slot);
+    for(; t; t = next)
+    {
+        next = t->next;
+        t->pprev = NULL;
+        _timerplace(t);
+    }
+}
+
+/* RETURN: the next tick something is due at (an expiry or a cascade), 0 if nothing is pending. */
+static u64
+_timernext(void)
+{
+    u64 next = 0;
+    u64 candidate;
+    u64 above;
+    u8 index;
+    u8 level;
+    u8 offset;
+
+    for(level = 0; level < TIMER_LEVELS; ++level)
+    {
+        if(!_used[level])
+        {   continue;
+        }
+        /* the current slot of a level comes around again only after a full rotation */
+        index = (_tick >> (SLOTBITS * level)) & SLOTMASK;
+        above = index == SLOTMASK ? 0 : _used[level] & (~(u64)0 << (index + 1));
+        offset = above ? __builtin_ctzll(above) - index : __builtin_ctzll(_used[level]) + TIMER_SLOTS - index;
+        candidate = ((_tick >> (SLOTBITS * level)) + offset) << (SLOTBITS * level);
+        if(!next || candidate < next)
+        {   next = candidate;
+        }
+    }
+    return next;
+}
+
+/* arms the timerfd for the next tick something is due at, or disarms it. */
+static void
+_timerarm(void)
+{
+    struct itimerspec spec;
+    const u64 next = _pending ? _timernext() : 0;
+    const u64 when = next ? _base + next * 1000000 : 0;
+
+    if(when == _armed || _fd < 0)
+    {   return;
+    }
+    memset(&spec, 0, sizeof(spec));
+    spec.it_value.tv_sec = when / 1000000000;
+    spec.it_value.tv_nsec = when % 1000000000;
+    /* it_value of zero disarms */
+    if(timerfd_settime(_fd, TFD_TIMER_ABSTIME, &spec, NULL) == -1)
+    {   DEBUG("%s", "timerfd_settime() failed");
+    }
+    _armed = when;
+}
+
+/* processes ticks up to target, skipping ahead while the lower levels are empty. */
+static void
+_timeradvance(u64 target)
+{
+    Timer *t;
+    u8 level;
+    u8 slot;
+
+    while(_tick < target)
+    {
+        if(!_pending)
+        {   _tick = target;
+            break;
+        }
+        /* nothing can happen before the next boundary of the lowest used level */
+        for(level = 0; level < TIMER_LEVELS - 1 && !_used[level]; ++level);
+        if(level)
+        {
+            const u64 boundary = ((_tick >> (SLOTBITS * level)) + 1) << (SLOTBITS * level);
+            if(boundary > target)
+            {   _tick = target;
+                break;
+            }
+            _tick = boundary - 1;
+        }
+
+        ++_tick;
+        for(level = 1; level < TIMER_LEVELS && !(_tick & (((u64)1 << (SLOTBITS * level)) - 1)); ++level)
+        {   _timercascade(level);
+        }
+        slot = _tick & SLOTMASK;
+        while((t = _wheel[0][slot]))
+        {
+            _timerunlink(t);
+            --_pending;
+            t->func(t);
+        }
+    }
+}
+
+uint64_t
+timernow(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+int
+timerinit(void)
+{
+    _base = timernow();
+    _tick = 0;
+    _fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    return _fd;
+}
+
+int
+timerpending(const Timer *timer)
+{
+    return !!timer->pprev;
+}
+
+void
+timerset(Timer *timer, uint32_t ms, void (*func)(Timer *), void *data)
+{
+    const u64 now = _timertick();
+    if(timerpending(timer))
+    {   timercancel(timer);
+    }
+    /* nothing to process while empty, so the wheel may as well catch up */
+    if(!_pending)
+    {   _tick = MAX(_tick, now);
+    }
+    /* the current tick already ran */
+    timer->when = MAX(now + ms, _tick + 1);
+    timer->func = func;
+    timer->data = data;
+    _timerplace(timer);
+    ++_pending;
+    _timerarm();
+}
+
+void
+timercancel(Timer *timer)
+{
+    if(!timerpending(timer))
+    {   return;
+    }
+    _timerunlink(timer);
+    --_pending;
+    /* a late timerfd wakeup is harmless, only disarm for good */
+    if(!_pending)
+    {   _timerarm();
+    }
+}
+
+void
+timerrun(void)
+{
+    u64 expirations;
+
+    /* drain the fd, a failed read only means it was not ready */
+    if(read(_fd, &expirations, sizeof(expirations)) == -1)
+    {   /* nothing */
+    }
+    _armed = 0;
+    _timeradvance(_timertick());
+    _timerarm();
+}
+
+int
+idlepending(const Idle *task)
+{
+    return !!task->pprev;
+}
+
+int
+idlequeued(void)
+{
+    return !!_idle;
+}
+
+void
+idleadd(Idle *task, void (*func)(Idle *), void *data)
+{
+    if(idlepending(task))
+    {   return;
+    }
+    task->func = func;
+    task->data = data;
+    task->batch = _batch;
+    task->next = NULL;
+    task->pprev = _idletail;
+    *_idletail = task;
+    _idletail = &task->next;
+}
+
+void
+idlecancel(Idle *task)
+{
+    if(!idlepending(task))
+    {   return;
+    }
+    *task->pprev = task->next;
+    if(task->next)
+    {   task->next->pprev = task->pprev;
+    }
+    else
+    {   _idletail = task->pprev;
+    }
+    task->next = NULL;
+    task->pprev = NULL;
+}
+
+uint32_t
+idlerun(void)
+{
+    Idle *task;
+    /* tasks queued by the ones we run get the next batch and wait */
+    const u32 batch = _batch++;
+    u32 ran = 0;
+
+    while((task = _idle) && task->batch == batch)
+    {
+        idlecancel(task);
+        task->func(task);
+        ++ran;
+    }
+    return ran;
+}
+
+void
+timercleanup(void)
+{
+    Timer *t;
+    u8 level;
+    u8 slot;
+
+    for(level = 0; level < TIMER_LEVELS; ++level)
+    {
+        for(slot = 0; slot < TIMER_SLOTS; ++slot)
+        {
+            while((t = _wheel[level][slot]))
+            {   _timerunlink(t);
+            }
+        }
+    }
+    memset(_used, 0, sizeof(_used));
+    _pending = 0;
+    while(_idle)
+    {   idlecancel(_idle);
+    }
+    if(_fd >= 0)
+    {   close(_fd);
+    }
+    _fd = -1;
+    _armed = 0;
+}
@@ -0,0 +1,75 @@
+#ifndef TIMER_H_
+#define TIMER_H_
+
+#include <stdint.h>
+
+/* Timers and deferred (idle) tasks for run().
+ *
+ * Timers live in a hierarchical timer wheel with 1ms ticks driven by a single timerfd,
+ * TIMER_LEVELS levels of TIMER_SLOTS slots each, so insert and cancel are O(1).
+ * The timerfd is only armed for the next tick something happens at so an idle WM never wakes up on its own.
+ *
+ * Idle tasks run once per batch, after run() handled every queued event and before it flushes.
+ * Adding a task that is already queued does nothing, so handlers can use them to coalesce work (relayouts, regrabs).
+ *
+ * Both are owned by the caller (usually embedded in a struct), must be zeroed before first use,
+ * and must be cancelled before being freed.
+ */
+
+#define TIMER_SLOTS             64
+#define TIMER_LEVELS            4
+
+typedef struct Timer Timer;
+typedef struct Idle Idle;
+
+struct Timer
+{
+    uint64_t when;              /* Expiry tick (ms)             */
+    void (*func)(Timer *);      /* Called once on expiry        */
+    void *data;                 /* Caller data                  */
+    Timer *next;                /* Next timer in slot           */
+    Timer **pprev;              /* Link pointing to us, NULL if not pending */
+    uint8_t level;              /* Wheel level while pending    */
+    uint8_t slot;               /* Wheel slot while pending     */
+};
+
+struct Idle
+{
+    void (*func)(Idle *);       /* Called once after the batch  */
+    void *data;                 /* Caller data                  */
+    Idle *next;                 /* Next queued task             */
+    Idle **pprev;               /* Link pointing to us, NULL if not queued */
+    uint32_t batch;             /* Batch it was queued in       */
+};
+
+/* RETURN: CLOCK_MONOTONIC in ns. */
+uint64_t timernow(void);
+/* Creates the timerfd.
+ * RETURN: the timerfd on Success.
+ * RETURN: -1 on Failure.
+ */
+int timerinit(void);
+/* Schedules timer to call func in ms milliseconds, a pending timer is rescheduled. */
+void timerset(Timer *timer, uint32_t ms, void (*func)(Timer *), void *data);
+/* Cancels timer, does nothing if it is not pending. */
+void timercancel(Timer *timer);
+/* RETURN: nonzero if timer is pending. */
+int timerpending(const Timer *timer);
+/* Call when the timerfd is readable, runs every expired timer and rearms the timerfd. */
+void timerrun(void);
+/* Queues task to call func after the current batch, does nothing if it is already queued. */
+void idleadd(Idle *task, void (*func)(Idle *), void *data);
+/* Removes task from the queue, does nothing if it is not queued. */
+void idlecancel(Idle *task);
+/* RETURN: nonzero if task is queued. */
+int idlepending(const Idle *task);
+/* RETURN: nonzero if any task is queued. */
+int idlequeued(void);
+/* Runs the tasks queued so far, tasks they queue wait for the next batch.
+ * RETURN: the number of tasks run.
+ */
+uint32_t idlerun(void);
+/* Cancels every pending timer and queued task and closes the timerfd. */
+void timercleanup(void);
+
+#endif
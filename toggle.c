@@ -1,4 +1,5 @@
 #include <unistd.h>
+#include <signal.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <sys/time.h>
@@ -10,14 +11,91 @@
 #include "xcb_trl.h"
 #include "config.h"
 #include "toggle.h"
+#include "events.h"
 
 
 
 extern WM _wm;
 
+static void
+statsoffender(FILE *file, Client *c)
+{
+    if(!c->info->focusfights)
+    {   return;
+    }
+    if(fprintf(file, "%s\t0x%x\t%s\t%lu\n", "client", c->win, c->info->name ? c->info->name : "",
+                (unsigned long)c->info->focusfights) < 0)
+    {   DEBUG("Failed to write: %s", STATS_FILE);
+    }
+}
+
 void
 UserStats(const Arg *arg)
 {
+    XCBStats total;
+    FILE *file = fopen(STATS_FILE, "w");
+    if(!file)
+    {   DEBUG("Failed to open: %s", STATS_FILE);
+        return;
+    }
+    if(!XCBStatsDump(file))
+    {   DEBUG("Failed to write: %s", STATS_FILE);
+    }
+    if(fprintf(file, "wakeup\txserver\tsignal\ttimer\tflushes\tidletasks\n%s\t%lu\t%lu\t%lu\t%lu\t%lu\n", "run",
+                (unsigned long)_wm.wakeups[WakeXServer], (unsigned long)_wm.wakeups[WakeSignal], 
+                (unsigned long)_wm.wakeups[WakeTimer], (unsigned long)_wm.idleflushes, (unsigned long)_wm.idletasks) < 0)
+    {   DEBUG("Failed to write: %s", STATS_FILE);
+    }
+    if(fprintf(file, "focusfight\tfights\tbackoffs\tdropped\n%s\t%lu\t%lu\t%lu\n", "focus",
+                (unsigned long)_wm.fights, (unsigned long)_wm.fightbackoffs, (unsigned long)_wm.fightdropped) < 0)
+    {   DEBUG("Failed to write: %s", STATS_FILE);
+    }
+    /* the clients that stole focus, withdrawn ones included */
+    if(fprintf(file, "offender\twindow\tname\tfights\n") < 0)
+    {   DEBUG("Failed to write: %s", STATS_FILE);
+    }
+    Monitor *m;
+    Desktop *desk;
+    Client *c;
+    for(m = _wm.mons; m; m = nextmonitor(m))
+    {
+        for(desk = m->desktops; desk; desk = nextdesktop(desk))
+        {
+            for(c = desk->clients; c; c = nextclient(c))
+            {   statsoffender(file, c);
+            }
+        }
+    }
+    for(c = _wm.withdrawn; c; c = c->info->wnext)
+    {   statsoffender(file, c);
+    }
+    const struct { const char *name; const Pool *pool; } pools[] = 
+    {
+        { "Client", &_wm.clientpool }, { "ClientInfo", &_wm.infopool }, { "Monitor", &_wm.monpool },
+    };
+    u32 i;
+    if(fprintf(file, "pool\tsize\tslabs\tcapacity\tused\tpeak\tallocs\tfrees\n") < 0)
+    {   DEBUG("Failed to write: %s", STATS_FILE);
+    }
+    for(i = 0; i < LENGTH(pools); ++i)
+    {
+        if(fprintf(file, "%s\t%lu\t%lu\t%lu\t%lu\t%lu\t%lu\t%lu\n", pools[i].name, (unsigned long)pools[i].pool->size,
+                    (unsigned long)pools[i].pool->slabcount, (unsigned long)pools[i].pool->capacity, 
+                    (unsigned long)pools[i].pool->used, (unsigned long)pools[i].pool->peak, 
+                    (unsigned long)pools[i].pool->allocs, (unsigned long)pools[i].pool->frees) < 0)
+        {   DEBUG("Failed to write: %s", STATS_FILE);
+        }
+    }
+    if(!eventstatsdump(file))
+    {   DEBUG("Failed to write: %s", STATS_FILE);
+    }
+    fclose(file);
+    XCBStatsTotal(&total);
+    DEBUG("requests: %lu, bytes: %lu, replies: %lu, blocked: %lu ns", 
+            (unsigned long)total.requests, (unsigned long)total.bytes, (unsigned long)total.replies, (unsigned long)total.blockns);
+    DEBUG("wakeups: xserver %lu, signal %lu, timer %lu, flushes: %lu",
+            (unsigned long)_wm.wakeups[WakeXServer], (unsigned long)_wm.wakeups[WakeSignal], 
+            (unsigned long)_wm.wakeups[WakeTimer], (unsigned long)_wm.idleflushes);
 }
 
 void
@@ -56,75 +134,43 @@ ChangeMasterWindow(const Arg *arg)
 void
 KillWindow(XCBDisplay *display, XCBWindow win)
 {
-    xcb_kill_client(display, win);
+    XCBKillClient(display, win);
 }
 
 void
 TerminateWindow(XCBDisplay *display, XCBWindow win)
 {
-    xcb_kill_client(display, win);
+    XCBKillClient(display, win);
 }
 
 void
-DragWindow(
-    XCBDisplay *display, 
-    XCBWindow win,
-    const XCBKeyCode key_or_button)
+DragWindow(const Arg *arg)
 {
-    i16 ox, oy;     /*    old   */
-    i16 x, y;       /*  current */
-    i16 nx, ny;     /*    new   */
-
-    XCBCookie gbpcookie = 
-        XCBGrabPointerCookie(display, win, False, MOUSEMASK, XCB_GRAB_MODE_ASYNC, XCB_GRAB_MODE_ASYNC, XCB_NONE, XCB_NONE, XCB_CURRENT_TIME);
-    XCBCookie qpcookie = XCBQueryPointerCookie(display, win);
-
-
-    XCBGrabPointer *grb = XCBGrabPointerReply(display, gbpcookie);
-    XCBQueryPointer *qp = XCBQueryPointerReply(display, qpcookie);
+    XCBButtonPressEvent *ev = arg->v;
+    Client *c = wintoclient(ev->event);
 
-
-    if(!grb || grb->status != XCB_GRAB_STATUS_SUCCESS)
-    {   
-        if(grb)
-        {   free(grb);
-        }
-        return;
+    if(!c)
+    {   c = _wm.selmon->desksel->sel;
     }
-    if(!qp)
-    {
-        free(grb);
-        return;
+    if(c)
+    {   dragstart(c, DragMove, ev->detail, ev->root_x, ev->root_y);
     }
+}
 
-    x = qp->root_x;
-    y = qp->root_y;
-    ox = qp->win_x;
-    oy = qp->win_y;
-
-    free(grb);
-    free(qp);
-
-    XCBMotionNotifyEvent *ev;
-    u8 cleanev;
-    u8 detail = 0;
-    do
-    {
-        ev = (XCBMotionNotifyEvent *)XCBPollForEvent(display);
-        cleanev = XCB_EVENT_RESPONSE_TYPE(ev);
+void
+KeyboardDragWindow(const Arg *arg)
+{
+    if(_wm.selmon->desksel->sel)
+    {   dragkeystart(_wm.selmon->desksel->sel, DragMove);
+    }
+}
 
-        if(ev->event == win && cleanev == XCB_MOTION_NOTIFY)
-        {
-            nx = ox + (ev->root_x - x);
-            ny = oy + (ev->root_y - y);
-            XCBMoveWindow(display, win, nx, ny);
-        }
-        if(cleanev == XCB_BUTTON_RELEASE)
-        {   
-            detail = ev->detail;
-        }
-        free(ev);
-    } while(cleanev != 0 && cleanev != XCB_BUTTON_RELEASE && detail != key_or_button);
+void
+KeyboardResizeWindow(const Arg *arg)
+{
+    if(_wm.selmon->desksel->sel)
+    {   dragkeystart(_wm.selmon->desksel->sel, DragResize);
+    }
 }
 
 void
@@ -147,90 +193,16 @@ Quit(const Arg *arg)
 }
 
 void
-_ResizeWindow(
-    XCBDisplay *display, 
-    XCBWindow win,
-    const XCBKeyCode key_or_button
-    ) /* resizemouse */
+ResizeWindow(const Arg *arg)
 {
-    i16 ox, oy;     /*    old   */
-    i16 x, y;       /*  current */
-    i16 nx, ny;     /*    new   */
-
-    u16 ow, oh;     /*    old   */
-    u16 nw, nh;     /*    new   */
-
-    i8 horiz;       /* bounds checks    */
-    i8 vert;        /* bounds checks    */
-
-    const XCBCursor cur = XCB_NONE;
-    XCBCookie qpcookie = XCBQueryPointerCookie(display, win);
-    XCBCookie gpcookie = XCBGrabPointerCookie(display, win, False, MOUSEMASK, XCB_GRAB_MODE_ASYNC, XCB_GRAB_MODE_ASYNC, XCB_NONE, cur, XCB_CURRENT_TIME);
-    XCBCookie gmcookie = XCBGetGeometryCookie(display, win);
+    XCBButtonPressEvent *ev = arg->v;
+    Client *c = wintoclient(ev->event);
 
-    XCBQueryPointer *qp = XCBQueryPointerReply(display, qpcookie);
-    XCBGrabPointer *gb = XCBGrabPointerReply(display, gpcookie);
-    XCBGeometry *gm = XCBGetGeometryReply(display, gmcookie);
-
-    if(!qp)
-    {   return;
+    if(!c)
+    {   c = _wm.selmon->desksel->sel;
     }
-    if(!gb || gb->status != XCB_GRAB_STATUS_SUCCESS)
-    {   free(qp);
-        return;
-    }
-    if(!gm)
-    {   
-        free(qp); 
-        free(gb);
-        return;
-    }
-
-    horiz = qp->win_x < (gm->width / 2) ? -1 : 1;
-    vert = qp->win_y < (gm->height / 2) ? -1 : 1;
-
-    x = qp->win_x;
-    y = qp->win_y; 
-
-    ox = gm->x;
-    oy = gm->y;
-
-    ow = gm->width;
-    oh = gm->height;
-
-
-    XCBMotionNotifyEvent *ev;
-    u8 cleanev = 0;
-    u8 detail = 0;
-    do
-    {
-        ev = (XCBMotionNotifyEvent *)XCBPollForEvent(display);
-        if(!ev)
-        {   continue;
-        }
-        cleanev = XCB_EVENT_RESPONSE_TYPE(ev);
-
-        if(ev->event == win && cleanev == XCB_MOTION_NOTIFY)
-        {
-            nw = ow + (horiz    * (ev->root_x - x));
-            nh = oh + (vert     * (ev->root_y - y));
-            nx = ox + (!~horiz) * (ow - nw);
-            ny = oy + (!~vert)  * (oh - nh);
-            XCBMoveResizeWindow(display, win, nx, ny, nw, nh);
-        }
-        detail = ev->detail;
-        free(ev);
-        ev = NULL;
-    } while(cleanev != 0 && (cleanev != XCB_BUTTON_RELEASE && detail != key_or_button));
-}
-
-void
-ResizeWindow(const Arg *arg)
-{
-    if(_wm.selmon->desksel->sel)
-    {
-        XCBButtonPressEvent *ev = arg->v;
-        _ResizeWindow(_wm.dpy, _wm.selmon->desksel->sel->win, ev->detail);
+    if(c)
+    {   dragstart(c, DragResize, ev->detail, ev->root_x, ev->root_y);
     }
 }
 
@@ -254,28 +226,54 @@ SpawnWindow(const Arg *arg)
 {
     if (fork() == 0)
     {
+        sigset_t set;
         if (_wm.dpy)
             close(XCBConnectionNumber(_wm.dpy));
+        /* run() blocks these for its signalfd, the mask is inherited across exec */
+        sigemptyset(&set);
+        sigprocmask(SIG_SETMASK, &set, NULL);
         setsid();
         execvp(((char **)arg->v)[0], (char **)arg->v);
         /* UNREACHABLE */
         DEBUG("%s", "execvp Failed");
+        /* dont let the child run a second copy of the event loop */
+        _exit(EXIT_FAILURE);
     }
 }
 
 void
 MaximizeWindow(const Arg *arg)
 {
+    Client *c = _wm.selmon->desksel->sel;
+    if(c)
+    {
+        const u8 maximized = ISMAXIMIZEDVERT(c) && ISMAXIMIZEDHORZ(c);
+        setmaximizedvert(c, !maximized);
+        setmaximizedhorz(c, !maximized);
+        arrange(c->desktop);
+    }
 }
 
 void
 MaximizeWindowVertical(const Arg *arg) 
 {
+    Client *c = _wm.selmon->desksel->sel;
+    if(c)
+    {
+        setmaximizedvert(c, !ISMAXIMIZEDVERT(c));
+        arrange(c->desktop);
+    }
 }
 
 void
 MaximizeWindowHorizontal(const Arg *arg) 
 {
+    Client *c = _wm.selmon->desksel->sel;
+    if(c)
+    {
+        setmaximizedhorz(c, !ISMAXIMIZEDHORZ(c));
+        arrange(c->desktop);
+    }
 }
 
 void
@@ -283,6 +281,47 @@ AltTab(const Arg *arg)
 {
 }
 
+void
+TagWindow(const Arg *arg)
+{
+    Client *c = _wm.selmon->desksel->sel;
+    Desktop *old;
+    if(!c || !(arg->ui & TAGMASK(c->mon)))
+    {   return;
+    }
+    old = c->desktop;
+    setclienttags(c, arg->ui);
+    arrange(old);
+    if(c->desktop != old)
+    {   arrange(c->desktop);
+    }
+    focus(NULL);
+}
+
+void
+ToggleTag(const Arg *arg)
+{
+    Client *c = _wm.selmon->desksel->sel;
+    if(c)
+    {   
+        /* TagWindow() ignores taking away its last tag */
+        const Arg tags = { .ui = c->tags ^ arg->ui };
+        TagWindow(&tags);
+    }
+}
+
+void
+ToggleView(const Arg *arg)
+{
+    setview(_wm.selmon, _wm.selmon->tagset ^ arg->ui);
+}
+
+void
+View(const Arg *arg)
+{
+    setview(_wm.selmon, arg->ui);
+}
+
 void
 ToggleStatusBar(const Arg *arg)
 {
@@ -2,7 +2,10 @@
 #define TOGGLE_H_
 #include "dwm.h"
 
-/* Mostly a testing function */
+/* Writes the request statistics of xcb_trl (see XCBStatsDump()), the run() wakeup counts
+ * the focus fight counters and the clients that fought (see focusfight()), the Client/Desktop/Monitor pool usage 
+ * and the per window event counts (see eventstatsdump()) to STATS_FILE
+ */
 void UserStats(const Arg *arg);
 /* Switch to a monitor based on the argument int arg i */
 void FocusMonitor(const Arg *arg);
@@ -12,13 +15,17 @@ void ChangeMasterWindow(const Arg *arg);
 void KillWindow(XCBDisplay *display, XCBWindow win);
 /* Attempts to kill the current window directly instead of just sending a signal and waiting for the window to respond */
 void TerminateWindow(XCBDisplay *display, XCBWindow win);
-/* keybind to move the current window where the mouse cursor is */
-void DragWindow(XCBDisplay *display, XCBWindow win, const XCBKeyCode key_or_button);
+/* moves the clicked window with the mouse until the button is released, see dragstart() */
+void DragWindow(const Arg *arg);
+/* moves the current window with the arrow keys until Return (Escape puts it back), see dragkey() */
+void KeyboardDragWindow(const Arg *arg);
+/* resizes the current window with the arrow keys until Return (Escape puts it back), see dragkey() */
+void KeyboardResizeWindow(const Arg *arg);
 /* restarts dwm */
 void Restart(const Arg *arg);
 /* quits dwm */
 void Quit(const Arg *arg);
-/* resizes the current window based on mouse position */
+/* resizes the clicked window with the mouse until the button is released, from the nearest corner */
 void ResizeWindow(const Arg *arg);
 /* sets the window layout based on a enum in dwm.h -> Grid, Floating, Monocle, Tiled */
 void SetWindowLayout(const Arg *arg);
@@ -35,7 +42,7 @@ void MaximizeWindowVertical(const Arg *arg);
 void MaximizeWindowHorizontal(const Arg *arg);
 /* Switches to the next visible window based on user input */
 void AltTab(const Arg *arg);
-/* Tags a window AKA makes it visible in another desktop thing or "tag" */
+/* Sets the tags of the current window to the bitmask arg ui, it is shown on every desktop whose bit is set */
 void TagWindow(const Arg *arg);
 /* Tags a monitor */
 void TagMonitor(const Arg *arg);
@@ -45,15 +52,13 @@ void ToggleStatusBar(const Arg *arg);
 void ToggleFloating(const Arg *arg);
 /* Toggles fullscreen mode for all windows in current tag */
 void ToggleFullscreen(const Arg *arg);
-/* Probably toggles the tag selected IDK */
+/* Toggles the tags in arg ui on the current window, it always keeps atleast one */
 void ToggleTag(const Arg *arg);
-/* This is used in keybinds default SUPER + (1-9)
- * And essential just changes the tag to the one specified in the number
- * AKA 1 << TAG
- * This is really only a "User function" see View for devs
+/* Toggles the tags in arg ui on the selected monitors view, so several desktops are shown at once
+ * The view always keeps atleast one
  */
 void ToggleView(const Arg *arg);
-/* Switches to the tag number specified in base power of 2^x
+/* Switches to the tags specified in base power of 2^x, tag n is desktop n
  * Example:
  * tag1,tag2,tag3,tag4,tag5,tag6,tag7,tag8,tag9
  * {1,  2,   4,   8,   16,  32,  64,  128, 256}
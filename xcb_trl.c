@@ -20,6 +20,8 @@
 #include <xcb/xcb_keysyms.h>
 #include <xcb/xcb_cursor.h>
 #include <xcb/xinerama.h>
+#include <xcb/sync.h>
+#include <xcb/xkb.h>
 #include <xcb/xcb_xrm.h>
 #include <xcb/xcb_errors.h>
 
@@ -31,6 +33,12 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdarg.h>
+#include <inttypes.h>
+#include <time.h>
+#include <unistd.h>
+#ifdef __GLIBC__
+#include <execinfo.h>
+#endif
 
 
 typedef uint8_t  u8;
@@ -48,11 +56,21 @@ static void (*_handler)(XCBDisplay *, XCBGenericError *) = NULL;
 
 #ifdef XCB_TRL_ENABLE_DEBUG
     #if XCB_TRL_ENABLE_DEBUG != 0
-    #define DBG             1
+        #if XCB_TRL_DEBUG_ASYNC != 0
+        #define DBGASYNC        1
+        #else
+        #define DBG             1
+        #endif
     #define _fn             __func__
     #endif
 #endif
 
+#ifdef DBGASYNC
+#define _TRACK(COOKIE, WINDOW)  _xcb_track((COOKIE), __func__, (WINDOW), __builtin_return_address(0))
+#else
+#define _TRACK(COOKIE, WINDOW)  (COOKIE)
+#endif
+
 /* HELPER FUNCTION */
 static XCBScreen *
 screen_of_display(XCBDisplay *display, int screen)
@@ -69,7 +87,315 @@ screen_of_display(XCBDisplay *display, int screen)
     return NULL;
 }
 
-#ifdef DBG
+
+
+#ifdef XCB_TRL_ENABLE_STATS
+    #if XCB_TRL_ENABLE_STATS != 0
+    #define STATS           1
+    #endif
+#endif
+
+/* X requests are padded to 4 bytes */
+#define _PAD4(N)            (((N) + 3) & ~3)
+
+#ifdef XCB_TRL_ENABLE_HOT_CHECK
+    #if XCB_TRL_ENABLE_HOT_CHECK != 0
+    #define HOT             1
+    #endif
+#endif
+
+#ifdef HOT
+#define _HOT()              _xcb_hot_check(__func__)
+#else
+#define _HOT()              ((void)0)
+#endif
+
+#ifdef STATS
+#define _REQ(BYTES)         _xcb_stats_request(__func__, (BYTES))
+#define _BLOCK(...)         do { _HOT(); const u64 _t0 = _xcb_stats_clock(); __VA_ARGS__; _xcb_stats_reply(__func__, _t0); } while(0)
+#else
+#define _REQ(BYTES)         ((void)0)
+#define _BLOCK(...)         do { _HOT(); __VA_ARGS__; } while(0)
+#endif
+
+#ifdef STATS
+/* must be a power of 2 */
+#define STATS_SIZE          512
+
+static XCBStats _stats[STATS_SIZE];
+static XCBStats _statsoverflow = { .wrapper = "(overflow)", .scope = "(overflow)" };
+static XCBStats *_statslast = _stats;
+static const char *_scope = NULL;
+
+static u64
+_xcb_stats_clock(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+/* wrapper and scope are string literals (__func__) so we can just compare the pointers */
+static XCBStats *
+_xcb_stats_slot(const char *wrapper)
+{
+    XCBStats *s = _statslast;
+    if(s->wrapper == wrapper && s->scope == _scope)
+    {   return s;
+    }
+    u64 key = ((u64)(uintptr_t)wrapper * UINT64_C(0x9E3779B97F4A7C15)) ^ (u64)(uintptr_t)_scope;
+    key ^= key >> 29;
+    u32 i;
+    for(i = 0; i < STATS_SIZE; ++i)
+    {
+        s = _stats + ((key + i) & (STATS_SIZE - 1));
+        if(!s->wrapper)
+        {
+            s->wrapper = wrapper;
+            s->scope = _scope;
+            break;
+        }
+        if(s->wrapper == wrapper && s->scope == _scope)
+        {   break;
+        }
+    }
+    if(i == STATS_SIZE)
+    {   return &_statsoverflow;
+    }
+    _statslast = s;
+    return s;
+}
+
+static void
+_xcb_stats_request(const char *wrapper, u32 bytes)
+{
+    XCBStats *s = _xcb_stats_slot(wrapper);
+    ++s->requests;
+    s->bytes += bytes;
+}
+
+static void
+_xcb_stats_reply(const char *wrapper, u64 start)
+{
+    XCBStats *s = _xcb_stats_slot(wrapper);
+    ++s->replies;
+    s->blockns += _xcb_stats_clock() - start;
+}
+#endif
+
+const char *
+XCBStatsEnter(const char *scope)
+{
+#ifdef STATS
+    const char *previous = _scope;
+    _scope = scope;
+    return previous;
+#endif
+    (void)scope;
+    return NULL;
+}
+
+void
+XCBStatsLeave(const char **previous)
+{
+#ifdef STATS
+    _scope = *previous;
+#endif
+    (void)previous;
+}
+
+u32
+XCBStatsGet(XCBStats *stats_return, u32 max)
+{
+    u32 count = 0;
+#ifdef STATS
+    u32 i;
+    for(i = 0; i < STATS_SIZE && count < max; ++i)
+    {
+        if(_stats[i].wrapper)
+        {   stats_return[count++] = _stats[i];
+        }
+    }
+    if(_statsoverflow.requests && count < max)
+    {   stats_return[count++] = _statsoverflow;
+    }
+#endif
+    (void)stats_return;
+    (void)max;
+    return count;
+}
+
+void
+XCBStatsTotal(XCBStats *total_return)
+{
+    memset(total_return, 0, sizeof(XCBStats));
+    total_return->wrapper = "(total)";
+    total_return->scope = "(total)";
+#ifdef STATS
+    u32 i;
+    for(i = 0; i < STATS_SIZE; ++i)
+    {
+        total_return->requests += _stats[i].requests;
+        total_return->bytes += _stats[i].bytes;
+        total_return->replies += _stats[i].replies;
+        total_return->blockns += _stats[i].blockns;
+    }
+    total_return->requests += _statsoverflow.requests;
+    total_return->bytes += _statsoverflow.bytes;
+    total_return->replies += _statsoverflow.replies;
+    total_return->blockns += _statsoverflow.blockns;
+#endif
+}
+
+void
+XCBStatsReset(void)
+{
+#ifdef STATS
+    memset(_stats, 0, sizeof(_stats));
+    _statsoverflow.requests = 0;
+    _statsoverflow.bytes = 0;
+    _statsoverflow.replies = 0;
+    _statsoverflow.blockns = 0;
+    _statslast = _stats;
+#endif
+}
+
+int
+XCBStatsDump(FILE *file)
+{
+    XCBStats s;
+    int ret = 0;
+    ret |= fprintf(file, "wrapper\tscope\trequests\tbytes\treplies\tblockns\n") < 0;
+#ifdef STATS
+    u32 i;
+    for(i = 0; i < STATS_SIZE + 1; ++i)
+    {
+        s = i < STATS_SIZE ? _stats[i] : _statsoverflow;
+        if(s.wrapper && s.requests | s.replies)
+        {
+            ret |= fprintf(file, "%s\t%s\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\n", 
+                    s.wrapper, s.scope ? s.scope : "(none)", s.requests, s.bytes, s.replies, s.blockns) < 0;
+        }
+    }
+#endif
+    XCBStatsTotal(&s);
+    ret |= fprintf(file, "%s\t%s\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\n", 
+            s.wrapper, s.scope, s.requests, s.bytes, s.replies, s.blockns) < 0;
+    return !ret;
+}
+
+#ifdef HOT
+static const char *_hot = NULL;
+static u8 _hotpolicy = XCB_TRL_HOT_LOG;
+static u64 _hotviolations = 0;
+
+static void
+_xcb_hot_check(const char *wrapper)
+{
+    if(!_hot)
+    {   return;
+    }
+    ++_hotviolations;
+    if(_hotpolicy & (XCB_TRL_HOT_LOG | XCB_TRL_HOT_ABORT))
+    {
+        fprintf(stderr, "xcb_trl: %s() blocked on the XServer inside hot path %s()\n", wrapper, _hot);
+#ifdef __GLIBC__
+        void *frames[32];
+        const int count = backtrace(frames, 32);
+        backtrace_symbols_fd(frames, count, STDERR_FILENO);
+#endif
+    }
+    if(_hotpolicy & XCB_TRL_HOT_ABORT)
+    {   abort();
+    }
+}
+#endif
+
+const char *
+XCBHotEnter(const char *hot)
+{
+#ifdef HOT
+    const char *previous = _hot;
+    _hot = hot;
+    return previous;
+#endif
+    (void)hot;
+    return NULL;
+}
+
+void
+XCBHotLeave(const char **previous)
+{
+#ifdef HOT
+    _hot = *previous;
+#endif
+    (void)previous;
+}
+
+void
+XCBSetHotPolicy(u8 policy)
+{
+#ifdef HOT
+    _hotpolicy = policy;
+#endif
+    (void)policy;
+}
+
+u64
+XCBHotViolations(void)
+{
+#ifdef HOT
+    return _hotviolations;
+#endif
+    return 0;
+}
+
+#ifdef DBGASYNC
+/* must be a power of 2, errors arrive a few round trips late at most */
+#define TRACK_SIZE          1024
+
+static XCBRequestOrigin _track[TRACK_SIZE];
+static u32 _trackhead = 0;
+
+static XCBCookie
+_xcb_track(XCBCookie cookie, const char *wrapper, u32 window, void *caller)
+{
+    XCBRequestOrigin *origin = _track + (_trackhead++ & (TRACK_SIZE - 1));
+    origin->sequence = cookie.sequence;
+    origin->window = window;
+    origin->wrapper = wrapper;
+#ifdef STATS
+    origin->scope = _scope;
+#else
+    origin->scope = NULL;
+#endif
+    origin->caller = caller;
+    return cookie;
+}
+#endif
+
+int
+XCBErrorOrigin(XCBGenericError *err, XCBRequestOrigin *origin_return)
+{
+#ifdef DBGASYNC
+    u32 i;
+    /* newest first, sequences wrap */
+    for(i = 1; i <= TRACK_SIZE; ++i)
+    {
+        const XCBRequestOrigin *origin = _track + ((_trackhead - i) & (TRACK_SIZE - 1));
+        if(origin->wrapper && origin->sequence == err->full_sequence)
+        {
+            *origin_return = *origin;
+            return 1;
+        }
+    }
+#endif
+    (void)err;
+    (void)origin_return;
+    return 0;
+}
+
+#if defined(DBG) || defined(DBGASYNC)
 static void
 jmpck(XCBDisplay *d, XCBGenericError *err)
 {
@@ -86,9 +412,17 @@ jmpck(XCBDisplay *d, XCBGenericError *err)
            err->error_code, err->major_code, err->minor_code, 
            err->sequence, err->response_type, err->resource_id, 
            err->full_sequence);
-
+#ifdef DBGASYNC
+    XCBRequestOrigin origin;
+    if(XCBErrorOrigin(err, &origin))
+    {   
+        fprintf(stderr, "Occured at: %s() window: [%u] scope: %s() caller: [%p]\n", 
+                origin.wrapper, origin.window, origin.scope ? origin.scope : "(none)", origin.caller);
+    }
+#endif
 }
 
+#ifdef DBG
 static void
 ck(XCBDisplay *d, XCBCookie c, const char *func)
 {
@@ -99,7 +433,16 @@ ck(XCBDisplay *d, XCBCookie c, const char *func)
         return;
     }
     XCBGenericError *err = NULL;
+#ifdef HOT
+    _xcb_hot_check(func);
+#endif
+#ifdef STATS
+    const u64 t0 = _xcb_stats_clock();
     err = xcb_request_check(d, c);
+    _xcb_stats_reply(func, t0);
+#else
+    err = xcb_request_check(d, c);
+#endif
     if(err)
     {
         jmpck(d, err);
@@ -118,6 +461,8 @@ ck(XCBDisplay *d, XCBCookie c, const char *func)
     }
 }
 
+#endif
+
 void  
 XCBBreakPoint(void) 
 {
@@ -125,7 +470,6 @@ XCBBreakPoint(void)
 
 #endif
 
-
 static void
 _xcb_err_handler(XCBDisplay *display, XCBGenericError *err)
 {
@@ -133,7 +477,7 @@ _xcb_err_handler(XCBDisplay *display, XCBGenericError *err)
     if(!err || !display)
     {   return;
     }
-#ifdef DBG
+#if defined(DBG) || defined(DBGASYNC)
     jmpck(display, err);
     free(err);
     return;
@@ -314,36 +658,39 @@ XCBDefaultDepth(XCBDisplay *display, int screen)
 XCBCookie
 XCBSelectInput(XCBDisplay *display, XCBWindow window, u32 mask)
 {
+    _REQ(12 + 4);
 #ifdef DBG
     XCBCookie cookie = xcb_change_window_attributes_checked(display, window, XCB_CW_EVENT_MASK, &mask);
     ck(display, cookie, _fn);
     return cookie;
 #endif
 
-    return xcb_change_window_attributes(display, window, XCB_CW_EVENT_MASK, &mask);
+    return _TRACK(xcb_change_window_attributes(display, window, XCB_CW_EVENT_MASK, &mask), window);
 }
 
 XCBCookie
 XCBSetInputFocus(XCBDisplay *display, XCBWindow window, u8 revert_to, XCBTimestamp tim)
 {
+    _REQ(12);
 #ifdef DBG
     XCBCookie cookie = xcb_set_input_focus_checked(display, revert_to, window, tim);
     ck(display, cookie, _fn);
     return cookie;
 #endif
 
-    return xcb_set_input_focus(display, revert_to, window, tim);
+    return _TRACK(xcb_set_input_focus(display, revert_to, window, tim), window);
 }
 
 XCBCookie
 XCBChangeWindowAttributes(XCBDisplay *display, XCBWindow window, u32 mask, XCBWindowAttributes *window_attributes)
 {
+    _REQ(12 + 4 * __builtin_popcount(mask));
 #ifdef DBG
     XCBCookie cookie = xcb_change_window_attributes_aux_checked(display, window, mask, window_attributes);
     ck(display, cookie, _fn);
     return cookie;
 #endif
-    return xcb_change_window_attributes_aux(display, window, mask, window_attributes);
+    return _TRACK(xcb_change_window_attributes_aux(display, window, mask, window_attributes), window);
 }
 
 u32
@@ -369,12 +716,13 @@ XCBWhitePixel(XCBDisplay *display, int screen)
 void
 XCBSync(XCBDisplay *display)
 { 
+    _REQ(4);
     /* "https://community.kde.org/Xcb"
      * The xcb equivalent of XSync() is xcb_aux_sync(), which is in xcb-utils.
      * The reason you won't find a sync function in libxcb is that there is no sync request in the X protocol. 
      * Calling XSync() or xcb_aux_sync() is equivalent to calling XGetInputFocus() and throwing away the reply.
      */
-    xcb_aux_sync(display);
+    _BLOCK(xcb_aux_sync(display));
 }
 
 void
@@ -400,6 +748,7 @@ XCBSyncf(XCBDisplay *display)
 XCBCookie
 XCBMoveWindow(XCBDisplay *display, XCBWindow window, i32 x, i32 y)
 {
+    _REQ(12 + 8);
     const i32 values[4] = { x, y };
     const u16 mask = XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y;
 #ifdef DBG
@@ -407,7 +756,7 @@ XCBMoveWindow(XCBDisplay *display, XCBWindow window, i32 x, i32 y)
     ck(display, cookie, _fn);
     return cookie;
 #endif
-    return xcb_configure_window(display, window, mask, values);
+    return _TRACK(xcb_configure_window(display, window, mask, values), window);
 }
 
 XCBCookie
@@ -421,6 +770,7 @@ XCBMoveResizeWindow(XCBDisplay *display, XCBWindow window, i32 x, i32 y, u32 wid
 XCBCookie
 XCBResizeWindow(XCBDisplay *display, XCBWindow window, u32 width, u32 height)
 {
+    _REQ(12 + 8);
     const u32 values[4] = { width, height };
     const u32 mask = XCB_CONFIG_WINDOW_WIDTH|XCB_CONFIG_WINDOW_HEIGHT;
 
@@ -430,12 +780,13 @@ XCBResizeWindow(XCBDisplay *display, XCBWindow window, u32 width, u32 height)
     return cookie;
 #endif
 
-    return xcb_configure_window(display, window, mask, values);
+    return _TRACK(xcb_configure_window(display, window, mask, values), window);
 }
 
 XCBCookie
 XCBRaiseWindow(XCBDisplay *display, XCBWindow window)
 {
+    _REQ(12 + 4);
     const u32 values[1] = { XCB_STACK_MODE_ABOVE };
     const u32 mask = XCB_CONFIG_WINDOW_STACK_MODE;
 #ifdef DBG
@@ -443,13 +794,14 @@ XCBRaiseWindow(XCBDisplay *display, XCBWindow window)
     ck(display, cookie, _fn);
     return cookie;
 #endif
-    return xcb_configure_window(display, window, mask, &values);
+    return _TRACK(xcb_configure_window(display, window, mask, &values), window);
 }
 
 XCBCookie
 XCBMapRaised(XCBDisplay *display, XCBWindow window)
 {
-    xcb_map_window(display, window);
+    _REQ(8);
+    _TRACK(xcb_map_window(display, window), window);
 #ifdef DBG
     XCBCookie cookie = xcb_map_window_checked(display, window);
     ck(display, cookie, _fn);
@@ -461,6 +813,7 @@ XCBMapRaised(XCBDisplay *display, XCBWindow window)
 XCBCookie
 XCBLowerWindow(XCBDisplay *display, XCBWindow window)
 {
+    _REQ(12 + 4);
     const u32 values[1] = { XCB_STACK_MODE_BELOW };
     const u32 mask = XCB_CONFIG_WINDOW_STACK_MODE;
 #ifdef DBG
@@ -468,12 +821,13 @@ XCBLowerWindow(XCBDisplay *display, XCBWindow window)
     ck(display, cookie, _fn);
     return cookie;
 #endif
-    return xcb_configure_window(display, window, mask, &values);
+    return _TRACK(xcb_configure_window(display, window, mask, &values), window);
 }
 
 XCBCookie
 XCBRaiseWindowIf(XCBDisplay *display, XCBWindow window)
 {
+    _REQ(12 + 4);
     const u32 values[1] = { XCB_STACK_MODE_TOP_IF };
     const u32 mask = XCB_CONFIG_WINDOW_STACK_MODE;
 #ifdef DBG
@@ -481,12 +835,13 @@ XCBRaiseWindowIf(XCBDisplay *display, XCBWindow window)
     ck(display, cookie, _fn);
     return cookie;
 #endif
-    return xcb_configure_window(display, window, mask, &values);
+    return _TRACK(xcb_configure_window(display, window, mask, &values), window);
 }
 
 XCBCookie
 XCBLowerWindowIf(XCBDisplay *display, XCBWindow window)
 {
+    _REQ(12 + 4);
     const u32 values[1] = { XCB_STACK_MODE_BOTTOM_IF };
     const u32 mask = XCB_CONFIG_WINDOW_STACK_MODE;
 #ifdef DBG
@@ -494,12 +849,13 @@ XCBLowerWindowIf(XCBDisplay *display, XCBWindow window)
     ck(display, cookie, _fn);
     return cookie;
 #endif
-    return xcb_configure_window(display, window, mask, &values);
+    return _TRACK(xcb_configure_window(display, window, mask, &values), window);
 }
 
 XCBCookie
 XCBRaiseLowerWindow(XCBDisplay *display, XCBWindow window)
 {
+    _REQ(12 + 4);
     const u32 values[1] = { XCB_STACK_MODE_OPPOSITE };
     const u32 mask = XCB_CONFIG_WINDOW_STACK_MODE;
 #ifdef DBG
@@ -507,12 +863,13 @@ XCBRaiseLowerWindow(XCBDisplay *display, XCBWindow window)
     ck(display, cookie, _fn);
     return cookie;
 #endif
-    return xcb_configure_window(display, window, mask, &values);
+    return _TRACK(xcb_configure_window(display, window, mask, &values), window);
 }
 
 XCBCookie
 XCBSetWindowBorderWidth(XCBDisplay *display, XCBWindow window, u32 border_width)
 {
+    _REQ(12 + 4);
     const u32 values[1] = { border_width };
     const u32 mask = XCB_CONFIG_WINDOW_BORDER_WIDTH;
 #ifdef DBG
@@ -520,12 +877,13 @@ XCBSetWindowBorderWidth(XCBDisplay *display, XCBWindow window, u32 border_width)
     ck(display, cookie, _fn);
     return cookie;
 #endif
-    return xcb_configure_window(display, window, mask, &values);
+    return _TRACK(xcb_configure_window(display, window, mask, &values), window);
 }
 
 XCBCookie
 XCBSetSibling(XCBDisplay *display, XCBWindow window, XCBWindow sibling)
 {
+    _REQ(12 + 4);
     const u32 values[1] = { sibling };
     const u32 mask = XCB_CONFIG_WINDOW_SIBLING;
 #ifdef DBG
@@ -533,14 +891,15 @@ XCBSetSibling(XCBDisplay *display, XCBWindow window, XCBWindow sibling)
     ck(display, cookie, _fn);
     return cookie;
 #endif
-    return xcb_configure_window(display, window, mask, &values);
+    return _TRACK(xcb_configure_window(display, window, mask, &values), window);
 }
 
 XCBCookie
 XCBGetWindowAttributesCookie(XCBDisplay *display, XCBWindow window)
 {
+    _REQ(8);
     const xcb_get_window_attributes_cookie_t cookie = xcb_get_window_attributes(display, window);
-    return (XCBCookie) { .sequence = cookie.sequence };
+    return _TRACK((XCBCookie) { .sequence = cookie.sequence }, window);
 }
 
 XCBGetWindowAttributes *
@@ -549,7 +908,7 @@ XCBGetWindowAttributesReply(XCBDisplay *display, XCBCookie cookie)
     XCBGenericError *err = NULL;
     XCBGetWindowAttributes *reply = NULL;
     const xcb_get_window_attributes_cookie_t cookie1 = { .sequence = cookie.sequence };
-    reply = xcb_get_window_attributes_reply(display, cookie1, &err);
+    _BLOCK(reply = xcb_get_window_attributes_reply(display, cookie1, &err));
     if(err)
     {
         _xcb_err_handler(display, err);
@@ -564,8 +923,9 @@ XCBGetWindowAttributesReply(XCBDisplay *display, XCBCookie cookie)
 XCBCookie
 XCBGetWindowGeometryCookie(XCBDisplay *display, XCBWindow window)
 {
+    _REQ(8);
     const xcb_get_geometry_cookie_t cookie = xcb_get_geometry(display, window);
-    return (XCBCookie) { .sequence = cookie.sequence };
+    return _TRACK((XCBCookie) { .sequence = cookie.sequence }, window);
 }
 
 XCBGeometry *
@@ -574,7 +934,7 @@ XCBGetWindowGeometryReply(XCBDisplay *display, XCBCookie cookie)
     XCBGenericError *err = NULL;
     XCBGeometry *reply = NULL;
     const xcb_get_geometry_cookie_t cookie1 = { .sequence = cookie.sequence };
-    reply = xcb_get_geometry_reply(display, cookie1, &err);
+    _BLOCK(reply = xcb_get_geometry_reply(display, cookie1, &err));
     if(err)
     {   
         _xcb_err_handler(display, err);
@@ -608,8 +968,9 @@ XCBGetGeometryReply(
 XCBCookie
 XCBInternAtomCookie(XCBDisplay *display, const char *name, int only_if_exists)
 {
+    _REQ(8 + _PAD4(strlen(name)));
     const xcb_intern_atom_cookie_t cookie = xcb_intern_atom(display, only_if_exists, strlen(name), name);
-    return (XCBCookie) { .sequence = cookie.sequence };
+    return _TRACK((XCBCookie) { .sequence = cookie.sequence }, 0);
 }
 
 XCBAtom
@@ -617,7 +978,8 @@ XCBInternAtomReply(XCBDisplay *display, XCBCookie cookie)
 {
     XCBGenericError *err = NULL;
     const xcb_intern_atom_cookie_t cookie1 = { .sequence = cookie.sequence };
-    xcb_intern_atom_reply_t *reply = xcb_intern_atom_reply(display, cookie1, &err);
+    xcb_intern_atom_reply_t *reply = NULL;
+    _BLOCK(reply = xcb_intern_atom_reply(display, cookie1, &err));
     if(err)
     {
         _xcb_err_handler(display, err);
@@ -636,8 +998,9 @@ XCBGetTransientForHintCookie(
         XCBDisplay *display, 
         XCBWindow win)
 {
+    _REQ(24);
     xcb_get_property_cookie_t cookie = xcb_icccm_get_wm_transient_for(display, win);
-    return (XCBCookie) { .sequence = cookie.sequence };
+    return _TRACK((XCBCookie) { .sequence = cookie.sequence }, win);
 }
 
 u8
@@ -649,7 +1012,8 @@ XCBGetTransientForHintReply(
 {
     XCBGenericError *err = NULL;
     xcb_get_property_cookie_t cookie1 = { .sequence = cookie.sequence };
-    const u8 status = xcb_icccm_get_wm_transient_for_reply(display, cookie1, win, &err);
+    u8 status = 0;
+    _BLOCK(status = xcb_icccm_get_wm_transient_for_reply(display, cookie1, win, &err));
 
     if(err)
     {   _xcb_err_handler(display, err);
@@ -669,8 +1033,9 @@ XCBGetPropertyCookie(
         XCBAtom req_type
         )
 {
+    _REQ(24);
     const xcb_get_property_cookie_t cookie = xcb_get_property(display, _delete, window, property, req_type, long_offset, long_length);
-    return (XCBCookie) {.sequence = cookie.sequence };
+    return _TRACK((XCBCookie) {.sequence = cookie.sequence }, window);
 }
 
 XCBCookie 
@@ -684,8 +1049,9 @@ XCBGetWindowPropertyCookie(
         XCBAtom req_type
         )
 {
+    _REQ(24);
     const xcb_get_property_cookie_t cookie = xcb_get_property(display, _delete, window, property, req_type, long_offset, long_length);
-    return (XCBCookie) {.sequence = cookie.sequence };
+    return _TRACK((XCBCookie) {.sequence = cookie.sequence }, window);
 }
 
 XCBWindowProperty *
@@ -696,7 +1062,8 @@ XCBGetWindowPropertyReply(
 {
     XCBGenericError *err = NULL;
     const xcb_get_property_cookie_t cookie1 = { .sequence = cookie.sequence };
-    xcb_get_property_reply_t *reply = xcb_get_property_reply(display, cookie1, &err);
+    xcb_get_property_reply_t *reply = NULL;
+    _BLOCK(reply = xcb_get_property_reply(display, cookie1, &err));
     if(err)
     {
         _xcb_err_handler(display, err);
@@ -734,7 +1101,8 @@ XCBGetPropertyReply(
 {
     XCBGenericError *err = NULL;
     const xcb_get_property_cookie_t cookie1 = { .sequence = cookie.sequence };
-    xcb_get_property_reply_t *reply = xcb_get_property_reply(display, cookie1, &err);
+    xcb_get_property_reply_t *reply = NULL;
+    _BLOCK(reply = xcb_get_property_reply(display, cookie1, &err));
     if(err)
     {
         _xcb_err_handler(display, err);
@@ -773,6 +1141,7 @@ XCBGetPropertyValueLength(
 XCBPixmap
 XCBCreatePixmap(XCBDisplay *display, XCBWindow root, u16 width, u16 height, u8 depth)
 {
+    _REQ(16);
     const XCBPixmap id = xcb_generate_id(display);
 
 #ifdef DBG
@@ -781,7 +1150,7 @@ XCBCreatePixmap(XCBDisplay *display, XCBWindow root, u16 width, u16 height, u8 d
     return id;
 #endif
 
-    xcb_create_pixmap(display, depth, id, root, width, height);
+    _TRACK(xcb_create_pixmap(display, depth, id, root, width, height), id);
     return id;
 }
 
@@ -790,6 +1159,7 @@ XCBCreatePixmap(XCBDisplay *display, XCBWindow root, u16 width, u16 height, u8 d
 XCBCursor
 XCBCreateFontCursor(XCBDisplay *display, int shape)
 {
+    _REQ(12 + _PAD4(6) + 32);
     /* FORMAT IN RGB: (AKA RED GREEN BLUE) */
     /* fg = foreground; bg = background */
     const u16 fgred = 0;
@@ -803,7 +1173,7 @@ XCBCreateFontCursor(XCBDisplay *display, int shape)
     const xcb_font_t font = xcb_generate_id(display);
     const u8 strlenofcursor = 6;    /* X only reads data for those 6 chars so no need for +1 for the \0 character */
 
-    xcb_open_font(display, font, strlenofcursor, "cursor");
+    _TRACK(xcb_open_font(display, font, strlenofcursor, "cursor"), font);
 
     const xcb_cursor_t id = xcb_generate_id(display);
 
@@ -816,33 +1186,36 @@ XCBCreateFontCursor(XCBDisplay *display, int shape)
     return id;
 #endif
 
-    xcb_create_glyph_cursor(display, id, font, font, shape, shape + 1,
+    _TRACK(xcb_create_glyph_cursor(display, id, font, font, shape, shape + 1,
                             fgred, fggreen, fgblue,
-                            bgred, bggreen, bgblue);
+                            bgred, bggreen, bgblue), id);
     return id;
 }
 
 XCBCookie
 XCBFreeCursor(XCBDisplay *display, XCBCursor cursor)
 {
-    return xcb_free_cursor(display, cursor);
+    _REQ(8);
+    return _TRACK(xcb_free_cursor(display, cursor), cursor);
 }
 
 XCBCookie
 XCBDefineCursor(XCBDisplay *display, XCBWindow window, XCBCursor id)
 {   
+    _REQ(12 + 4);
     const u32 mask = XCB_CW_CURSOR;
 #if DBG
     XCBCookie cookie = xcb_change_window_attributes_checked(display, window, mask, &id);
     ck(display, cookie, _fn);
     return cookie;
 #endif
-    return xcb_change_window_attributes(display, window, mask, &id);
+    return _TRACK(xcb_change_window_attributes(display, window, mask, &id), window);
 }
 
 XCBCookie
 XCBOpenFont(XCBDisplay *display, XCBFont id, const char *name)
 {
+    _REQ(12 + _PAD4(strlen(name)));
     const u16 len = strlen(name);
 
 #if DBG
@@ -851,13 +1224,14 @@ XCBOpenFont(XCBDisplay *display, XCBFont id, const char *name)
     return cookie;
 #endif
 
-    return xcb_open_font(display, id, len, name);
+    return _TRACK(xcb_open_font(display, id, len, name), id);
 }
 
 XCBCookie
 XCBCloseFont(XCBDisplay *display, XCBFont id)
 {
-    return xcb_close_font(display, id);
+    _REQ(8);
+    return _TRACK(xcb_close_font(display, id), id);
 }
 
 
@@ -866,8 +1240,9 @@ XCBCloseFont(XCBDisplay *display, XCBFont id)
 XCBCookie
 XCBGetTextPropertyCookie(XCBDisplay *display, XCBWindow window, XCBAtom property)
 {
+    _REQ(24);
     const xcb_get_property_cookie_t cookie = xcb_icccm_get_text_property(display, window, property);
-    return (XCBCookie) {.sequence = cookie.sequence };
+    return _TRACK((XCBCookie) {.sequence = cookie.sequence }, window);
 }
 
 int 
@@ -876,7 +1251,7 @@ XCBGetTextPropertyReply(XCBDisplay *display, XCBCookie cookie, XCBTextProperty *
     XCBGenericError *err = NULL;
     int status = 0;
     const xcb_get_property_cookie_t cookie1 = { .sequence = cookie.sequence };
-    status = xcb_icccm_get_text_property_reply(display, cookie1, reply_return, &err);
+    _BLOCK(status = xcb_icccm_get_text_property_reply(display, cookie1, reply_return, &err));
     if(err)
     {   
         _xcb_err_handler(display, err);
@@ -1151,13 +1526,14 @@ XCBErrorDisplayText(
 XCBCookie
 XCBAllowEvents(XCBDisplay *display, u8 mode, XCBTimestamp tim)
 {
+    _REQ(8);
 #if DBG
     XCBCookie cookie = xcb_allow_events_checked(display, mode, tim);
     ck(display, cookie, _fn);
     return cookie;
 #endif
 
-    return xcb_allow_events(display, mode, tim);
+    return _TRACK(xcb_allow_events(display, mode, tim), 0);
 }
 
 XCBCookie
@@ -1169,7 +1545,8 @@ XCBSendEvent(
         const char *event
         )
 {
-    return xcb_send_event(display, propagate, window, event_mask, event);
+    _REQ(44);
+    return _TRACK(xcb_send_event(display, propagate, window, event_mask, event), window);
 }
 
 int 
@@ -1248,7 +1625,8 @@ XCBWaitForReply(
         )
 {
     XCBGenericError *err = NULL;
-    void *reply = xcb_wait_for_reply(display, cookie.sequence, &err);
+    void *reply = NULL;
+    _BLOCK(reply = xcb_wait_for_reply(display, cookie.sequence, &err));
     if(err)
     {   
         _xcb_err_handler(display, err);
@@ -1267,7 +1645,8 @@ XCBWaitForReply64(
         )
 {
     XCBGenericError *err = NULL;
-    void *reply = xcb_wait_for_reply64(display, cookie.sequence, &err);
+    void *reply = NULL;
+    _BLOCK(reply = xcb_wait_for_reply64(display, cookie.sequence, &err));
     if(err)
     {   
         _xcb_err_handler(display, err);
@@ -1289,8 +1668,9 @@ XCBGrabKeyboardCookie(
         XCBTimestamp tim
         )
 {
+    _REQ(16);
     const xcb_grab_keyboard_cookie_t cookie = xcb_grab_keyboard(display, owner_events, grab_window, tim, pointer_mode, keyboard_mode);
-    return (XCBCookie) {.sequence = cookie.sequence };
+    return _TRACK((XCBCookie) {.sequence = cookie.sequence }, grab_window);
 }
 
 XCBGrabKeyboard *
@@ -1301,7 +1681,8 @@ XCBGrabKeyboardReply(
 {
     XCBGenericError *err = NULL;
     const xcb_grab_keyboard_cookie_t cookie1 = { .sequence = cookie.sequence };
-    XCBGrabKeyboard *reply = xcb_grab_keyboard_reply(display, cookie1, &err);
+    XCBGrabKeyboard *reply = NULL;
+    _BLOCK(reply = xcb_grab_keyboard_reply(display, cookie1, &err));
 
     if(err)
     {
@@ -1318,49 +1699,79 @@ XCBUngrabKeyboard(
         XCBTimestamp tim
         )
 {
+    _REQ(8);
 #if DBG
     XCBCookie cookie = xcb_ungrab_keyboard_checked(display, tim);
     ck(display, cookie, _fn);
     return cookie;
 #endif
 
-    return xcb_ungrab_keyboard(display, tim);
+    return _TRACK(xcb_ungrab_keyboard(display, tim), 0);
+}
+
+XCBCookie
+XCBGrabServer(XCBDisplay *display)
+{
+    _REQ(4);
+#if DBG
+    XCBCookie cookie = xcb_grab_server_checked(display);
+    ck(display, cookie, _fn);
+    return cookie;
+#endif
+
+    return _TRACK(xcb_grab_server(display), 0);
+}
+
+XCBCookie
+XCBUngrabServer(XCBDisplay *display)
+{
+    _REQ(4);
+#if DBG
+    XCBCookie cookie = xcb_ungrab_server_checked(display);
+    ck(display, cookie, _fn);
+    return cookie;
+#endif
+
+    return _TRACK(xcb_ungrab_server(display), 0);
 }
 
 XCBCookie
 XCBGrabKey(XCBDisplay *display, XCBKeyCode keycode, u16 modifiers, XCBWindow grab_window, u8 owner_events, u8 pointer_mode, u8 keyboard_mode)
 {
+    _REQ(16);
 #if DBG
     XCBCookie cookie = xcb_grab_key_checked(display, owner_events, grab_window, modifiers, keycode, pointer_mode, keyboard_mode);
     ck(display, cookie, _fn);
     return cookie;
 #endif
 
-    return xcb_grab_key(display, owner_events, grab_window, modifiers, keycode, pointer_mode, keyboard_mode);
+    return _TRACK(xcb_grab_key(display, owner_events, grab_window, modifiers, keycode, pointer_mode, keyboard_mode), grab_window);
 }
 
 XCBCookie 
 XCBUngrabKey(XCBDisplay *display, XCBKeyCode key, u16 modifiers, XCBWindow grab_window)
 {
+    _REQ(12);
 #if DBG
     XCBCookie cookie = xcb_ungrab_key_checked(display, key, grab_window, modifiers);
     ck(display, cookie, _fn);
     return cookie;
 #endif
 
-    return xcb_ungrab_key(display, key, grab_window, modifiers);
+    return _TRACK(xcb_ungrab_key(display, key, grab_window, modifiers), grab_window);
 }
 
 XCBCookie
 XCBUngrabButton(XCBDisplay *display, uint8_t button, uint16_t modifier, XCBWindow window)
 {
+    _REQ(12);
 #if DBG
     XCBCookie cookie = xcb_ungrab_button_checked(display, button, window, modifier);
     ck(display, cookie, _fn);
     return cookie;
 #endif
 
-    return xcb_ungrab_button(display, button, window, modifier);
+    return _TRACK(xcb_ungrab_button(display, button, window, modifier), window);
 }
 
 XCBCookie
@@ -1376,13 +1787,14 @@ XCBGrabButton(
         XCBWindow confine_to,
         XCBCursor cursor)
 {
+    _REQ(24);
 #if DBG
     XCBCookie cookie = xcb_grab_button_checked(display, owner_events, grab_window, event_mask, pointer_mode, keyboard_mode, confine_to, cursor, button, modifiers);
     ck(display, cookie, _fn);
     return cookie;
 #endif
 
-    return xcb_grab_button(display, owner_events, grab_window, event_mask, pointer_mode, keyboard_mode, confine_to, cursor, button, modifiers);
+    return _TRACK(xcb_grab_button(display, owner_events, grab_window, event_mask, pointer_mode, keyboard_mode, confine_to, cursor, button, modifiers), grab_window);
 }
 
 XCBCookie
@@ -1398,11 +1810,12 @@ XCBGrabPointerCookie(
         XCBTimestamp tim
         )
 {
+    _REQ(24);
     xcb_grab_pointer_cookie_t cookie = xcb_grab_pointer(
             display, owner_events, grab_window, event_mask, pointer_mode, keyboard_mode, confine_to, cursor, tim
             );
 
-    return (XCBCookie) { .sequence = cookie.sequence };
+    return _TRACK((XCBCookie) { .sequence = cookie.sequence }, grab_window);
 
 }
 
@@ -1414,7 +1827,8 @@ XCBGrabPointerReply(
 {
     const xcb_grab_pointer_cookie_t cookie1 = { .sequence = cookie.sequence };
     XCBGenericError *err = NULL;
-    xcb_grab_pointer_reply_t *reply = xcb_grab_pointer_reply(display, cookie1, &err);
+    xcb_grab_pointer_reply_t *reply = NULL;
+    _BLOCK(reply = xcb_grab_pointer_reply(display, cookie1, &err));
     if(err)
     {   
         _xcb_err_handler(display, err);
@@ -1427,6 +1841,24 @@ XCBGrabPointerReply(
 
 }
 
+XCBCookie
+XCBChangeActivePointerGrab(
+        XCBDisplay *display,
+        XCBCursor cursor,
+        XCBTimestamp tim,
+        uint16_t event_mask
+        )
+{
+    _REQ(16);
+#if DBG
+    XCBCookie cookie = xcb_change_active_pointer_grab_checked(display, cursor, tim, event_mask);
+    ck(display, cookie, _fn);
+    return cookie;
+#endif
+
+    return _TRACK(xcb_change_active_pointer_grab(display, cursor, tim, event_mask), 0);
+}
+
 
 int
 XCBDisplayKeyCodes(XCBDisplay *display, int *min_keycode_return, int *max_keycode_return)
@@ -1449,13 +1881,14 @@ XCBDisplayKeycodes(XCBDisplay *display, int *min_keycode_return, int *max_keycod
 XCBKeyCode *
 XCBGetKeyCodes(XCBDisplay *display, XCBKeysym keysym)
 {
+    _REQ(8);
     xcb_key_symbols_t *keysyms;
 	xcb_keycode_t *keycode;
 
 	if (!(keysyms = xcb_key_symbols_alloc(display)))
 		return NULL;
 
-	keycode = xcb_key_symbols_get_keycode(keysyms, keysym);
+	_BLOCK(keycode = xcb_key_symbols_get_keycode(keysyms, keysym));
 	xcb_key_symbols_free(keysyms);
 
 	return keycode;
@@ -1497,6 +1930,7 @@ XCBKeySymbolsGetKeySym(
 XCBKeySymbols *
 XCBKeySymbolsAlloc(XCBDisplay *display)
 {
+    _REQ(8);
     return xcb_key_symbols_alloc(display);
 }
 
@@ -1517,8 +1951,9 @@ XCBRefreshKeyboardMapping(
 XCBCookie
 XCBGetKeyboardMappingCookie(XCBDisplay *display, XCBKeyCode first_keycode, u8 count)
 {
+    _REQ(8);
     const xcb_get_keyboard_mapping_cookie_t cookie = xcb_get_keyboard_mapping(display, first_keycode, count);
-    return (XCBCookie) { .sequence = cookie.sequence };
+    return _TRACK((XCBCookie) { .sequence = cookie.sequence }, 0);
 }
 
 XCBKeyboardMapping *
@@ -1526,7 +1961,8 @@ XCBGetKeyboardMappingReply(XCBDisplay *display, XCBCookie cookie)
 {
     XCBGenericError *err = NULL;
     const xcb_get_keyboard_mapping_cookie_t cookie1 = { .sequence = cookie.sequence };
-    XCBKeyboardMapping *reply = xcb_get_keyboard_mapping_reply(display, cookie1, &err);
+    XCBKeyboardMapping *reply = NULL;
+    _BLOCK(reply = xcb_get_keyboard_mapping_reply(display, cookie1, &err));
     if(err)
     {   
         _xcb_err_handler(display, err);
@@ -1538,14 +1974,47 @@ XCBGetKeyboardMappingReply(XCBDisplay *display, XCBCookie cookie)
     return reply;
 }
 
+XCBCookie
+XCBGetModifierMappingCookie(XCBDisplay *display)
+{
+    _REQ(4);
+    const xcb_get_modifier_mapping_cookie_t cookie = xcb_get_modifier_mapping(display);
+    return _TRACK((XCBCookie) { .sequence = cookie.sequence }, 0);
+}
+
+XCBKeyboardModifier *
+XCBGetModifierMappingReply(XCBDisplay *display, XCBCookie cookie)
+{
+    XCBGenericError *err = NULL;
+    const xcb_get_modifier_mapping_cookie_t cookie1 = { .sequence = cookie.sequence };
+    XCBKeyboardModifier *reply = NULL;
+    _BLOCK(reply = xcb_get_modifier_mapping_reply(display, cookie1, &err));
+    if(err)
+    {   
+        _xcb_err_handler(display, err);
+        if(reply)
+        {   free(reply);
+        }
+        return NULL;
+    }
+    return reply;
+}
+
+XCBKeyCode *
+XCBGetModifierMappingKeyCodes(XCBKeyboardModifier *reply)
+{
+    return xcb_get_modifier_mapping_keycodes(reply);
+}
+
 XCBCookie
 XCBQueryTreeCookie(
         XCBDisplay *display,
         XCBWindow window
         )
 {
+    _REQ(8);
     const xcb_query_tree_cookie_t cookie = xcb_query_tree(display, window);
-    return (XCBCookie) { .sequence = cookie.sequence };
+    return _TRACK((XCBCookie) { .sequence = cookie.sequence }, window);
 }
 
 XCBQueryTree *
@@ -1553,7 +2022,8 @@ XCBQueryTreeReply(XCBDisplay *display, XCBCookie cookie)
 {
     const xcb_query_tree_cookie_t cookie1 = { .sequence = cookie.sequence };
     XCBGenericError *err = NULL;
-    xcb_query_tree_reply_t *reply = xcb_query_tree_reply(display, cookie1, &err);
+    xcb_query_tree_reply_t *reply = NULL;
+    _BLOCK(reply = xcb_query_tree_reply(display, cookie1, &err));
     if(err)
     {   
         _xcb_err_handler(display, err);
@@ -1576,8 +2046,9 @@ XCBQueryTreeChildren(const XCBQueryTree *tree)
 XCBCookie
 XCBQueryPointerCookie(XCBDisplay *display, XCBWindow window)
 {
+    _REQ(8);
     const xcb_query_pointer_cookie_t cookie = xcb_query_pointer(display, window);
-    return (XCBCookie) { .sequence = cookie.sequence };
+    return _TRACK((XCBCookie) { .sequence = cookie.sequence }, window);
 }
 
 XCBQueryPointer *
@@ -1585,7 +2056,8 @@ XCBQueryPointerReply(XCBDisplay *display, XCBCookie cookie)
 {
     XCBGenericError *err = NULL;
     const xcb_query_pointer_cookie_t cookie1 = { .sequence = cookie.sequence };
-    XCBQueryPointer *reply = xcb_query_pointer_reply(display, cookie1, &err);
+    XCBQueryPointer *reply = NULL;
+    _BLOCK(reply = xcb_query_pointer_reply(display, cookie1, &err));
     if(err)
     {   
         _xcb_err_handler(display, err);
@@ -1601,13 +2073,14 @@ XCBQueryPointerReply(XCBDisplay *display, XCBCookie cookie)
 XCBCookie
 XCBMapWindow(XCBDisplay *display, XCBWindow window)
 {
+    _REQ(8);
 #if DBG
     XCBCookie cookie = xcb_map_window_checked(display, window);
     ck(display, cookie, _fn);
     return cookie;
 #endif
 
-    return xcb_map_window(display, window);
+    return _TRACK(xcb_map_window(display, window), window);
 }
 
 
@@ -1617,12 +2090,13 @@ XCBUnmapWindow(
         XCBWindow window
         )
 {
+    _REQ(8);
 #if DBG
     XCBCookie cookie = xcb_unmap_window_checked(display, window);
     ck(display, cookie, _fn);
     return cookie;
 #endif
-    return xcb_unmap_window(display, window);
+    return _TRACK(xcb_unmap_window(display, window), window);
 }
 
 
@@ -1632,12 +2106,28 @@ XCBDestroyWindow(
         XCBWindow window
         )
 {
+    _REQ(8);
 #if DBG
     XCBCookie cookie = xcb_destroy_window_checked(display, window);
     ck(display, cookie, _fn);
     return cookie;
 #endif
-    return xcb_destroy_window(display, window);
+    return _TRACK(xcb_destroy_window(display, window), window);
+}
+
+XCBCookie
+XCBKillClient(
+        XCBDisplay *display,
+        XCBWindow resource
+        )
+{
+    _REQ(8);
+#if DBG
+    XCBCookie cookie = xcb_kill_client_checked(display, resource);
+    ck(display, cookie, _fn);
+    return cookie;
+#endif
+    return _TRACK(xcb_kill_client(display, resource), resource);
 }
 
 XCBWindow 
@@ -1655,19 +2145,19 @@ XCBCreateWindow(
         u32 valuemask, 
         const u32 *value_list)
 {
+    _REQ(32 + 4 * __builtin_popcount(valuemask));
     const XCBWindow id = xcb_generate_id(display);
-    const void *used = NULL;
 
 
 #if DBG
     XCBCookie cookie = xcb_create_window_checked(display, depth, id, parent, x, y, width, height, border_width, 
-    class, visual, valuemask, used);
+    class, visual, valuemask, value_list);
     ck(display, cookie, _fn);
     return id;
 #endif
 
-    xcb_create_window(display, depth, id, parent, x, y, width, height, border_width, 
-    class, visual, valuemask, used);
+    _TRACK(xcb_create_window(display, depth, id, parent, x, y, width, height, border_width, 
+    class, visual, valuemask, value_list), id);
     return id;
 }
 
@@ -1684,6 +2174,7 @@ XCBCreateSimpleWindow(
         uint32_t background_color
         )
 {
+    _REQ(32 + 8);
     const XCBWindow id = xcb_generate_id(display);
     const u8 depth = XCB_COPY_FROM_PARENT;
     const XCBVisual visual = XCBGetScreen(display)->root_visual;
@@ -1697,7 +2188,7 @@ XCBCreateSimpleWindow(
     return id;
 #endif
 
-    xcb_create_window(display, depth, id, parent, x, y, width, height, border_width, class, visual, mask, &color);
+    _TRACK(xcb_create_window(display, depth, id, parent, x, y, width, height, border_width, class, visual, mask, &color), id);
     return id;
 }
 
@@ -1706,6 +2197,7 @@ XCBGC
 XCBCreateGC(XCBDisplay *display, XCBDrawable drawable, 
 u32 valuemask, const void *valuelist)
 {
+    _REQ(16 + 4 * __builtin_popcount(valuemask));
     const XCBGC id = xcb_generate_id(display);
 
 #if DBG
@@ -1714,13 +2206,14 @@ u32 valuemask, const void *valuelist)
     return id;
 #endif
 
-    xcb_create_gc(display, id, drawable, valuemask, valuelist);
+    _TRACK(xcb_create_gc(display, id, drawable, valuemask, valuelist), id);
     return id;
 }
 
 int
 XCBSetLineAttributes(XCBDisplay *display, XCBGC gc, u32 linewidth, u32 linestyle, u32 capstyle, u32 joinstyle)
 {
+    _REQ(12 + 16);
     u32 gcvalist[4];
 
     u8 i = 0; /* This is the index; u8 just to save some bytes */
@@ -1746,7 +2239,7 @@ XCBSetLineAttributes(XCBDisplay *display, XCBGC gc, u32 linewidth, u32 linestyle
 
     /* This returns a cookie but changing the gc isnt doesnt really require a reply as you are directly manupulating your own gc
      */
-    xcb_change_gc(display, gc, mask, gcvalist);
+    _TRACK(xcb_change_gc(display, gc, mask, gcvalist), gc);
     /* X11 src/SetLStyle.c always returns 1 (for some reason) */
     return 1;
 }
@@ -1754,25 +2247,27 @@ XCBSetLineAttributes(XCBDisplay *display, XCBGC gc, u32 linewidth, u32 linestyle
 XCBCookie
 XCBChangeProperty(XCBDisplay *display, XCBWindow window, XCBAtom property, XCBAtom type, u8 format, u8 mode, const void *data, u32 nelements)
 {
+    _REQ(24 + _PAD4(nelements * (format / 8)));
 #if DBG
     XCBCookie cookie = xcb_change_property_checked(display, mode, window, property, type, format, nelements, data);
     ck(display, cookie, _fn);
     return cookie;
 #endif
 
-    return xcb_change_property(display, mode, window, property, type, format, nelements, data);
+    return _TRACK(xcb_change_property(display, mode, window, property, type, format, nelements, data), window);
 }
 
 XCBCookie
 XCBDeleteProperty(XCBDisplay *display, XCBWindow window, XCBAtom property)
 {
+    _REQ(12);
 #if DBG
     XCBCookie cookie = xcb_delete_property_checked(display, window, property);
     ck(display, cookie, _fn);
     return cookie;
 #endif
 
-    return xcb_delete_property(display, window, property);
+    return _TRACK(xcb_delete_property(display, window, property), window);
 }
 
 XCBCookie
@@ -1782,50 +2277,54 @@ XCBConfigureWindow(
         u16 value_mask,
         XCBWindowChanges *changes)
 {
+    _REQ(12 + 4 * __builtin_popcount(value_mask));
 #if DBG
     XCBCookie cookie = xcb_configure_window_aux_checked(display, window, value_mask, changes);
     ck(display, cookie, _fn);
     return cookie;
 #endif
 
-    return xcb_configure_window_aux(display, window, value_mask, changes);
+    return _TRACK(xcb_configure_window_aux(display, window, value_mask, changes), window);
 }
 
 XCBCookie
 XCBSetClassHint(XCBDisplay *display, XCBWindow window, const char *class_name)
 {
+    _REQ(24 + _PAD4(strlen(class_name)));
     const int len = strlen(class_name);
 #if DBG
     XCBCookie cookie = xcb_icccm_set_wm_class_checked(display, window, len, class_name);
     ck(display, cookie, _fn);
     return cookie;
 #endif
-    return xcb_icccm_set_wm_class(display, window, len, class_name);
+    return _TRACK(xcb_icccm_set_wm_class(display, window, len, class_name), window);
 }
 
 
 XCBCookie
 XCBChangeGC(XCBDisplay *display, XCBGC gc, u32 valuemask, const void *valuelist)
 {
+    _REQ(12 + 4 * __builtin_popcount(valuemask));
 #if DBG
     XCBCookie cookie = xcb_change_gc_checked(display, gc, valuemask, valuelist);
     ck(display, cookie, _fn);
     return cookie;
 #endif
 
-    return xcb_change_gc(display, gc, valuemask, valuelist);
+    return _TRACK(xcb_change_gc(display, gc, valuemask, valuelist), gc);
 }
 
 XCBCookie
 XCBDrawPoint(XCBDisplay *display, u8 coordinatemode, XCBDrawable drawable, XCBGC gc, uint32_t points_len, XCBPoint *points)
 {
+    _REQ(12 + 4 * points_len);
 #if DBG
     XCBCookie cookie = xcb_poly_point_checked(display, coordinatemode, drawable, gc, points_len, points);
     ck(display, cookie, _fn);
     return cookie;
 #endif
 
-    return xcb_poly_point(display, coordinatemode, drawable, gc, points_len, points);
+    return _TRACK(xcb_poly_point(display, coordinatemode, drawable, gc, points_len, points), drawable);
 }
 
 int
@@ -1963,8 +2462,9 @@ XCBGetWMProtocolsCookie(
         XCBWindow window, 
         XCBAtom protocol)
 {
+    _REQ(24);
     const xcb_get_property_cookie_t cookie = xcb_icccm_get_wm_protocols(display, window, protocol);
-    return (XCBCookie) { .sequence = cookie.sequence };
+    return _TRACK((XCBCookie) { .sequence = cookie.sequence }, window);
 }
 
 int
@@ -1976,7 +2476,8 @@ XCBGetWMProtocolsReply(
 {
     XCBGenericError *err = NULL;
     const xcb_get_property_cookie_t cookie1 = { .sequence = cookie.sequence };
-    const int ret = xcb_icccm_get_wm_protocols_reply(display, cookie1, protocol_return, &err);
+    int ret = 0;
+    _BLOCK(ret = xcb_icccm_get_wm_protocols_reply(display, cookie1, protocol_return, &err));
     if(err)
     {   
         _xcb_err_handler(display, err);
@@ -2000,8 +2501,9 @@ XCBGetWMHintsCookie(
         XCBWindow win
         )
 {
+    _REQ(24);
     xcb_get_property_cookie_t cookie = xcb_icccm_get_wm_hints(display, win);
-    return (XCBCookie) { .sequence = cookie.sequence };
+    return _TRACK((XCBCookie) { .sequence = cookie.sequence }, win);
 }
 
 XCBWMHints *
@@ -2013,7 +2515,8 @@ XCBGetWMHintsReply(
     XCBGenericError *err = NULL;
     xcb_get_property_cookie_t cookie1 = { .sequence = cookie.sequence };
 
-    xcb_get_property_reply_t *reply = xcb_get_property_reply(display, cookie1, &err);
+    xcb_get_property_reply_t *reply = NULL;
+    _BLOCK(reply = xcb_get_property_reply(display, cookie1, &err));
     XCBWMHints *data = NULL;
 
     /* error handling */
@@ -2068,7 +2571,8 @@ XCBSetWMHintsCookie(
         XCBWMHints *wmhints
         )
 {
-    return xcb_icccm_set_wm_hints(display, window, wmhints);
+    _REQ(24 + 36);
+    return _TRACK(xcb_icccm_set_wm_hints(display, window, wmhints), window);
 }
 
 XCBCookie
@@ -2077,8 +2581,9 @@ XCBGetWMNormalHintsCookie(
         XCBWindow win
         )
 {
+    _REQ(24);
     xcb_get_property_cookie_t cookie = xcb_icccm_get_wm_normal_hints(display, win);
-    return (XCBCookie) { .sequence = cookie.sequence };
+    return _TRACK((XCBCookie) { .sequence = cookie.sequence }, win);
 }
 
 uint8_t
@@ -2090,7 +2595,8 @@ XCBGetWMNormalHintsReply(
 {
     XCBGenericError *err = NULL;
     xcb_get_property_cookie_t cookie1 = { .sequence = cookie.sequence };
-    u8 status = xcb_icccm_get_wm_normal_hints_reply(display, cookie1, hints_return, &err);
+    u8 status = 0;
+    _BLOCK(status = xcb_icccm_get_wm_normal_hints_reply(display, cookie1, hints_return, &err));
 
     if(err)
     {   _xcb_err_handler(display, err);
@@ -2098,3 +2604,166 @@ XCBGetWMNormalHintsReply(
     }
     return status;
 }
+
+/* SYNC */
+
+uint8_t
+XCBSyncInit(
+        XCBDisplay *display)
+{
+    const xcb_query_extension_reply_t *ext = xcb_get_extension_data(display, &xcb_sync_id);
+    XCBGenericError *err = NULL;
+    xcb_sync_initialize_reply_t *rep;
+
+    if(!ext || !ext->present)
+    {   return 0;
+    }
+    _REQ(8);
+    const xcb_sync_initialize_cookie_t cookie = xcb_sync_initialize(display, 3, 1);
+    _BLOCK(rep = xcb_sync_initialize_reply(display, cookie, &err));
+    if(err)
+    {   
+        _xcb_err_handler(display, err);
+        return 0;
+    }
+    if(!rep)
+    {   return 0;
+    }
+    free(rep);
+    return ext->first_event;
+}
+
+XCBSyncAlarm
+XCBSyncCreateAlarm(
+        XCBDisplay *display)
+{
+    _REQ(12 + 4);
+    const XCBSyncAlarm id = xcb_generate_id(display);
+    const u32 mask = XCB_SYNC_CA_EVENTS;
+    const u32 events = 1;
+#if DBG
+    XCBCookie cookie = xcb_sync_create_alarm_checked(display, id, mask, &events);
+    ck(display, cookie, _fn);
+    return id;
+#endif
+    _TRACK(xcb_sync_create_alarm(display, id, mask, &events), 0);
+    return id;
+}
+
+XCBCookie
+XCBSyncChangeAlarm(
+        XCBDisplay *display,
+        XCBSyncAlarm alarm,
+        XCBSyncCounter counter,
+        uint64_t value)
+{
+    _REQ(12 + 4 * 8);
+    const u32 mask = XCB_SYNC_CA_COUNTER | XCB_SYNC_CA_VALUE_TYPE | XCB_SYNC_CA_VALUE
+                    | XCB_SYNC_CA_TEST_TYPE | XCB_SYNC_CA_DELTA | XCB_SYNC_CA_EVENTS;
+    /* in mask bit order, 64 bit values are hi then lo. A zero delta makes the alarm inactive after it triggers */
+    const u32 values[] = 
+    {
+        counter,
+        XCB_SYNC_VALUETYPE_ABSOLUTE,
+        value >> 32, value & UINT32_MAX,
+        XCB_SYNC_TESTTYPE_POSITIVE_COMPARISON,
+        0, 0,
+        1
+    };
+#if DBG
+    XCBCookie cookie = xcb_sync_change_alarm_checked(display, alarm, mask, values);
+    ck(display, cookie, _fn);
+    return cookie;
+#endif
+    return _TRACK(xcb_sync_change_alarm(display, alarm, mask, values), 0);
+}
+
+XCBCookie
+XCBSyncDestroyAlarm(
+        XCBDisplay *display,
+        XCBSyncAlarm alarm)
+{
+    _REQ(8);
+#if DBG
+    XCBCookie cookie = xcb_sync_destroy_alarm_checked(display, alarm);
+    ck(display, cookie, _fn);
+    return cookie;
+#endif
+    return _TRACK(xcb_sync_destroy_alarm(display, alarm), 0);
+}
+
+XCBCookie
+XCBSyncQueryCounterCookie(
+        XCBDisplay *display,
+        XCBSyncCounter counter)
+{
+    _REQ(8);
+    const xcb_sync_query_counter_cookie_t cookie = xcb_sync_query_counter(display, counter);
+    return _TRACK((XCBCookie) {.sequence = cookie.sequence }, 0);
+}
+
+uint8_t
+XCBSyncQueryCounterReply(
+        XCBDisplay *display,
+        XCBCookie cookie,
+        int64_t *value_return)
+{
+    XCBGenericError *err = NULL;
+    const xcb_sync_query_counter_cookie_t cookie1 = { .sequence = cookie.sequence };
+    XCBSyncQueryCounter *reply = NULL;
+    _BLOCK(reply = xcb_sync_query_counter_reply(display, cookie1, &err));
+
+    if(err)
+    {
+        _xcb_err_handler(display, err);
+        free(reply);
+        return 0;
+    }
+    if(!reply)
+    {   return 0;
+    }
+    *value_return = (int64_t)(((uint64_t)(uint32_t)reply->counter_value.hi << 32) | reply->counter_value.lo);
+    free(reply);
+    return 1;
+}
+
+/* XKB */
+
+uint8_t
+XCBSetDetectableAutoRepeat(
+        XCBDisplay *display,
+        uint8_t state)
+{
+    const xcb_query_extension_reply_t *ext = xcb_get_extension_data(display, &xcb_xkb_id);
+    const u32 flag = XCB_XKB_PER_CLIENT_FLAG_DETECTABLE_AUTO_REPEAT;
+    XCBGenericError *err = NULL;
+    xcb_xkb_use_extension_reply_t *use;
+    xcb_xkb_per_client_flags_reply_t *flags;
+    u8 ret = 0;
+
+    if(!ext || !ext->present)
+    {   return 0;
+    }
+    /* both go out before waiting, per client flags need the extension enabled first */
+    _REQ(8);
+    const xcb_xkb_use_extension_cookie_t usecookie = xcb_xkb_use_extension(display, XCB_XKB_MAJOR_VERSION, XCB_XKB_MINOR_VERSION);
+    _REQ(28);
+    const xcb_xkb_per_client_flags_cookie_t flagscookie = xcb_xkb_per_client_flags(display, XCB_XKB_ID_USE_CORE_KBD, flag, state ? flag : 0, 0, 0, 0);
+
+    _BLOCK(use = xcb_xkb_use_extension_reply(display, usecookie, &err));
+    if(err)
+    {   
+        _xcb_err_handler(display, err);
+        err = NULL;
+    }
+    _BLOCK(flags = xcb_xkb_per_client_flags_reply(display, flagscookie, &err));
+    if(err)
+    {   _xcb_err_handler(display, err);
+    }
+    if(use && use->supported && flags && (flags->supported & flag))
+    {   ret = !!(flags->value & flag) == !!state;
+    }
+    free(use);
+    free(flags);
+    return ret;
+}
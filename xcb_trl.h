@@ -328,8 +328,12 @@
 #include <xcb/xcb_keysyms.h>
 #include <xcb/xcb_cursor.h>
 #include <xcb/xinerama.h>
+#include <xcb/sync.h>
+#include <xcb/xkb.h>
 #include <xcb/xcb_xrm.h>
 
+#include <stdio.h>
+
 
 
 
@@ -346,6 +350,13 @@
 
 
 
+#define XCB_TRL_DEBUG_ASYNC         1           /* Only used when XCB_TRL_ENABLE_DEBUG is enabled.
+                                                 * 1: Requests stay unchecked (release level pipelining), each one is recorded in a ring
+                                                 *    of (sequence, wrapper, scope, caller, window) and errors arriving later through the
+                                                 *    event queue or a reply are matched back to their origin, see XCBErrorOrigin().
+                                                 * 0: Every request is checked as it is made, this costs a round trip per request.
+                                                 */
+
 #ifdef XCB_TRL_ENABLE_DEBUG
     #if XCB_TRL_ENABLE_DEBUG != 0
         /* if you want to pause execution right as we hit something and just check whatever is next you are free to do so */
@@ -353,6 +364,45 @@
     #endif
 #endif
 
+#define XCB_TRL_ENABLE_STATS        1           /* This enables per wrapper request accounting.
+                                                 * Every wrapper counts the requests it issued, the bytes it queued,
+                                                 * the replies it had to block for, and how long it blocked (ns).
+                                                 * Counters are attributed to the current scope, see XCB_TRL_SCOPE().
+                                                 * The cost is a table lookup per request and a clock read per blocking reply,
+                                                 * so this is cheap enough to leave on in release builds.
+                                                 */
+
+#ifdef XCB_TRL_ENABLE_STATS
+    #if XCB_TRL_ENABLE_STATS != 0
+        /* Attributes every request made until the end of the current function to that function (by name).
+         * Nested scopes take precedence, the previous scope is restored when the function returns.
+         * Place it at the top of a function, once.
+         */
+        #define XCB_TRL_SCOPE()     const char *_xcb_trl_scope __attribute__((cleanup(XCBStatsLeave))) = XCBStatsEnter(__func__)
+    #endif
+#endif
+
+#ifndef XCB_TRL_SCOPE
+    #define XCB_TRL_SCOPE()
+#endif
+
+#define XCB_TRL_ENABLE_HOT_CHECK    0           /* This enables the hot path check (debug/CI).
+                                                 * Functions tagged with XCB_TRL_HOT_SCOPE() must never wait on the XServer,
+                                                 * any blocking reply or sync made while one is on the stack is reported
+                                                 * with a backtrace (glibc) or aborts, see XCBSetHotPolicy().
+                                                 */
+
+#ifdef XCB_TRL_ENABLE_HOT_CHECK
+    #if XCB_TRL_ENABLE_HOT_CHECK != 0
+        /* Same as XCB_TRL_SCOPE() but also marks the function as latency critical until it returns. */
+        #define XCB_TRL_HOT_SCOPE() XCB_TRL_SCOPE(); const char *_xcb_trl_hot __attribute__((cleanup(XCBHotLeave))) = XCBHotEnter(__func__)
+    #endif
+#endif
+
+#ifndef XCB_TRL_HOT_SCOPE
+    #define XCB_TRL_HOT_SCOPE() XCB_TRL_SCOPE()
+#endif
+
 /* Ghosts */
 
 
@@ -407,6 +457,8 @@ typedef xcb_time_t XCBTime;
 typedef xcb_timestamp_t XCBTimestamp;
 typedef xcb_client_message_data_t  XCBClientMessageData;
 typedef xcb_get_property_reply_t XCBWindowProperty;
+typedef struct XCBStats XCBStats;
+typedef struct XCBRequestOrigin XCBRequestOrigin;
 
 /* Analagous to Xlib's XA_(type)
  * XCB_ATOM_NONE = 0,
@@ -521,6 +573,13 @@ typedef xcb_xinerama_is_active_reply_t XCBXineramaIsActive;
 
 typedef xcb_xinerama_query_screens_reply_t XCBXineramaQueryScreens;
 
+/* Sync */
+
+typedef xcb_sync_alarm_t XCBSyncAlarm;
+typedef xcb_sync_counter_t XCBSyncCounter;
+typedef xcb_sync_alarm_notify_event_t XCBSyncAlarmNotifyEvent;
+typedef xcb_sync_query_counter_reply_t XCBSyncQueryCounter;
+
 
 
 /* events */
@@ -569,6 +628,32 @@ struct XCBCookie64
 {   uint64_t sequence;
 };
 
+struct XCBRequestOrigin
+{
+    uint32_t sequence;          /* Full sequence number of the request          */
+    XCBWindow window;           /* Resource the request was made on, may be 0   */
+    const char *wrapper;        /* The XCB* function that made the request      */
+    const char *scope;          /* Scope it was called from, see XCB_TRL_SCOPE()*/
+    void *caller;               /* Return address into the caller of wrapper    */
+};
+
+struct XCBStats
+{
+    const char *wrapper;        /* The XCB* function that issued the requests   */
+    const char *scope;          /* The scope it was called from, may be NULL    */
+    uint64_t requests;          /* Requests sent                                */
+    uint64_t bytes;             /* Bytes queued for those requests              */
+    uint64_t replies;           /* Replies we blocked for                       */
+    uint64_t blockns;           /* Time spent blocked for those replies (ns)    */
+};
+
+
+/* XCBSetHotPolicy() */
+enum
+{
+    XCB_TRL_HOT_LOG = 1 << 0,           /* Print the offending wrapper, hot function and a backtrace    */
+    XCB_TRL_HOT_ABORT = 1 << 1,         /* abort() after reporting                                      */
+};
 
 /* macros */
 enum
@@ -1123,6 +1208,27 @@ XCBCloseFont(
 
 
 
+/* Requests the keycodes bound to each of the 8 modifiers.
+ * RETURN: Cookie to request.
+ */
+XCBCookie
+XCBGetModifierMappingCookie(
+        XCBDisplay *display);
+
+/* NOTE: reply must be freed by caller.
+ * RETURN: XCBKeyboardModifier * on Success.
+ * RETURN: NULL on Failure.
+ */
+XCBKeyboardModifier *
+XCBGetModifierMappingReply(
+        XCBDisplay *display,
+        XCBCookie cookie);
+
+/* RETURN: keycodes_per_modifier * 8 keycodes, modifier major. */
+XCBKeyCode *
+XCBGetModifierMappingKeyCodes(
+        XCBKeyboardModifier *reply);
+
 XCBCookie
 XCBQueryTreeCookie(
         XCBDisplay *display,
@@ -1304,6 +1410,18 @@ int
 XCBSetErrorHandler(void (*error_handler)(XCBDisplay *, XCBGenericError *));
 
 
+/* Finds the request that caused err, usable from the error handler or when an error event (response_type 0) is received.
+ * Only requests made recently are remembered.
+ *
+ * NOTE: Only available when XCB_TRL_ENABLE_DEBUG and XCB_TRL_DEBUG_ASYNC are enabled.
+ * RETURN: 1 on Success, origin_return is filled.
+ * RETURN: 0 on Failure.
+ */
+int
+XCBErrorOrigin(
+        XCBGenericError *err,
+        XCBRequestOrigin *origin_return);
+
 /* not implemented */
 void 
 XCBSetIOErrorHandler(
@@ -1652,6 +1770,25 @@ XCBUngrabKeyboard(
         XCBDisplay *display,
         XCBTimestamp tim
         );
+/* 
+ * Sends a Event to the XServer to stop processing requests from every other connection until XCBUngrabServer().
+ * Keep it short, nothing else can draw (or even connect) in the meantime.
+ *
+ * RETURN: Cookie to request.
+ */
+XCBCookie
+XCBGrabServer(
+        XCBDisplay *display
+        );
+/* 
+ * Sends a Event to the XServer to release the grab of XCBGrabServer().
+ *
+ * RETURN: Cookie to request.
+ */
+XCBCookie
+XCBUngrabServer(
+        XCBDisplay *display
+        );
 /*
  * key:             XCB_GRAB_ANY                Grab all possible key codes.
  *                  XCBKeyCode                  The keycode of the specified key combination.
@@ -1854,6 +1991,28 @@ XCBGrabPointerReply(
         XCBCookie cookie
         );
 
+/* Changes the event mask and cursor of the active pointer grab, no round trip needed.
+ * This is the way to get motion events out of the grab a passive button grab activated.
+ * Does nothing if the pointer is not grabbed by us.
+ *
+ * cursor:          XCB_NONE                    Dont change the cursor.
+ *                  XCBCursor                   Specifies the cursor that should be displayed.
+ *
+ * tim:             XCBTimestamp                Timestamp to avoid race conditions when running X over the network.
+ *                  XCB_CURRENT_TIME            Use the current time if avaible.
+ *
+ * event_mask:      XCB_EVENT_MASK_*            Pointer events reported while the grab is active.
+ *
+ * RETURN: Cookie to request.
+ */
+XCBCookie
+XCBChangeActivePointerGrab(
+        XCBDisplay *display,
+        XCBCursor cursor,
+        XCBTimestamp tim,
+        uint16_t event_mask
+        );
+
 
 /* Returns min-keycodes and max-keycodes supported by the specified display.
  * The minimum number of KeyCodes returned is never less than 8, and the maximum number of KeyCodes returned is never greater than 255. 
@@ -2077,6 +2236,17 @@ XCBDestroyWindow(
         XCBWindow window
         );
 
+/* Forces a close down of the client that created the resource specified.
+ * Its remaining resources (windows) are destroyed.
+ *
+ * RETURN: Cookie to request.
+ */
+XCBCookie
+XCBKillClient(
+        XCBDisplay *display,
+        XCBWindow resource
+        );
+
 /* windows*/
 XCBWindow 
 XCBCreateWindow(
@@ -2435,6 +2605,153 @@ XCBGetWMNormalHintsReply(
         );
 
 
+/* SYNC */
+
+/* Initializes the SYNC extension, must be called before any other XCBSync*() function.
+ *
+ * NOTE: Blocks on the extension query.
+ * RETURN: The first event code of the extension (add XCB_SYNC_ALARM_NOTIFY for AlarmNotify) on Success.
+ * RETURN: 0 if the extension is not supported.
+ */
+uint8_t
+XCBSyncInit(
+        XCBDisplay *display);
+
+/* Creates an inactive alarm that reports AlarmNotify events, see XCBSyncChangeAlarm().
+ *
+ * RETURN: The alarm id.
+ */
+XCBSyncAlarm
+XCBSyncCreateAlarm(
+        XCBDisplay *display);
+
+/* Arms alarm to trigger (once) when counter reaches value or already is past it.
+ * An AlarmNotify event is generated when it triggers.
+ *
+ * RETURN: Cookie to request.
+ */
+XCBCookie
+XCBSyncChangeAlarm(
+        XCBDisplay *display,
+        XCBSyncAlarm alarm,
+        XCBSyncCounter counter,
+        uint64_t value);
+
+XCBCookie
+XCBSyncDestroyAlarm(
+        XCBDisplay *display,
+        XCBSyncAlarm alarm);
+
+/* Asks for the current value of counter, see XCBSyncQueryCounterReply().
+ *
+ * RETURN: Cookie to request.
+ */
+XCBCookie
+XCBSyncQueryCounterCookie(
+        XCBDisplay *display,
+        XCBSyncCounter counter);
+
+/* NOTE: Blocks until the reply arrives.
+ * RETURN: 1 on Success, value_return is the counter's value.
+ * RETURN: 0 on Failure (the counter is gone).
+ */
+uint8_t
+XCBSyncQueryCounterReply(
+        XCBDisplay *display,
+        XCBCookie cookie,
+        int64_t *value_return);
+
+/* XKB */
+
+/* Turns XKB detectable autorepeat on or off for this client.
+ * While on, a held key repeats as KeyPress events without the KeyRelease events in between.
+ *
+ * NOTE: Blocks on the extension query and the replies.
+ * RETURN: 1 if the server supports it and it is now set to state.
+ * RETURN: 0 on Failure.
+ */
+uint8_t
+XCBSetDetectableAutoRepeat(
+        XCBDisplay *display,
+        uint8_t state);
+
+
+/* STATS */
+
+/* Sets the scope requests are attributed to.
+ * Prefer XCB_TRL_SCOPE() which restores the previous scope automatically.
+ *
+ * NOTE: scope must be a string literal or outlive the stats, (__func__ for example).
+ * RETURN: The previous scope.
+ */
+const char *
+XCBStatsEnter(
+        const char *scope);
+
+/* Restores the scope returned by XCBStatsEnter(). */
+void
+XCBStatsLeave(
+        const char **previous);
+
+/* Copies at most max entries (one per wrapper/scope pair) into stats_return.
+ *
+ * RETURN: Number of entries copied.
+ * RETURN: 0 if XCB_TRL_ENABLE_STATS is disabled.
+ */
+uint32_t
+XCBStatsGet(
+        XCBStats *stats_return,
+        uint32_t max);
+
+/* Sums every entry into total_return. */
+void
+XCBStatsTotal(
+        XCBStats *total_return);
+
+/* Clears every counter. */
+void
+XCBStatsReset(void);
+
+/* Writes every entry to file as tab separated values, one entry per line, with a header line.
+ * The last line is the total.
+ *
+ * RETURN: 1 on Success.
+ * RETURN: 0 on Failure.
+ */
+int
+XCBStatsDump(
+        FILE *file);
+
+
+/* HOT PATH */
+
+/* Marks hot as latency critical, see XCB_TRL_HOT_SCOPE().
+ * RETURN: The previous hot function, NULL if none.
+ */
+const char *
+XCBHotEnter(
+        const char *hot);
+
+/* Restores the hot function returned by XCBHotEnter(). */
+void
+XCBHotLeave(
+        const char **previous);
+
+/* Sets what happens when a hot path blocks, any of XCB_TRL_HOT_LOG, XCB_TRL_HOT_ABORT. 
+ * Default: XCB_TRL_HOT_LOG.
+ * NOTE: Does nothing if XCB_TRL_ENABLE_HOT_CHECK is disabled.
+ */
+void
+XCBSetHotPolicy(
+        uint8_t policy);
+
+/* RETURN: Number of blocking calls made inside hot paths so far.
+ * RETURN: 0 if XCB_TRL_ENABLE_HOT_CHECK is disabled.
+ */
+uint64_t
+XCBHotViolations(void);
+
+
 
 
 
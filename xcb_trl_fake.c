@@ -0,0 +1,2586 @@
+/**
+ * @file xcb_trl_fake.c
+ * In process fake XServer implementations.
+ */
+
+
+/* This is linked in place of xcb_trl.c (make fake), it does not talk to an XServer at all.
+ * Instead every request is applied to a small in memory model of the screen (windows, properties, focus, pointer)
+ * and written to a log, while events come from a script, see xcb_trl_fake.h for the script and log format.
+ * Replies are built when the cookie is made (like the XServer does) using the same layouts xcb uses,
+ * so the WM frees them the same way it would otherwise.
+ */
+
+
+#include "xcb_trl.h"
+#include "xcb_trl_fake.h"
+
+/* error codes */
+#include <X11/X.h>
+#include <X11/Xproto.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <inttypes.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+
+typedef uint8_t  u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+
+typedef int8_t   i8;
+typedef int16_t  i16;
+typedef int32_t  i32;
+typedef int64_t  i64;
+
+#define REQ(WINDOW, ...)    _fake_request(__func__, (WINDOW), __VA_ARGS__)
+#define BLOCK(COOKIE)       _fake_reply(__func__, (COOKIE))
+/* first event of the SYNC extension, as reported by XCBSyncInit() */
+#define SYNC_EVENT          90
+/* ms between the KeyPress's of a held key */
+#define KEY_REPEAT_MS       25
+
+/* must be powers of 2 */
+#define QUEUE_SIZE          256
+#define PENDING_SIZE        4096
+
+#define ATOM_SIZE           1024
+#define STATS_SIZE          512
+#define LINE_SIZE           1024
+
+/* keysyms the script may use by name, anything else is a single character or a number */
+#define XK_NUM_LOCK         0xff7f
+
+typedef struct FakeProp FakeProp;
+typedef struct FakeWindow FakeWindow;
+typedef struct FakePending FakePending;
+
+struct FakeProp
+{
+    XCBAtom atom;
+    XCBAtom type;
+    u8 format;
+    u32 len;                    /* in format units */
+    u8 *data;
+    FakeProp *next;
+};
+
+struct FakeWindow
+{
+    XCBWindow id;
+    XCBWindow parent;
+    i16 x;
+    i16 y;
+    u16 w;
+    u16 h;
+    u16 bw;
+    u8 mapped;
+    u8 override;
+    u32 mask;
+    FakeProp *props;
+    u64 counter;                /* value of its _NET_WM_SYNC_REQUEST_COUNTER, set by the sync command */
+    FakeWindow *next;           /* stacking order, bottom to top */
+};
+
+struct FakePending
+{
+    u32 sequence;
+    void *reply;
+    u8 iserror;
+    XCBGenericError err;
+};
+
+static struct
+{
+    FILE *script;
+    FILE *log;
+    int fd;
+    int error;
+    u8 polled;                  /* the WM asked for fd, XCBPollForEvent() reads the script */
+    u32 sequence;
+    u32 line;
+    XCBTimestamp time;
+    XCBWindow root;
+    XCBWindow nextid;
+    XCBWindow focus;
+    u16 sw;
+    u16 sh;
+    i16 px;
+    i16 py;
+    XCBWindow grab;             /* window a held button grabbed, 0 if none */
+    u16 grabmask;               /* its event mask                           */
+    u16 grabstate;              /* modifiers and button held                */
+    XCBSyncAlarm alarm;         /* the one alarm that is armed, 0 if none   */
+    XCBSyncCounter alarmcounter;
+    u64 alarmvalue;
+    u8 detectable;              /* XKB detectable autorepeat was turned on  */
+    XCBWindow under;            /* window the pointer last entered          */
+    FakeWindow *windows;        /* root is always first */
+    XCBGenericEvent *queue[QUEUE_SIZE];
+    u32 qhead;
+    u32 qtail;
+    FakePending pending[PENDING_SIZE];
+    XCBFakeCounts counts;
+} _fake;
+
+static void (*_handler)(XCBDisplay *, XCBGenericError *) = NULL;
+
+static XCBKeysym _keymap[256];
+static char *_atoms[ATOM_SIZE] =
+{
+    NULL, "PRIMARY", "SECONDARY", "ARC", "ATOM", "BITMAP", "CARDINAL", "COLORMAP", "CURSOR",
+    "CUT_BUFFER0", "CUT_BUFFER1", "CUT_BUFFER2", "CUT_BUFFER3", "CUT_BUFFER4", "CUT_BUFFER5", "CUT_BUFFER6", "CUT_BUFFER7",
+    "DRAWABLE", "FONT", "INTEGER", "PIXMAP", "POINT", "RECTANGLE", "RESOURCE_MANAGER",
+    "RGB_COLOR_MAP", "RGB_BEST_MAP", "RGB_BLUE_MAP", "RGB_DEFAULT_MAP", "RGB_GRAY_MAP", "RGB_GREEN_MAP", "RGB_RED_MAP",
+    "STRING", "VISUALID", "WINDOW", "WM_COMMAND", "WM_HINTS", "WM_CLIENT_MACHINE", "WM_ICON_NAME", "WM_ICON_SIZE",
+    "WM_NAME", "WM_NORMAL_HINTS", "WM_SIZE_HINTS", "WM_ZOOM_HINTS", "MIN_SPACE", "NORM_SPACE", "MAX_SPACE", "END_SPACE",
+    "SUPERSCRIPT_X", "SUPERSCRIPT_Y", "SUBSCRIPT_X", "SUBSCRIPT_Y", "UNDERLINE_POSITION", "UNDERLINE_THICKNESS",
+    "STRIKEOUT_ASCENT", "STRIKEOUT_DESCENT", "ITALIC_ANGLE", "X_HEIGHT", "QUAD_WIDTH", "WEIGHT", "POINT_SIZE",
+    "RESOLUTION", "COPYRIGHT", "NOTICE", "FONT_NAME", "FAMILY_NAME", "FULL_NAME", "CAP_HEIGHT", "WM_CLASS",
+    "WM_TRANSIENT_FOR",
+};
+static u32 _atomcount = XCB_ATOM_WM_TRANSIENT_FOR + 1;
+
+static XCBStats _stats[STATS_SIZE];
+static XCBStats _statsoverflow = { .wrapper = "(overflow)", .scope = "(overflow)" };
+static u32 _statscount = 0;
+static const char *_scope = NULL;
+
+static const char *_hot = NULL;
+static u8 _hotpolicy = XCB_TRL_HOT_LOG;
+static u64 _hotviolations = 0;
+
+
+/* HELPER FUNCTIONS */
+
+static XCBStats *
+_fake_stats(const char *wrapper)
+{
+    u32 i;
+    for(i = 0; i < _statscount; ++i)
+    {
+        if(_stats[i].wrapper == wrapper && _stats[i].scope == _scope)
+        {   return _stats + i;
+        }
+    }
+    if(_statscount == STATS_SIZE)
+    {   return &_statsoverflow;
+    }
+    _stats[_statscount].wrapper = wrapper;
+    _stats[_statscount].scope = _scope;
+    return _stats + _statscount++;
+}
+
+static const char *
+_fake_atomname(XCBAtom atom)
+{
+    return atom < _atomcount ? _atoms[atom] : "?";
+}
+
+static XCBAtom
+_fake_intern(const char *name, u8 only_if_exists)
+{
+    u32 i;
+    for(i = 1; i < _atomcount; ++i)
+    {
+        if(!strcmp(_atoms[i], name))
+        {   return i;
+        }
+    }
+    if(only_if_exists || _atomcount == ATOM_SIZE)
+    {   return XCB_ATOM_NONE;
+    }
+    _atoms[_atomcount] = strdup(name);
+    return _atoms[_atomcount] ? _atomcount++ : XCB_ATOM_NONE;
+}
+
+static FakeWindow *
+_fake_window(XCBWindow id)
+{
+    FakeWindow *w;
+    for(w = _fake.windows; w; w = w->next)
+    {
+        if(w->id == id)
+        {   return w;
+        }
+    }
+    return NULL;
+}
+
+static FakeProp *
+_fake_prop(FakeWindow *w, XCBAtom atom)
+{
+    FakeProp *p;
+    for(p = w->props; p; p = p->next)
+    {
+        if(p->atom == atom)
+        {   return p;
+        }
+    }
+    return NULL;
+}
+
+static XCBKeyCode
+_fake_keycode(XCBKeysym sym)
+{
+    u32 i;
+    for(i = 8; i < 256; ++i)
+    {
+        if(_keymap[i] == sym)
+        {   return i;
+        }
+    }
+    for(i = 8; i < 256; ++i)
+    {
+        if(!_keymap[i])
+        {   _keymap[i] = sym;
+            return i;
+        }
+    }
+    return 0;
+}
+
+
+/* LOG */
+
+static void
+_fake_log(const char *fmt, ...)
+{
+    va_list args;
+    if(!_fake.log)
+    {   return;
+    }
+    va_start(args, fmt);
+    vfprintf(_fake.log, fmt, args);
+    va_end(args);
+}
+
+static u32
+_fake_request(const char *wrapper, XCBWindow window, const char *fmt, ...)
+{
+    va_list args;
+    XCBStats *s = _fake_stats(wrapper);
+
+    ++s->requests;
+    ++_fake.counts.requests;
+    ++_fake.sequence;
+    if(_fake.log)
+    {
+        fprintf(_fake.log, "R\t%u\t%s\t%s\t0x%x\t", _fake.sequence, _scope ? _scope : "-", wrapper, window);
+        va_start(args, fmt);
+        vfprintf(_fake.log, fmt, args);
+        va_end(args);
+        fputc('\n', _fake.log);
+    }
+    return _fake.sequence;
+}
+
+static void
+_fake_block(const char *wrapper, u32 sequence)
+{
+    ++_fake_stats(wrapper)->replies;
+    ++_fake.counts.replies;
+    _fake_log("B\t%u\t%s\t%s\n", sequence, _scope ? _scope : "-", wrapper);
+    if(_hot)
+    {
+        ++_hotviolations;
+        if(_hotpolicy & XCB_TRL_HOT_LOG)
+        {   fprintf(stderr, "xcb_trl: %s() blocked on the XServer inside hot path %s()\n", wrapper, _hot);
+        }
+        _fake_log("H\t%s\t%s\n", _hot, wrapper);
+        if(_hotpolicy & XCB_TRL_HOT_ABORT)
+        {   abort();
+        }
+    }
+}
+
+
+/* EVENTS */
+
+static const char *
+_fake_eventname(u8 type)
+{
+    static const char *names[] =
+    {
+        [XCB_KEY_PRESS] = "KeyPress", [XCB_KEY_RELEASE] = "KeyRelease",
+        [XCB_BUTTON_PRESS] = "ButtonPress", [XCB_BUTTON_RELEASE] = "ButtonRelease",
+        [XCB_MOTION_NOTIFY] = "MotionNotify", [XCB_ENTER_NOTIFY] = "EnterNotify", [XCB_LEAVE_NOTIFY] = "LeaveNotify",
+        [XCB_FOCUS_IN] = "FocusIn", [XCB_FOCUS_OUT] = "FocusOut",
+        [XCB_CREATE_NOTIFY] = "CreateNotify", [XCB_DESTROY_NOTIFY] = "DestroyNotify",
+        [XCB_UNMAP_NOTIFY] = "UnmapNotify", [XCB_MAP_NOTIFY] = "MapNotify", [XCB_MAP_REQUEST] = "MapRequest",
+        [XCB_CONFIGURE_NOTIFY] = "ConfigureNotify", [XCB_CONFIGURE_REQUEST] = "ConfigureRequest",
+        [XCB_PROPERTY_NOTIFY] = "PropertyNotify", [XCB_CLIENT_MESSAGE] = "ClientMessage",
+        [XCB_MAPPING_NOTIFY] = "MappingNotify",
+    };
+    type &= ~0x80;
+    if(!type)
+    {   return "Error";
+    }
+    return type < sizeof(names) / sizeof(names[0]) && names[type] ? names[type] : "Event";
+}
+
+/* events are 32 bytes, xcb hands out sizeof(XCBGenericEvent) so full_sequence is valid */
+static void
+_fake_queue(const void *event)
+{
+    XCBGenericEvent *ev;
+    if(_fake.qtail - _fake.qhead == QUEUE_SIZE)
+    {   _fake_log("M\tevent queue overflow, dropped %s\n", _fake_eventname(((const XCBGenericEvent *)event)->response_type));
+        return;
+    }
+    ev = calloc(1, sizeof(XCBGenericEvent));
+    if(!ev)
+    {   return;
+    }
+    memcpy(ev, event, 32);
+    ev->sequence = (u16)_fake.sequence;
+    ev->full_sequence = _fake.sequence;
+    _fake.queue[_fake.qtail++ & (QUEUE_SIZE - 1)] = ev;
+}
+
+static XCBGenericEvent *
+_fake_dequeue(void)
+{
+    XCBGenericEvent *ev;
+    XCBWindow win;
+    if(_fake.qhead == _fake.qtail)
+    {   return NULL;
+    }
+    ev = _fake.queue[_fake.qhead++ & (QUEUE_SIZE - 1)];
+    ++_fake.counts.events;
+    /* every event we generate keeps its main window right after the header, 
+     * device and crossing events have their time and root first 
+     */
+    if(ev->response_type >= XCB_KEY_PRESS && ev->response_type <= XCB_LEAVE_NOTIFY)
+    {   memcpy(&win, (u8 *)ev + 12, sizeof(win));
+    }
+    else
+    {   memcpy(&win, (u8 *)ev + 4, sizeof(win));
+    }
+    _fake_log("E\t%s\t0x%x\n", _fake_eventname(ev->response_type), win);
+    return ev;
+}
+
+static void
+_fake_error(u8 code, u8 major, u32 sequence, u32 resource, FakePending *pending)
+{
+    XCBGenericError err;
+    memset(&err, 0, sizeof(err));
+    err.response_type = 0;
+    err.error_code = code;
+    err.sequence = (u16)sequence;
+    err.resource_id = resource;
+    err.major_code = major;
+    err.full_sequence = sequence;
+
+    ++_fake.counts.errors;
+    _fake_log("X\t%s\t%s\t%u\t0x%x\n", XCBErrorCodeText(code), XCBErrorMajorCodeText(major), sequence, resource);
+    /* errors for replies come with the reply, the rest through the event queue */
+    if(pending)
+    {   pending->iserror = 1;
+        pending->err = err;
+    }
+    else
+    {   _fake_queue(&err);
+    }
+}
+
+/* StructureNotify goes to the window itself, SubstructureNotify to its parent.
+ * Map, Unmap, Destroy and ConfigureNotify all keep the event window right after the header.
+ */
+static void
+_fake_structure(FakeWindow *w, void *event)
+{
+    FakeWindow *parent = _fake_window(w->parent);
+    if(w->mask & XCB_EVENT_MASK_STRUCTURE_NOTIFY)
+    {   memcpy((u8 *)event + 4, &w->id, sizeof(w->id));
+        _fake_queue(event);
+    }
+    if(parent && parent->mask & XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY)
+    {   memcpy((u8 *)event + 4, &parent->id, sizeof(parent->id));
+        _fake_queue(event);
+    }
+}
+
+static u8
+_fake_redirected(FakeWindow *w)
+{
+    FakeWindow *parent = _fake_window(w->parent);
+    return !w->override && parent && parent->mask & XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT;
+}
+
+
+/* MODEL */
+
+static FakeWindow *
+_fake_create(XCBWindow id, XCBWindow parent, i16 x, i16 y, u16 w, u16 h, u16 bw, u8 override)
+{
+    FakeWindow *win = calloc(1, sizeof(FakeWindow));
+    FakeWindow **tail;
+    FakeWindow *p;
+    XCBCreateNotifyEvent ev;
+
+    if(!win)
+    {   return NULL;
+    }
+    win->id = id;
+    win->parent = parent;
+    win->x = x;
+    win->y = y;
+    win->w = w;
+    win->h = h;
+    win->bw = bw;
+    win->override = override;
+    for(tail = &_fake.windows; *tail; tail = &(*tail)->next);
+    *tail = win;
+
+    if((p = _fake_window(parent)) && p->mask & XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY)
+    {
+        memset(&ev, 0, sizeof(ev));
+        ev.response_type = XCB_CREATE_NOTIFY;
+        ev.parent = parent;
+        ev.window = id;
+        ev.x = x;
+        ev.y = y;
+        ev.width = w;
+        ev.height = h;
+        ev.border_width = bw;
+        ev.override_redirect = override;
+        _fake_queue(&ev);
+    }
+    return win;
+}
+
+static void
+_fake_enter(FakeWindow *w)
+{
+    XCBEnterNotifyEvent ev;
+    _fake.under = w->id;
+    if(!(w->mask & XCB_EVENT_MASK_ENTER_WINDOW))
+    {   return;
+    }
+    memset(&ev, 0, sizeof(ev));
+    ev.response_type = XCB_ENTER_NOTIFY;
+    ev.detail = XCB_NOTIFY_DETAIL_NONLINEAR;
+    ev.time = _fake.time;
+    ev.root = _fake.root;
+    ev.event = w->id;
+    ev.root_x = _fake.px;
+    ev.root_y = _fake.py;
+    ev.event_x = _fake.px - w->x;
+    ev.event_y = _fake.py - w->y;
+    ev.mode = XCB_NOTIFY_MODE_NORMAL;
+    ev.same_screen_focus = 1;
+    _fake_queue(&ev);
+}
+
+static void
+_fake_unlink(FakeWindow *w)
+{
+    FakeWindow **tw;
+    for(tw = &_fake.windows; *tw && *tw != w; tw = &(*tw)->next);
+    if(*tw)
+    {   *tw = w->next;
+    }
+    w->next = NULL;
+}
+
+static void
+_fake_setfocus(XCBWindow window)
+{
+    FakeWindow *w;
+    XCBFocusInEvent ev;
+
+    if(_fake.focus == window)
+    {   return;
+    }
+    memset(&ev, 0, sizeof(ev));
+    ev.detail = XCB_NOTIFY_DETAIL_NONLINEAR;
+    ev.mode = XCB_NOTIFY_MODE_NORMAL;
+    if((w = _fake_window(_fake.focus)) && w->mask & XCB_EVENT_MASK_FOCUS_CHANGE)
+    {   ev.response_type = XCB_FOCUS_OUT;
+        ev.event = w->id;
+        _fake_queue(&ev);
+    }
+    _fake.focus = window;
+    if((w = _fake_window(window)) && w->mask & XCB_EVENT_MASK_FOCUS_CHANGE)
+    {   ev.response_type = XCB_FOCUS_IN;
+        ev.event = w->id;
+        _fake_queue(&ev);
+    }
+}
+
+static void
+_fake_map(FakeWindow *w)
+{
+    XCBMapNotifyEvent ev;
+    if(w->mapped)
+    {   return;
+    }
+    w->mapped = 1;
+    memset(&ev, 0, sizeof(ev));
+    ev.response_type = XCB_MAP_NOTIFY;
+    ev.window = w->id;
+    ev.override_redirect = w->override;
+    _fake_structure(w, &ev);
+}
+
+static void
+_fake_unmap(FakeWindow *w)
+{
+    XCBUnMapNotifyEvent ev;
+    if(!w->mapped)
+    {   return;
+    }
+    w->mapped = 0;
+    memset(&ev, 0, sizeof(ev));
+    ev.response_type = XCB_UNMAP_NOTIFY;
+    ev.window = w->id;
+    _fake_structure(w, &ev);
+}
+
+static void
+_fake_destroy(FakeWindow *w)
+{
+    XCBDestroyNotifyEvent ev;
+    FakeWindow *c;
+    FakeProp *p;
+
+    while((c = _fake.windows))
+    {
+        for(; c && c->parent != w->id; c = c->next);
+        if(!c)
+        {   break;
+        }
+        _fake_destroy(c);
+    }
+    _fake_unmap(w);
+    memset(&ev, 0, sizeof(ev));
+    ev.response_type = XCB_DESTROY_NOTIFY;
+    ev.window = w->id;
+    _fake_structure(w, &ev);
+
+    if(_fake.focus == w->id)
+    {   _fake_setfocus(XCB_INPUT_FOCUS_POINTER_ROOT);
+    }
+    _fake_unlink(w);
+    while((p = w->props))
+    {   w->props = p->next;
+        free(p->data);
+        free(p);
+    }
+    free(w);
+}
+
+/* sibling may be 0 for the top (above) or bottom (below) of the stack */
+static void
+_fake_restack(FakeWindow *w, XCBWindow sibling, u8 mode)
+{
+    FakeWindow **tw;
+    FakeWindow *s = sibling ? _fake_window(sibling) : NULL;
+
+    if(w == _fake.windows || (sibling && !s) || s == w)
+    {   return;
+    }
+    _fake_unlink(w);
+    switch(mode)
+    {
+        case XCB_STACK_MODE_BELOW:
+            /* the root always stays first */
+            for(tw = &_fake.windows->next; *tw && s && (*tw) != s; tw = &(*tw)->next);
+            break;
+        case XCB_STACK_MODE_ABOVE:
+        default:
+            for(tw = &_fake.windows->next; *tw && (!s || (*tw) != s->next); tw = &(*tw)->next);
+            break;
+    }
+    w->next = *tw;
+    *tw = w;
+}
+
+static void
+_fake_configure(FakeWindow *w, u16 mask, const XCBWindowChanges *changes)
+{
+    XCBConfigureNotifyEvent ev;
+    FakeWindow *above;
+
+    if(mask & XCB_CONFIG_WINDOW_X)
+    {   w->x = changes->x;
+    }
+    if(mask & XCB_CONFIG_WINDOW_Y)
+    {   w->y = changes->y;
+    }
+    if(mask & XCB_CONFIG_WINDOW_WIDTH)
+    {   w->w = changes->width;
+    }
+    if(mask & XCB_CONFIG_WINDOW_HEIGHT)
+    {   w->h = changes->height;
+    }
+    if(mask & XCB_CONFIG_WINDOW_BORDER_WIDTH)
+    {   w->bw = changes->border_width;
+    }
+    if(mask & XCB_CONFIG_WINDOW_STACK_MODE)
+    {   _fake_restack(w, mask & XCB_CONFIG_WINDOW_SIBLING ? changes->sibling : 0, changes->stack_mode);
+    }
+    memset(&ev, 0, sizeof(ev));
+    ev.response_type = XCB_CONFIGURE_NOTIFY;
+    ev.window = w->id;
+    for(above = _fake.windows->next; above && above->next != w; above = above->next);
+    ev.above_sibling = above ? above->id : XCB_NONE;
+    ev.x = w->x;
+    ev.y = w->y;
+    ev.width = w->w;
+    ev.height = w->h;
+    ev.border_width = w->bw;
+    ev.override_redirect = w->override;
+    _fake_structure(w, &ev);
+}
+
+static void
+_fake_setprop(FakeWindow *w, XCBAtom atom, XCBAtom type, u8 format, u8 mode, const void *data, u32 len)
+{
+    FakeProp *p = _fake_prop(w, atom);
+    XCBPropertyNotifyEvent ev;
+    const u32 size = format / 8;
+    u8 *buf;
+
+    if(!p)
+    {
+        if(!(p = calloc(1, sizeof(FakeProp))))
+        {   return;
+        }
+        p->atom = atom;
+        p->next = w->props;
+        w->props = p;
+        mode = XCB_PROP_MODE_REPLACE;
+    }
+    if(mode == XCB_PROP_MODE_REPLACE || p->format != format || p->type != type)
+    {   p->len = 0;
+    }
+    if((buf = malloc((p->len + len) * size + 1)))
+    {
+        if(mode == XCB_PROP_MODE_PREPEND)
+        {   memcpy(buf, data, len * size);
+            memcpy(buf + len * size, p->data, p->len * size);
+        }
+        else
+        {   memcpy(buf, p->data, p->len * size);
+            memcpy(buf + p->len * size, data, len * size);
+        }
+        free(p->data);
+        p->data = buf;
+        p->len += len;
+    }
+    p->type = type;
+    p->format = format;
+
+    if(w->mask & XCB_EVENT_MASK_PROPERTY_CHANGE)
+    {
+        memset(&ev, 0, sizeof(ev));
+        ev.response_type = XCB_PROPERTY_NOTIFY;
+        ev.window = w->id;
+        ev.atom = atom;
+        ev.time = _fake.time;
+        ev.state = XCB_PROPERTY_NEW_VALUE;
+        _fake_queue(&ev);
+    }
+}
+
+static void
+_fake_delprop(FakeWindow *w, XCBAtom atom)
+{
+    FakeProp **tp;
+    FakeProp *p;
+    XCBPropertyNotifyEvent ev;
+
+    for(tp = &w->props; *tp && (*tp)->atom != atom; tp = &(*tp)->next);
+    if(!(p = *tp))
+    {   return;
+    }
+    *tp = p->next;
+    free(p->data);
+    free(p);
+    if(w->mask & XCB_EVENT_MASK_PROPERTY_CHANGE)
+    {
+        memset(&ev, 0, sizeof(ev));
+        ev.response_type = XCB_PROPERTY_NOTIFY;
+        ev.window = w->id;
+        ev.atom = atom;
+        ev.time = _fake.time;
+        ev.state = XCB_PROPERTY_DELETE;
+        _fake_queue(&ev);
+    }
+}
+
+
+/* REPLIES */
+
+static FakePending *
+_fake_pending(u32 sequence, void *reply)
+{
+    FakePending *pending = &_fake.pending[sequence & (PENDING_SIZE - 1)];
+    /* a cookie that was never claimed, the WM leaks it too */
+    free(pending->reply);
+    memset(pending, 0, sizeof(FakePending));
+    pending->sequence = sequence;
+    pending->reply = reply;
+    return pending;
+}
+
+/* Same as _fake_pending() but for requests on a window, generates BadWindow if it does not exist. */
+static FakeWindow *
+_fake_pendingwin(u32 sequence, u8 major, XCBWindow window)
+{
+    FakePending *pending = _fake_pending(sequence, NULL);
+    FakeWindow *w = _fake_window(window);
+    if(!w)
+    {   _fake_error(BadWindow, major, sequence, window, pending);
+    }
+    return w;
+}
+
+static void *
+_fake_reply(const char *wrapper, XCBCookie cookie)
+{
+    FakePending *pending = &_fake.pending[cookie.sequence & (PENDING_SIZE - 1)];
+    void *reply;
+
+    _fake_block(wrapper, cookie.sequence);
+    if(pending->sequence != cookie.sequence)
+    {   return NULL;
+    }
+    reply = pending->reply;
+    pending->reply = NULL;
+    pending->sequence = 0;
+    if(pending->iserror)
+    {
+        pending->iserror = 0;
+        if(_handler)
+        {   _handler((XCBDisplay *)&_fake, &pending->err);
+        }
+    }
+    return reply;
+}
+
+static xcb_get_property_reply_t *
+_fake_getprop(FakeWindow *w, XCBAtom atom, XCBAtom type, u32 offset, u32 length, u8 _delete)
+{
+    FakeProp *p = _fake_prop(w, atom);
+    xcb_get_property_reply_t *reply;
+    u32 size = 0;
+    u32 start = offset * 4;
+    u32 n = 0;
+
+    if(p)
+    {   size = p->len * (p->format / 8);
+    }
+    if(p && (type == XCB_GET_PROPERTY_TYPE_ANY || type == p->type) && start < size)
+    {   n = size - start < length * 4 ? size - start : length * 4;
+    }
+    /* +1 so text properties can always be terminated */
+    reply = calloc(1, sizeof(xcb_get_property_reply_t) + n + 1);
+    if(!reply)
+    {   return NULL;
+    }
+    reply->response_type = XCB_GET_PROPERTY;
+    if(p)
+    {
+        reply->format = p->format;
+        reply->type = p->type;
+        if(type == XCB_GET_PROPERTY_TYPE_ANY || type == p->type)
+        {
+            memcpy(reply + 1, p->data + start, n);
+            reply->value_len = n / (p->format / 8);
+            reply->bytes_after = size - start - n;
+            if(_delete && !reply->bytes_after)
+            {   _fake_delprop(w, atom);
+            }
+        }
+        else
+        {   reply->bytes_after = size;
+        }
+    }
+    reply->length = (n + 3) / 4;
+    return reply;
+}
+
+static XCBCookie
+_fake_propcookie(const char *wrapper, XCBWindow window, XCBAtom atom, XCBAtom type, u32 offset, u32 length, u8 _delete)
+{
+    const XCBCookie cookie = { .sequence = _fake_request(wrapper, window, "%s", _fake_atomname(atom)) };
+    FakeWindow *w = _fake_pendingwin(cookie.sequence, X_GetProperty, window);
+    if(w)
+    {   _fake.pending[cookie.sequence & (PENDING_SIZE - 1)].reply = _fake_getprop(w, atom, type, offset, length, _delete);
+    }
+    return cookie;
+}
+
+
+/* SCRIPT */
+
+static char *
+_fake_word(char **s)
+{
+    char *word;
+    while(**s && isspace((unsigned char)**s))
+    {   ++*s;
+    }
+    if(!**s || **s == '#')
+    {   return NULL;
+    }
+    word = *s;
+    while(**s && !isspace((unsigned char)**s))
+    {   ++*s;
+    }
+    if(**s)
+    {   *(*s)++ = '\0';
+    }
+    return word;
+}
+
+static u8
+_fake_number(const char *word, i64 *number_return)
+{
+    char *end;
+    if(!word)
+    {   return 0;
+    }
+    *number_return = strtoll(word, &end, 0);
+    return end != word && !*end;
+}
+
+static XCBKeysym
+_fake_keysym(const char *word)
+{
+    static const struct { const char *name; XCBKeysym sym; } names[] =
+    {
+        { "space", 0x20 }, { "BackSpace", 0xff08 }, { "Tab", 0xff09 }, { "Return", 0xff0d },
+        { "Escape", 0xff1b }, { "Delete", 0xffff }, { "Home", 0xff50 }, { "Left", 0xff51 },
+        { "Up", 0xff52 }, { "Right", 0xff53 }, { "Down", 0xff54 }, { "End", 0xff57 },
+        { "Print", 0xff61 }, { "Num_Lock", XK_NUM_LOCK },
+    };
+    u32 i;
+    i64 n;
+
+    if(word[0] && !word[1])
+    {   return (unsigned char)tolower((unsigned char)word[0]);
+    }
+    if((word[0] == 'F' || word[0] == 'f') && _fake_number(word + 1, &n) && n >= 1 && n <= 35)
+    {   return 0xffbe + n - 1;
+    }
+    for(i = 0; i < sizeof(names) / sizeof(names[0]); ++i)
+    {
+        if(!strcmp(names[i].name, word))
+        {   return names[i].sym;
+        }
+    }
+    return _fake_number(word, &n) ? (XCBKeysym)n : 0;
+}
+
+static u16
+_fake_mods(char *word)
+{
+    static const struct { const char *name; u16 mask; } names[] =
+    {
+        { "shift", XCB_MOD_MASK_SHIFT }, { "lock", XCB_MOD_MASK_LOCK }, { "ctrl", XCB_MOD_MASK_CONTROL },
+        { "alt", XCB_MOD_MASK_1 }, { "super", XCB_MOD_MASK_4 },
+        { "mod1", XCB_MOD_MASK_1 }, { "mod2", XCB_MOD_MASK_2 }, { "mod3", XCB_MOD_MASK_3 },
+        { "mod4", XCB_MOD_MASK_4 }, { "mod5", XCB_MOD_MASK_5 },
+    };
+    u16 mods = 0;
+    u32 i;
+    char *name;
+    i64 n;
+
+    for(name = word ? strtok(word, "+") : NULL; name; name = strtok(NULL, "+"))
+    {
+        for(i = 0; i < sizeof(names) / sizeof(names[0]); ++i)
+        {
+            if(!strcmp(names[i].name, name))
+            {   mods |= names[i].mask;
+                break;
+            }
+        }
+        if(i == sizeof(names) / sizeof(names[0]) && _fake_number(name, &n))
+        {   mods |= n;
+        }
+    }
+    return mods;
+}
+
+static XCBAtom
+_fake_atomword(const char *word)
+{
+    i64 n;
+    return _fake_number(word, &n) ? (XCBAtom)n : _fake_intern(word, 0);
+}
+
+static void
+_fake_input(u8 type, u8 detail, XCBWindow event, u16 state)
+{
+    XCBKeyPressEvent ev;
+    FakeWindow *w = _fake_window(event);
+
+    memset(&ev, 0, sizeof(ev));
+    ev.response_type = type;
+    ev.detail = detail;
+    ev.time = _fake.time;
+    ev.root = _fake.root;
+    ev.event = event;
+    ev.root_x = _fake.px;
+    ev.root_y = _fake.py;
+    ev.event_x = w ? _fake.px - w->x : _fake.px;
+    ev.event_y = w ? _fake.py - w->y : _fake.py;
+    ev.state = state;
+    ev.same_screen = 1;
+    _fake_queue(&ev);
+}
+
+int
+XCBFakeScript(const char *line)
+{
+    char buf[LINE_SIZE];
+    char *s = buf;
+    char *cmd;
+    char *args[4];
+    i64 n[4];
+    u32 argc = 0;
+    u32 i;
+    FakeWindow *w = NULL;
+
+    snprintf(buf, sizeof(buf), "%s", line);
+    buf[strcspn(buf, "\n")] = '\0';
+    if(!(cmd = _fake_word(&s)))
+    {   return 1;
+    }
+    if(!strcmp(cmd, "mark"))
+    {   while(isspace((unsigned char)*s))
+        {   ++s;
+        }
+        _fake_log("M\t%s\n", s);
+        return 1;
+    }
+
+    ++_fake.time;
+    /* prop and message take a variable amount of arguments */
+    for(argc = 0; argc < 4 && (args[argc] = _fake_word(&s)); ++argc)
+    {   n[argc] = 0;
+        _fake_number(args[argc], n + argc);
+    }
+    if(strcmp(cmd, "window") && strcmp(cmd, "key") && strcmp(cmd, "hold") && strcmp(cmd, "motion"))
+    {
+        if(!argc || !(w = _fake_window(n[0])))
+        {   return 0;
+        }
+    }
+
+    if(!strcmp(cmd, "window") && argc >= 1)
+    {
+        i64 h = 1;
+        char *word;
+        for(i = argc; i < 4; ++i)
+        {   n[i] = 0;
+        }
+        if(_fake_number(word = _fake_word(&s), &h))
+        {   word = _fake_word(&s);
+        }
+        if(_fake_window(n[0]))
+        {   return 0;
+        }
+        return !!_fake_create(n[0], _fake.root, n[1], n[2], n[3] > 0 ? n[3] : 1, h > 0 ? h : 1, 0, word && !strcmp(word, "override"));
+    }
+    else if(!strcmp(cmd, "prop") && argc == 4)
+    {
+        const XCBAtom atom = _fake_atomword(args[1]);
+        const XCBAtom type = _fake_atomword(args[2]);
+        u32 data[LINE_SIZE / 2];
+        char *word;
+
+        if(n[3] == 8)
+        {   while(isspace((unsigned char)*s))
+            {   ++s;
+            }
+            _fake_setprop(w, atom, type, 8, XCB_PROP_MODE_REPLACE, s, strlen(s));
+            return 1;
+        }
+        if(n[3] != 32)
+        {   return 0;
+        }
+        for(i = 0; (word = _fake_word(&s)) && i < sizeof(data) / sizeof(data[0]); ++i)
+        {   data[i] = _fake_atomword(word);
+        }
+        _fake_setprop(w, atom, type, 32, XCB_PROP_MODE_REPLACE, data, i);
+    }
+    else if(!strcmp(cmd, "map"))
+    {
+        if(_fake_redirected(w))
+        {
+            XCBMapRequestEvent ev;
+            memset(&ev, 0, sizeof(ev));
+            ev.response_type = XCB_MAP_REQUEST;
+            ev.parent = w->parent;
+            ev.window = w->id;
+            _fake_queue(&ev);
+        }
+        else
+        {   _fake_map(w);
+        }
+    }
+    else if(!strcmp(cmd, "unmap"))
+    {   _fake_unmap(w);
+    }
+    else if(!strcmp(cmd, "destroy"))
+    {   _fake_destroy(w);
+    }
+    else if(!strcmp(cmd, "configure") && argc == 4)
+    {
+        u16 mask = XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y | XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT;
+        i64 h;
+        i64 bw = w->bw;
+        if(!_fake_number(_fake_word(&s), &h))
+        {   return 0;
+        }
+        if(_fake_number(_fake_word(&s), &bw))
+        {   mask |= XCB_CONFIG_WINDOW_BORDER_WIDTH;
+        }
+        if(_fake_redirected(w))
+        {
+            XCBConfigureRequestEvent ev;
+            memset(&ev, 0, sizeof(ev));
+            ev.response_type = XCB_CONFIGURE_REQUEST;
+            ev.parent = w->parent;
+            ev.window = w->id;
+            ev.x = n[1];
+            ev.y = n[2];
+            ev.width = n[3];
+            ev.height = h;
+            ev.border_width = bw;
+            ev.value_mask = mask;
+            _fake_queue(&ev);
+        }
+        else
+        {
+            XCBWindowChanges changes;
+            memset(&changes, 0, sizeof(changes));
+            changes.x = n[1];
+            changes.y = n[2];
+            changes.width = n[3];
+            changes.height = h;
+            changes.border_width = bw;
+            _fake_configure(w, mask, &changes);
+        }
+    }
+    else if(!strcmp(cmd, "key") && argc >= 1)
+    {
+        const XCBKeyCode code = _fake_keycode(_fake_keysym(args[0]));
+        const u16 mods = _fake_mods(argc >= 2 ? args[1] : NULL);
+        _fake_input(XCB_KEY_PRESS, code, _fake.root, mods);
+        _fake_input(XCB_KEY_RELEASE, code, _fake.root, mods);
+    }
+    else if(!strcmp(cmd, "hold") && argc >= 2)
+    {
+        const XCBKeyCode code = _fake_keycode(_fake_keysym(args[0]));
+        const u16 mods = _fake_mods(argc >= 3 ? args[2] : NULL);
+        /* two events per repeat without detectable autorepeat, the queue must hold all of them */
+        const i64 count = n[1] < 0 ? 0 : n[1] > QUEUE_SIZE / 2 - 2 ? QUEUE_SIZE / 2 - 2 : n[1];
+        _fake_input(XCB_KEY_PRESS, code, _fake.root, mods);
+        for(i = 0; i < count; ++i)
+        {
+            _fake.time += KEY_REPEAT_MS;
+            if(!_fake.detectable)
+            {   _fake_input(XCB_KEY_RELEASE, code, _fake.root, mods);
+            }
+            _fake_input(XCB_KEY_PRESS, code, _fake.root, mods);
+        }
+        _fake.time += KEY_REPEAT_MS;
+        _fake_input(XCB_KEY_RELEASE, code, _fake.root, mods);
+    }
+    else if(!strcmp(cmd, "button") && argc >= 2)
+    {
+        const u16 mods = _fake_mods(argc >= 3 ? args[2] : NULL);
+        _fake_input(XCB_BUTTON_PRESS, n[1], w->id, mods);
+        _fake_input(XCB_BUTTON_RELEASE, n[1], w->id, mods | (XCB_BUTTON_MASK_1 << (n[1] - 1)));
+    }
+    else if(!strcmp(cmd, "press") && argc >= 2)
+    {
+        const u16 mods = _fake_mods(argc >= 3 ? args[2] : NULL);
+        _fake_input(XCB_BUTTON_PRESS, n[1], w->id, mods);
+        /* the automatic grab a button press activates, reports BUTTONMASK until changed */
+        _fake.grab = w->id;
+        _fake.grabmask = XCB_EVENT_MASK_BUTTON_PRESS | XCB_EVENT_MASK_BUTTON_RELEASE;
+        _fake.grabstate = mods | (XCB_BUTTON_MASK_1 << (n[1] - 1));
+    }
+    else if(!strcmp(cmd, "release") && argc >= 2)
+    {
+        _fake_input(XCB_BUTTON_RELEASE, n[1], _fake.grab ? _fake.grab : w->id, _fake.grabstate);
+        _fake.grab = 0;
+        _fake.grabstate = 0;
+    }
+    else if(!strcmp(cmd, "motion") && argc >= 2)
+    {
+        FakeWindow *root = _fake_window(_fake.root);
+        _fake.px = n[0];
+        _fake.py = n[1];
+        if(_fake.grab)
+        {
+            if(_fake.grabmask & XCB_EVENT_MASK_POINTER_MOTION)
+            {   _fake_input(XCB_MOTION_NOTIFY, XCB_MOTION_NORMAL, _fake.grab, _fake.grabstate);
+            }
+        }
+        else
+        {
+            FakeWindow *p;
+            FakeWindow *under = NULL;
+            /* the topmost mapped window under the pointer, crossing into it sends EnterNotify */
+            for(p = _fake.windows; p; p = p->next)
+            {
+                if(p->mapped && p->id != _fake.root && _fake.px >= p->x && _fake.py >= p->y 
+                        && _fake.px < p->x + p->w + 2 * p->bw && _fake.py < p->y + p->h + 2 * p->bw)
+                {   under = p;
+                }
+            }
+            if(under && under->id != _fake.under)
+            {   _fake_enter(under);
+            }
+            if(root->mask & XCB_EVENT_MASK_POINTER_MOTION)
+            {   _fake_input(XCB_MOTION_NOTIFY, XCB_MOTION_NORMAL, _fake.root, 0);
+            }
+        }
+    }
+    else if(!strcmp(cmd, "enter"))
+    {
+        _fake.px = w->x + w->w / 2;
+        _fake.py = w->y + w->h / 2;
+        _fake_enter(w);
+    }
+    else if(!strcmp(cmd, "focus"))
+    {   _fake_setfocus(w->id);
+    }
+    else if(!strcmp(cmd, "sync") && argc >= 2)
+    {
+        FakeProp *p = _fake_prop(w, _fake_intern("_NET_WM_SYNC_REQUEST_COUNTER", 0));
+        const XCBSyncCounter counter = p && p->len ? *(u32 *)p->data : 0;
+        w->counter = n[1];
+        if(_fake.alarm && counter && counter == _fake.alarmcounter && (u64)n[1] >= _fake.alarmvalue)
+        {
+            XCBSyncAlarmNotifyEvent ev;
+            memset(&ev, 0, sizeof(ev));
+            ev.response_type = SYNC_EVENT + XCB_SYNC_ALARM_NOTIFY;
+            ev.alarm = _fake.alarm;
+            ev.counter_value.hi = (u64)n[1] >> 32;
+            ev.counter_value.lo = (u64)n[1] & UINT32_MAX;
+            ev.alarm_value.hi = _fake.alarmvalue >> 32;
+            ev.alarm_value.lo = _fake.alarmvalue & UINT32_MAX;
+            ev.timestamp = _fake.time;
+            /* XCB_SYNC_ALARMSTATE_INACTIVE, a zero delta triggers once */
+            ev.state = 1;
+            _fake.alarm = 0;
+            _fake_queue(&ev);
+        }
+    }
+    else if(!strcmp(cmd, "message") && argc >= 2)
+    {
+        XCBClientMessageEvent ev;
+        char *word;
+        memset(&ev, 0, sizeof(ev));
+        ev.response_type = XCB_CLIENT_MESSAGE;
+        ev.format = 32;
+        ev.window = w->id;
+        ev.type = _fake_atomword(args[1]);
+        for(i = 2; i < argc; ++i)
+        {   ev.data.data32[i - 2] = _fake_atomword(args[i]);
+        }
+        for(i = argc - 2; i < 5 && (word = _fake_word(&s)); ++i)
+        {   ev.data.data32[i] = _fake_atomword(word);
+        }
+        _fake_queue(&ev);
+    }
+    else
+    {   return 0;
+    }
+    return 1;
+}
+
+/* RETURN: 0 once the script ran out. */
+static int
+_fake_step(void)
+{
+    char line[LINE_SIZE];
+    if(!_fake.script || !fgets(line, sizeof(line), _fake.script))
+    {   return 0;
+    }
+    ++_fake.line;
+    if(!XCBFakeScript(line))
+    {   fprintf(stderr, "xcb_trl_fake: line %u: bad command: %s", _fake.line, line);
+    }
+    return 1;
+}
+
+
+/* INSPECTION */
+
+void
+XCBFakeGetCounts(XCBFakeCounts *counts_return)
+{
+    *counts_return = _fake.counts;
+}
+
+void
+XCBFakeResetCounts(void)
+{
+    memset(&_fake.counts, 0, sizeof(_fake.counts));
+}
+
+int
+XCBFakeGetWindow(XCBWindow window, i16 *x_return, i16 *y_return, u16 *width_return, u16 *height_return, u8 *mapped_return)
+{
+    FakeWindow *w = _fake_window(window);
+    if(!w)
+    {   return 0;
+    }
+    if(x_return)
+    {   *x_return = w->x;
+    }
+    if(y_return)
+    {   *y_return = w->y;
+    }
+    if(width_return)
+    {   *width_return = w->w;
+    }
+    if(height_return)
+    {   *height_return = w->h;
+    }
+    if(mapped_return)
+    {   *mapped_return = w->mapped;
+    }
+    return 1;
+}
+
+XCBWindow
+XCBFakeGetFocus(void)
+{
+    return _fake.focus;
+}
+
+
+/* DISPLAY */
+
+XCBDisplay *
+XCBOpenDisplay(const char *displayName, int *defaultScreenReturn)
+{
+    const char *script = getenv("XCB_FAKE_SCRIPT");
+    const char *log = getenv("XCB_FAKE_LOG");
+    const char *screen = getenv("XCB_FAKE_SCREEN");
+    unsigned int sw = 1920;
+    unsigned int sh = 1080;
+    FakeWindow *root;
+
+    (void)displayName;
+    memset(&_fake, 0, sizeof(_fake));
+    if(screen)
+    {   sscanf(screen, "%ux%u", &sw, &sh);
+    }
+    _fake.sw = sw;
+    _fake.sh = sh;
+    _fake.script = script && strcmp(script, "-") ? fopen(script, "r") : stdin;
+    _fake.log = log ? fopen(log, "w") : NULL;
+    /* the fd is always readable, events are only produced when asked for */
+    _fake.fd = eventfd(1, EFD_CLOEXEC | EFD_NONBLOCK);
+    _fake.root = 0x100;
+    _fake.nextid = 0x200000;
+    _fake.focus = XCB_INPUT_FOCUS_POINTER_ROOT;
+    _fake.px = sw / 2;
+    _fake.py = sh / 2;
+    if(!_fake.script || (log && !_fake.log) || !(root = _fake_create(_fake.root, XCB_NONE, 0, 0, sw, sh, 0, 0)))
+    {   XCBCloseDisplay((XCBDisplay *)&_fake);
+        return NULL;
+    }
+    root->mapped = 1;
+    /* spawn() forks, a half full buffer would be written twice */
+    if(_fake.log)
+    {   setvbuf(_fake.log, NULL, _IOLBF, 0);
+    }
+    if(defaultScreenReturn)
+    {   *defaultScreenReturn = 0;
+    }
+    return (XCBDisplay *)&_fake;
+}
+
+void
+XCBCloseDisplay(XCBDisplay *display)
+{
+    FakeWindow *w;
+    FakeProp *p;
+    u32 i;
+
+    (void)display;
+    while((w = _fake.windows))
+    {
+        _fake.windows = w->next;
+        while((p = w->props))
+        {   w->props = p->next;
+            free(p->data);
+            free(p);
+        }
+        free(w);
+    }
+    while(_fake.qhead != _fake.qtail)
+    {   free(_fake.queue[_fake.qhead++ & (QUEUE_SIZE - 1)]);
+    }
+    for(i = 0; i < PENDING_SIZE; ++i)
+    {   free(_fake.pending[i].reply);
+        _fake.pending[i].reply = NULL;
+    }
+    if(_fake.script && _fake.script != stdin)
+    {   fclose(_fake.script);
+    }
+    if(_fake.log)
+    {   fclose(_fake.log);
+    }
+    if(_fake.fd >= 0)
+    {   close(_fake.fd);
+    }
+    _fake.script = NULL;
+    _fake.log = NULL;
+    _fake.fd = -1;
+}
+
+int
+XCBConnectionNumber(XCBDisplay *display)
+{
+    (void)display;
+    /* startup (checkotherwm) polls before this, it must not see scripted input */
+    _fake.polled = 1;
+    return _fake.fd;
+}
+
+int
+XCBCheckDisplayError(XCBDisplay *display)
+{
+    (void)display;
+    return _fake.error;
+}
+
+XCBWindow
+XCBRootWindow(XCBDisplay *display, int screen)
+{
+    (void)display;
+    (void)screen;
+    return _fake.root;
+}
+
+u16
+XCBDisplayWidth(XCBDisplay *display, int screen)
+{
+    (void)display;
+    (void)screen;
+    return _fake.sw;
+}
+
+u16
+XCBDisplayHeight(XCBDisplay *display, int screen)
+{
+    (void)display;
+    (void)screen;
+    return _fake.sh;
+}
+
+int
+XCBFlush(XCBDisplay *display)
+{
+    (void)display;
+    ++_fake.counts.flushes;
+    return 1;
+}
+
+void
+XCBSync(XCBDisplay *display)
+{
+    (void)display;
+    ++_fake.counts.syncs;
+    _fake_block(__func__, _fake.sequence);
+}
+
+int
+XCBDiscardReply(XCBDisplay *display, XCBCookie cookie)
+{
+    FakePending *pending = &_fake.pending[cookie.sequence & (PENDING_SIZE - 1)];
+    (void)display;
+    if(pending->sequence == cookie.sequence)
+    {   free(pending->reply);
+        memset(pending, 0, sizeof(FakePending));
+    }
+    return 1;
+}
+
+int
+XCBSetErrorHandler(void (*error_handler)(XCBDisplay *, XCBGenericError *))
+{   return !!(_handler = error_handler);
+}
+
+int
+XCBNextEvent(XCBDisplay *display, XCBGenericEvent **event_return)
+{
+    (void)display;
+    while(!(*event_return = _fake_dequeue()))
+    {
+        if(!_fake_step())
+        {   return 0;
+        }
+    }
+    return 1;
+}
+
+XCBGenericEvent *
+XCBPollForEvent(XCBDisplay *display)
+{
+    XCBGenericEvent *ev;
+    (void)display;
+    /* one line per read, so the WM goes idle between lines like it would between arrivals */
+    if(!(ev = _fake_dequeue()) && _fake.polled && !_fake.error)
+    {
+        /* like a server that went away, the fd stays readable and the WM sees the error */
+        if(!_fake_step())
+        {   _fake.error = XCB_CONN_ERROR;
+        }
+        ev = _fake_dequeue();
+    }
+    return ev;
+}
+
+XCBGenericEvent *
+XCBPollForQueuedEvent(XCBDisplay *display)
+{
+    (void)display;
+    return _fake_dequeue();
+}
+
+char *
+XCBErrorCodeText(
+        uint8_t error_code)
+{
+    char *errs[18] =
+    {
+        [0] = NULL,
+        [BadRequest] = "BadRequest",
+        [BadValue] = "BadValue",
+        [BadWindow] = "BadWindow",
+        [BadPixmap] = "BadPixmap",
+        [BadAtom] = "BadAtom",
+        [BadCursor] = "BadCursor",
+        [BadFont] = "BadFont",
+        [BadMatch] = "BadMatch",
+        [BadDrawable] = "BadDrawable",
+        [BadAccess] = "BadAccess",
+        [BadAlloc] = "BadAlloc",
+        [BadColor] = "BadColor",
+        [BadGC] = "BadGC",
+        [BadIDChoice] = "BadIDChoice",
+        [BadName] = "BadName",
+        [BadLength] = "BadLength",
+        [BadImplementation] = "BadImplementation",
+    };
+    return error_code < 18 && errs[error_code] ? errs[error_code] : "Unknown";
+}
+
+/* only the requests the fake can fail */
+char *
+XCBErrorMajorCodeText(
+        uint8_t major_code)
+{
+    switch(major_code)
+    {
+        case X_ChangeWindowAttributes:  return "ChangeWindowAttributes";
+        case X_GetWindowAttributes:     return "GetWindowAttributes";
+        case X_DestroyWindow:           return "DestroyWindow";
+        case X_MapWindow:               return "MapWindow";
+        case X_UnmapWindow:             return "UnmapWindow";
+        case X_ConfigureWindow:         return "ConfigureWindow";
+        case X_GetGeometry:             return "GetGeometry";
+        case X_QueryTree:               return "QueryTree";
+        case X_ChangeProperty:          return "ChangeProperty";
+        case X_DeleteProperty:          return "DeleteProperty";
+        case X_GetProperty:             return "GetProperty";
+        case X_SendEvent:               return "SendEvent";
+        case X_QueryPointer:            return "QueryPointer";
+        case X_KillClient:              return "KillClient";
+    }
+    return "Unknown";
+}
+
+int
+XCBErrorOrigin(XCBGenericError *err, XCBRequestOrigin *origin_return)
+{
+    /* the log already has every request by sequence */
+    (void)err;
+    (void)origin_return;
+    return 0;
+}
+
+
+/* STATS */
+
+const char *
+XCBStatsEnter(const char *scope)
+{
+    const char *previous = _scope;
+    _scope = scope;
+    return previous;
+}
+
+void
+XCBStatsLeave(const char **previous)
+{
+    _scope = *previous;
+}
+
+u32
+XCBStatsGet(XCBStats *stats_return, u32 max)
+{
+    u32 i;
+    for(i = 0; i < _statscount && i < max; ++i)
+    {   stats_return[i] = _stats[i];
+    }
+    return i;
+}
+
+void
+XCBStatsTotal(XCBStats *total_return)
+{
+    u32 i;
+    memset(total_return, 0, sizeof(XCBStats));
+    total_return->wrapper = "(total)";
+    total_return->scope = "(total)";
+    for(i = 0; i <= _statscount; ++i)
+    {
+        const XCBStats *s = i == _statscount ? &_statsoverflow : _stats + i;
+        total_return->requests += s->requests;
+        total_return->replies += s->replies;
+    }
+}
+
+void
+XCBStatsReset(void)
+{
+    memset(_stats, 0, sizeof(_stats));
+    _statscount = 0;
+    _statsoverflow.requests = 0;
+    _statsoverflow.replies = 0;
+}
+
+int
+XCBStatsDump(FILE *file)
+{
+    XCBStats total;
+    u32 i;
+    if(!file)
+    {   return 0;
+    }
+    fprintf(file, "wrapper\tscope\trequests\tbytes\treplies\tblockns\n");
+    for(i = 0; i < _statscount; ++i)
+    {   fprintf(file, "%s\t%s\t%"PRIu64"\t0\t%"PRIu64"\t0\n", _stats[i].wrapper, _stats[i].scope ? _stats[i].scope : "-", _stats[i].requests, _stats[i].replies);
+    }
+    XCBStatsTotal(&total);
+    fprintf(file, "%s\t%s\t%"PRIu64"\t0\t%"PRIu64"\t0\n", total.wrapper, total.scope, total.requests, total.replies);
+    return !ferror(file);
+}
+
+
+/* HOT PATH */
+
+const char *
+XCBHotEnter(const char *hot)
+{
+    const char *previous = _hot;
+    _hot = hot;
+    return previous;
+}
+
+void
+XCBHotLeave(const char **previous)
+{
+    _hot = *previous;
+}
+
+void
+XCBSetHotPolicy(u8 policy)
+{
+    _hotpolicy = policy;
+}
+
+u64
+XCBHotViolations(void)
+{
+    return _hotviolations;
+}
+
+
+/* ATOMS */
+
+XCBCookie
+XCBInternAtomCookie(XCBDisplay *display, const char *name, int only_if_exists)
+{
+    const XCBCookie cookie = { .sequence = REQ(XCB_NONE, "%s", name) };
+    xcb_intern_atom_reply_t *reply = calloc(1, sizeof(xcb_intern_atom_reply_t));
+    (void)display;
+    if(reply)
+    {   reply->response_type = XCB_INTERN_ATOM;
+        reply->atom = _fake_intern(name, only_if_exists);
+    }
+    _fake_pending(cookie.sequence, reply);
+    return cookie;
+}
+
+XCBAtom
+XCBInternAtomReply(XCBDisplay *display, XCBCookie cookie)
+{
+    xcb_intern_atom_reply_t *reply = BLOCK(cookie);
+    XCBAtom atom = XCB_ATOM_NONE;
+    (void)display;
+    if(reply)
+    {   atom = reply->atom;
+        free(reply);
+    }
+    return atom;
+}
+
+
+/* PROPERTIES */
+
+XCBCookie
+XCBChangeProperty(XCBDisplay *display, XCBWindow window, XCBAtom property, XCBAtom type, u8 format, u8 mode, const void *data, u32 nelements)
+{
+    const XCBCookie cookie = { .sequence = REQ(window, "%s %s %u %u", _fake_atomname(property), _fake_atomname(type), format, nelements) };
+    FakeWindow *w = _fake_window(window);
+    (void)display;
+    if(!w)
+    {   _fake_error(BadWindow, X_ChangeProperty, cookie.sequence, window, NULL);
+    }
+    else if(format != 8 && format != 16 && format != 32)
+    {   _fake_error(BadValue, X_ChangeProperty, cookie.sequence, format, NULL);
+    }
+    else
+    {   _fake_setprop(w, property, type, format, mode, data, nelements);
+    }
+    return cookie;
+}
+
+XCBCookie
+XCBDeleteProperty(XCBDisplay *display, XCBWindow window, XCBAtom property)
+{
+    const XCBCookie cookie = { .sequence = REQ(window, "%s", _fake_atomname(property)) };
+    FakeWindow *w = _fake_window(window);
+    (void)display;
+    if(!w)
+    {   _fake_error(BadWindow, X_DeleteProperty, cookie.sequence, window, NULL);
+    }
+    else
+    {   _fake_delprop(w, property);
+    }
+    return cookie;
+}
+
+XCBCookie
+XCBGetWindowPropertyCookie(XCBDisplay *display, XCBWindow w, XCBAtom property, u32 long_offset, u32 long_length, u8 _delete, XCBAtom req_type)
+{
+    (void)display;
+    return _fake_propcookie(__func__, w, property, req_type, long_offset, long_length, _delete);
+}
+
+XCBWindowProperty *
+XCBGetWindowPropertyReply(XCBDisplay *display, XCBCookie cookie)
+{
+    (void)display;
+    return BLOCK(cookie);
+}
+
+void *
+XCBGetWindowPropertyValue(XCBWindowProperty *reply)
+{
+    return reply + 1;
+}
+
+void *
+XCBGetPropertyValue(XCBWindowProperty *reply)
+{
+    return reply + 1;
+}
+
+u32
+XCBGetPropertyValueLength(XCBWindowProperty *reply, size_t size)
+{
+    return reply->value_len * (reply->format / 8) / size;
+}
+
+XCBCookie
+XCBGetTextPropertyCookie(XCBDisplay *display, XCBWindow window, XCBAtom property)
+{
+    (void)display;
+    return _fake_propcookie(__func__, window, property, XCB_GET_PROPERTY_TYPE_ANY, 0, UINT32_MAX / 4, 0);
+}
+
+int
+XCBGetTextPropertyReply(XCBDisplay *display, XCBCookie cookie, XCBTextProperty *reply_return)
+{
+    xcb_get_property_reply_t *reply = BLOCK(cookie);
+    (void)display;
+    memset(reply_return, 0, sizeof(XCBTextProperty));
+    if(!reply || reply->type == XCB_NONE)
+    {   free(reply);
+        return 0;
+    }
+    reply_return->_reply = reply;
+    reply_return->encoding = reply->type;
+    reply_return->format = reply->format;
+    reply_return->name_len = reply->value_len * (reply->format / 8);
+    reply_return->name = (char *)(reply + 1);
+    return 1;
+}
+
+int
+XCBFreeTextProperty(XCBTextProperty *prop)
+{
+    free(prop->_reply);
+    prop->_reply = NULL;
+    return 1;
+}
+
+XCBCookie
+XCBGetTransientForHintCookie(XCBDisplay *display, XCBWindow win)
+{
+    (void)display;
+    return _fake_propcookie(__func__, win, XCB_ATOM_WM_TRANSIENT_FOR, XCB_ATOM_WINDOW, 0, 1, 0);
+}
+
+u8
+XCBGetTransientForHintReply(XCBDisplay *display, XCBCookie cookie, XCBWindow *trans_return)
+{
+    xcb_get_property_reply_t *reply = BLOCK(cookie);
+    u8 status = 0;
+    (void)display;
+    if(reply && reply->type == XCB_ATOM_WINDOW && reply->format == 32 && reply->value_len)
+    {   memcpy(trans_return, reply + 1, sizeof(XCBWindow));
+        status = 1;
+    }
+    free(reply);
+    return status;
+}
+
+XCBCookie
+XCBGetWMHintsCookie(XCBDisplay *display, XCBWindow win)
+{
+    (void)display;
+    return _fake_propcookie(__func__, win, XCB_ATOM_WM_HINTS, XCB_ATOM_WM_HINTS, 0, XCB_ICCCM_NUM_WM_HINTS_ELEMENTS, 0);
+}
+
+XCBWMHints *
+XCBGetWMHintsReply(XCBDisplay *display, XCBCookie cookie)
+{
+    xcb_get_property_reply_t *reply = BLOCK(cookie);
+    XCBWMHints *hints = NULL;
+    (void)display;
+    if(reply && reply->type == XCB_ATOM_WM_HINTS && reply->format == 32 && reply->value_len >= XCB_ICCCM_NUM_WM_HINTS_ELEMENTS - 1)
+    {
+        if((hints = calloc(1, sizeof(XCBWMHints))))
+        {   memcpy(hints, reply + 1, reply->value_len * 4);
+        }
+    }
+    free(reply);
+    return hints;
+}
+
+XCBCookie
+XCBSetWMHintsCookie(XCBDisplay *display, XCBWindow window, XCBWMHints *wmhints)
+{
+    return XCBChangeProperty(display, window, XCB_ATOM_WM_HINTS, XCB_ATOM_WM_HINTS, 32, XCB_PROP_MODE_REPLACE, wmhints, sizeof(XCBWMHints) / 4);
+}
+
+XCBCookie
+XCBGetWMNormalHintsCookie(XCBDisplay *display, XCBWindow win)
+{
+    (void)display;
+    return _fake_propcookie(__func__, win, XCB_ATOM_WM_NORMAL_HINTS, XCB_ATOM_WM_SIZE_HINTS, 0, sizeof(XCBSizeHints) / 4, 0);
+}
+
+u8
+XCBGetWMNormalHintsReply(XCBDisplay *display, XCBCookie cookie, XCBSizeHints *hints_return)
+{
+    xcb_get_property_reply_t *reply = BLOCK(cookie);
+    u8 status = 0;
+    (void)display;
+    memset(hints_return, 0, sizeof(XCBSizeHints));
+    /* pre ICCCM 1 clients only have 15 elements */
+    if(reply && reply->type == XCB_ATOM_WM_SIZE_HINTS && reply->format == 32 && reply->value_len >= 15)
+    {   memcpy(hints_return, reply + 1, reply->value_len * 4);
+        status = 1;
+    }
+    free(reply);
+    return status;
+}
+
+
+/* SYNC */
+
+uint8_t
+XCBSyncInit(XCBDisplay *display)
+{
+    const XCBCookie cookie = { .sequence = REQ(XCB_NONE, "version=%d.%d", 3, 1) };
+    (void)display;
+    free(BLOCK(cookie));
+    return SYNC_EVENT;
+}
+
+uint8_t
+XCBSetDetectableAutoRepeat(XCBDisplay *display, uint8_t state)
+{
+    const XCBCookie cookie = { .sequence = REQ(XCB_NONE, "state=%d", state) };
+    (void)display;
+    free(BLOCK(cookie));
+    _fake.detectable = !!state;
+    return 1;
+}
+
+XCBSyncAlarm
+XCBSyncCreateAlarm(XCBDisplay *display)
+{
+    const XCBSyncAlarm id = _fake.nextid++;
+    (void)display;
+    REQ(XCB_NONE, "alarm=0x%x", id);
+    return id;
+}
+
+XCBCookie
+XCBSyncChangeAlarm(XCBDisplay *display, XCBSyncAlarm alarm, XCBSyncCounter counter, uint64_t value)
+{
+    const XCBCookie cookie = { .sequence = REQ(XCB_NONE, "alarm=0x%x counter=0x%x value=%llu", alarm, counter, (unsigned long long)value) };
+    (void)display;
+    /* counters are not modeled, the alarm only triggers on a later sync command */
+    _fake.alarm = alarm;
+    _fake.alarmcounter = counter;
+    _fake.alarmvalue = value;
+    return cookie;
+}
+
+XCBCookie
+XCBSyncDestroyAlarm(XCBDisplay *display, XCBSyncAlarm alarm)
+{
+    const XCBCookie cookie = { .sequence = REQ(XCB_NONE, "alarm=0x%x", alarm) };
+    (void)display;
+    if(_fake.alarm == alarm)
+    {   _fake.alarm = 0;
+    }
+    return cookie;
+}
+
+XCBCookie
+XCBSyncQueryCounterCookie(XCBDisplay *display, XCBSyncCounter counter)
+{
+    const XCBCookie cookie = { .sequence = REQ(XCB_NONE, "counter=0x%x", counter) };
+    const XCBAtom atom = _fake_intern("_NET_WM_SYNC_REQUEST_COUNTER", 0);
+    XCBSyncQueryCounter *reply = calloc(1, sizeof(XCBSyncQueryCounter));
+    FakeWindow *w;
+    FakeProp *p;
+    (void)display;
+    /* a counter is the one a window names in its property, it starts at 0 until a sync command */
+    for(w = _fake.windows; w; w = w->next)
+    {
+        p = _fake_prop(w, atom);
+        if(p && p->len && *(u32 *)p->data == counter)
+        {   break;
+        }
+    }
+    if(reply && w)
+    {
+        reply->counter_value.hi = w->counter >> 32;
+        reply->counter_value.lo = w->counter & UINT32_MAX;
+    }
+    _fake_pending(cookie.sequence, reply);
+    return cookie;
+}
+
+uint8_t
+XCBSyncQueryCounterReply(XCBDisplay *display, XCBCookie cookie, int64_t *value_return)
+{
+    XCBSyncQueryCounter *reply = BLOCK(cookie);
+    (void)display;
+    if(!reply)
+    {   return 0;
+    }
+    *value_return = (int64_t)(((u64)(u32)reply->counter_value.hi << 32) | reply->counter_value.lo);
+    free(reply);
+    return 1;
+}
+
+
+/* WINDOW QUERIES */
+
+XCBCookie
+XCBGetWindowAttributesCookie(XCBDisplay *display, XCBWindow window)
+{
+    const XCBCookie cookie = { .sequence = REQ(window, "") };
+    FakeWindow *w = _fake_pendingwin(cookie.sequence, X_GetWindowAttributes, window);
+    XCBGetWindowAttributes *reply;
+    (void)display;
+    if(w && (reply = calloc(1, sizeof(XCBGetWindowAttributes))))
+    {
+        reply->response_type = XCB_GET_WINDOW_ATTRIBUTES;
+        reply->_class = XCB_WINDOW_CLASS_INPUT_OUTPUT;
+        reply->map_state = w->mapped ? XCB_MAP_STATE_VIEWABLE : XCB_MAP_STATE_UNMAPPED;
+        reply->override_redirect = w->override;
+        reply->all_event_masks = w->mask;
+        reply->your_event_mask = w->mask;
+        _fake.pending[cookie.sequence & (PENDING_SIZE - 1)].reply = reply;
+    }
+    return cookie;
+}
+
+XCBGetWindowAttributes *
+XCBGetWindowAttributesReply(XCBDisplay *display, XCBCookie cookie)
+{
+    (void)display;
+    return BLOCK(cookie);
+}
+
+static XCBCookie
+_fake_geometrycookie(const char *wrapper, XCBWindow window)
+{
+    const XCBCookie cookie = { .sequence = _fake_request(wrapper, window, "") };
+    FakeWindow *w = _fake_pendingwin(cookie.sequence, X_GetGeometry, window);
+    XCBGeometry *reply;
+    if(w && (reply = calloc(1, sizeof(XCBGeometry))))
+    {
+        reply->response_type = XCB_GET_GEOMETRY;
+        reply->depth = 24;
+        reply->root = _fake.root;
+        reply->x = w->x;
+        reply->y = w->y;
+        reply->width = w->w;
+        reply->height = w->h;
+        reply->border_width = w->bw;
+        _fake.pending[cookie.sequence & (PENDING_SIZE - 1)].reply = reply;
+    }
+    return cookie;
+}
+
+XCBCookie
+XCBGetGeometryCookie(XCBDisplay *display, XCBWindow window)
+{
+    (void)display;
+    return _fake_geometrycookie(__func__, window);
+}
+
+XCBGeometry *
+XCBGetGeometryReply(XCBDisplay *display, XCBCookie cookie)
+{
+    (void)display;
+    return BLOCK(cookie);
+}
+
+XCBCookie
+XCBGetWindowGeometryCookie(XCBDisplay *display, XCBWindow window)
+{
+    (void)display;
+    return _fake_geometrycookie(__func__, window);
+}
+
+XCBWindowGeometry *
+XCBGetWindowGeometryReply(XCBDisplay *display, XCBCookie cookie)
+{
+    (void)display;
+    return BLOCK(cookie);
+}
+
+XCBCookie
+XCBQueryTreeCookie(XCBDisplay *display, XCBWindow window)
+{
+    const XCBCookie cookie = { .sequence = REQ(window, "") };
+    FakeWindow *w = _fake_pendingwin(cookie.sequence, X_QueryTree, window);
+    FakeWindow *c;
+    XCBQueryTree *reply;
+    XCBWindow *children;
+    u32 n = 0;
+    (void)display;
+    if(!w)
+    {   return cookie;
+    }
+    for(c = _fake.windows; c; c = c->next)
+    {   n += c->parent == w->id;
+    }
+    if((reply = calloc(1, sizeof(XCBQueryTree) + n * sizeof(XCBWindow))))
+    {
+        reply->response_type = XCB_QUERY_TREE;
+        reply->root = _fake.root;
+        reply->parent = w->parent;
+        reply->children_len = n;
+        reply->length = n;
+        children = (XCBWindow *)(reply + 1);
+        for(c = _fake.windows; c; c = c->next)
+        {
+            if(c->parent == w->id)
+            {   *children++ = c->id;
+            }
+        }
+        _fake.pending[cookie.sequence & (PENDING_SIZE - 1)].reply = reply;
+    }
+    return cookie;
+}
+
+XCBQueryTree *
+XCBQueryTreeReply(XCBDisplay *display, XCBCookie cookie)
+{
+    (void)display;
+    return BLOCK(cookie);
+}
+
+XCBWindow *
+XCBQueryTreeChildren(const XCBQueryTree *tree)
+{
+    return (XCBWindow *)(tree + 1);
+}
+
+XCBCookie
+XCBQueryPointerCookie(XCBDisplay *display, XCBWindow window)
+{
+    const XCBCookie cookie = { .sequence = REQ(window, "") };
+    FakeWindow *w = _fake_pendingwin(cookie.sequence, X_QueryPointer, window);
+    FakeWindow *c;
+    XCBQueryPointer *reply;
+    (void)display;
+    if(w && (reply = calloc(1, sizeof(XCBQueryPointer))))
+    {
+        reply->response_type = XCB_QUERY_POINTER;
+        reply->same_screen = 1;
+        reply->root = _fake.root;
+        reply->root_x = _fake.px;
+        reply->root_y = _fake.py;
+        reply->win_x = _fake.px - w->x;
+        reply->win_y = _fake.py - w->y;
+        /* topmost mapped child under the pointer */
+        for(c = _fake.windows; c; c = c->next)
+        {
+            if(c->parent == w->id && c->mapped
+            && _fake.px >= c->x && _fake.px < c->x + c->w + 2 * c->bw
+            && _fake.py >= c->y && _fake.py < c->y + c->h + 2 * c->bw)
+            {   reply->child = c->id;
+            }
+        }
+        _fake.pending[cookie.sequence & (PENDING_SIZE - 1)].reply = reply;
+    }
+    return cookie;
+}
+
+XCBQueryPointer *
+XCBQueryPointerReply(XCBDisplay *display, XCBCookie cookie)
+{
+    (void)display;
+    return BLOCK(cookie);
+}
+
+
+/* WINDOWS */
+
+XCBWindow
+XCBCreateSimpleWindow(XCBDisplay *display, XCBWindow parent, i16 x, i16 y, u16 width, u16 height, u16 border_width, u32 border_color, u32 background_color)
+{
+    const XCBWindow id = _fake.nextid++;
+    const u32 sequence = REQ(id, "parent=0x%x %d %d %u %u %u", parent, x, y, width, height, border_width);
+    (void)display;
+    (void)border_color;
+    (void)background_color;
+    if(!_fake_window(parent))
+    {   _fake_error(BadWindow, X_CreateWindow, sequence, parent, NULL);
+        return id;
+    }
+    _fake_create(id, parent, x, y, width, height, border_width, 0);
+    return id;
+}
+
+XCBWindow
+XCBCreateWindow(XCBDisplay *display, XCBWindow parent, i16 x, i16 y, u16 width, u16 height, u16 border_width, 
+        u8 depth, unsigned int class, XCBVisual visual, u32 valuemask, const u32 *value_list)
+{
+    const XCBWindow id = _fake.nextid++;
+    const u32 sequence = REQ(id, "parent=0x%x %d %d %u %u %u class=%u", parent, x, y, width, height, border_width, class);
+    FakeWindow *w;
+    u32 bit;
+    u32 i = 0;
+    u8 override = 0;
+    u32 mask = 0;
+    (void)display;
+    (void)depth;
+    (void)visual;
+    /* values are in the order of their bit */
+    for(bit = 1; bit && bit <= valuemask; bit <<= 1)
+    {
+        if(valuemask & bit)
+        {
+            if(bit == XCB_CW_OVERRIDE_REDIRECT)
+            {   override = !!value_list[i];
+            }
+            else if(bit == XCB_CW_EVENT_MASK)
+            {   mask = value_list[i];
+            }
+            ++i;
+        }
+    }
+    if(!_fake_window(parent))
+    {   _fake_error(BadWindow, X_CreateWindow, sequence, parent, NULL);
+        return id;
+    }
+    if((w = _fake_create(id, parent, x, y, width, height, border_width, override)))
+    {   w->mask = mask;
+    }
+    return id;
+}
+
+XCBCookie
+XCBDestroyWindow(XCBDisplay *display, XCBWindow window)
+{
+    const XCBCookie cookie = { .sequence = REQ(window, "") };
+    FakeWindow *w = _fake_window(window);
+    (void)display;
+    if(!w)
+    {   _fake_error(BadWindow, X_DestroyWindow, cookie.sequence, window, NULL);
+    }
+    else if(window != _fake.root)
+    {   _fake_destroy(w);
+    }
+    return cookie;
+}
+
+XCBCookie
+XCBKillClient(XCBDisplay *display, XCBWindow resource)
+{
+    const XCBCookie cookie = { .sequence = REQ(resource, "") };
+    FakeWindow *w = _fake_window(resource);
+    (void)display;
+    /* every script window is its own client */
+    if(!w)
+    {   _fake_error(BadValue, X_KillClient, cookie.sequence, resource, NULL);
+    }
+    else if(resource != _fake.root)
+    {   _fake_destroy(w);
+    }
+    return cookie;
+}
+
+XCBCookie
+XCBMapWindow(XCBDisplay *display, XCBWindow window)
+{
+    const XCBCookie cookie = { .sequence = REQ(window, "") };
+    FakeWindow *w = _fake_window(window);
+    (void)display;
+    if(!w)
+    {   _fake_error(BadWindow, X_MapWindow, cookie.sequence, window, NULL);
+    }
+    else
+    {   _fake_map(w);
+    }
+    return cookie;
+}
+
+XCBCookie
+XCBUnmapWindow(XCBDisplay *display, XCBWindow window)
+{
+    const XCBCookie cookie = { .sequence = REQ(window, "") };
+    FakeWindow *w = _fake_window(window);
+    (void)display;
+    if(!w)
+    {   _fake_error(BadWindow, X_UnmapWindow, cookie.sequence, window, NULL);
+    }
+    else
+    {   _fake_unmap(w);
+    }
+    return cookie;
+}
+
+static XCBCookie
+_fake_configurecookie(const char *wrapper, XCBWindow window, u16 mask, const XCBWindowChanges *changes)
+{
+    char detail[128];
+    int len = 0;
+    XCBCookie cookie;
+    FakeWindow *w;
+
+    detail[0] = '\0';
+    if(mask & XCB_CONFIG_WINDOW_X)
+    {   len += snprintf(detail + len, sizeof(detail) - len, "x=%d ", changes->x);
+    }
+    if(mask & XCB_CONFIG_WINDOW_Y)
+    {   len += snprintf(detail + len, sizeof(detail) - len, "y=%d ", changes->y);
+    }
+    if(mask & XCB_CONFIG_WINDOW_WIDTH)
+    {   len += snprintf(detail + len, sizeof(detail) - len, "w=%u ", changes->width);
+    }
+    if(mask & XCB_CONFIG_WINDOW_HEIGHT)
+    {   len += snprintf(detail + len, sizeof(detail) - len, "h=%u ", changes->height);
+    }
+    if(mask & XCB_CONFIG_WINDOW_BORDER_WIDTH)
+    {   len += snprintf(detail + len, sizeof(detail) - len, "bw=%u ", changes->border_width);
+    }
+    if(mask & XCB_CONFIG_WINDOW_SIBLING)
+    {   len += snprintf(detail + len, sizeof(detail) - len, "sibling=0x%x ", changes->sibling);
+    }
+    if(mask & XCB_CONFIG_WINDOW_STACK_MODE)
+    {   len += snprintf(detail + len, sizeof(detail) - len, "stack=%u ", changes->stack_mode);
+    }
+    if(len > 0)
+    {   detail[len - 1] = '\0';
+    }
+    cookie.sequence = _fake_request(wrapper, window, "%s", detail);
+    if(!(w = _fake_window(window)))
+    {   _fake_error(BadWindow, X_ConfigureWindow, cookie.sequence, window, NULL);
+    }
+    else
+    {   _fake_configure(w, mask, changes);
+    }
+    return cookie;
+}
+
+XCBCookie
+XCBConfigureWindow(XCBDisplay *display, XCBWindow window, u16 value_mask, XCBWindowChanges *changes)
+{
+    (void)display;
+    return _fake_configurecookie(__func__, window, value_mask, changes);
+}
+
+XCBCookie
+XCBMoveWindow(XCBDisplay *display, XCBWindow window, i32 x, i32 y)
+{
+    XCBWindowChanges changes = { .x = x, .y = y };
+    (void)display;
+    return _fake_configurecookie(__func__, window, XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y, &changes);
+}
+
+XCBCookie
+XCBResizeWindow(XCBDisplay *display, XCBWindow window, u32 width, u32 height)
+{
+    XCBWindowChanges changes = { .width = width, .height = height };
+    (void)display;
+    return _fake_configurecookie(__func__, window, XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT, &changes);
+}
+
+XCBCookie
+XCBMoveResizeWindow(XCBDisplay *display, XCBWindow window, i32 x, i32 y, u32 width, u32 height)
+{
+    XCBWindowChanges changes = { .x = x, .y = y, .width = width, .height = height };
+    (void)display;
+    return _fake_configurecookie(__func__, window, XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y | XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT, &changes);
+}
+
+XCBCookie
+XCBSetWindowBorderWidth(XCBDisplay *display, XCBWindow window, u32 border_width)
+{
+    XCBWindowChanges changes = { .border_width = border_width };
+    (void)display;
+    return _fake_configurecookie(__func__, window, XCB_CONFIG_WINDOW_BORDER_WIDTH, &changes);
+}
+
+XCBCookie
+XCBRaiseWindow(XCBDisplay *display, XCBWindow window)
+{
+    XCBWindowChanges changes = { .stack_mode = XCB_STACK_MODE_ABOVE };
+    (void)display;
+    return _fake_configurecookie(__func__, window, XCB_CONFIG_WINDOW_STACK_MODE, &changes);
+}
+
+XCBCookie
+XCBLowerWindow(XCBDisplay *display, XCBWindow window)
+{
+    XCBWindowChanges changes = { .stack_mode = XCB_STACK_MODE_BELOW };
+    (void)display;
+    return _fake_configurecookie(__func__, window, XCB_CONFIG_WINDOW_STACK_MODE, &changes);
+}
+
+XCBCookie
+XCBSelectInput(XCBDisplay *display, XCBWindow window, u32 mask)
+{
+    const XCBCookie cookie = { .sequence = REQ(window, "0x%x", mask) };
+    FakeWindow *w = _fake_window(window);
+    (void)display;
+    if(!w)
+    {   _fake_error(BadWindow, X_ChangeWindowAttributes, cookie.sequence, window, NULL);
+    }
+    else
+    {   w->mask = mask;
+    }
+    return cookie;
+}
+
+XCBCookie
+XCBChangeWindowAttributes(XCBDisplay *display, XCBWindow window, u32 mask, XCBWindowAttributes *window_attributes)
+{
+    const XCBCookie cookie = { .sequence = REQ(window, "0x%x", mask) };
+    FakeWindow *w = _fake_window(window);
+    (void)display;
+    if(!w)
+    {   _fake_error(BadWindow, X_ChangeWindowAttributes, cookie.sequence, window, NULL);
+        return cookie;
+    }
+    if(mask & XCB_CW_OVERRIDE_REDIRECT)
+    {   w->override = !!window_attributes->override_redirect;
+    }
+    if(mask & XCB_CW_EVENT_MASK)
+    {   w->mask = window_attributes->event_mask;
+    }
+    return cookie;
+}
+
+XCBCookie
+XCBSendEvent(XCBDisplay *display, XCBWindow window, u8 propagate, u32 event_mask, const char *event)
+{
+    const XCBCookie cookie = { .sequence = REQ(window, "%s 0x%x", _fake_eventname(event[0]), event_mask) };
+    FakeWindow *w = _fake_window(window);
+    u8 ev[32];
+    (void)display;
+    (void)propagate;
+    if(!w)
+    {   _fake_error(BadWindow, X_SendEvent, cookie.sequence, window, NULL);
+    }
+    /* the WM is the only client, so it only gets back what it selected itself */
+    else if(w->mask & event_mask)
+    {   memcpy(ev, event, sizeof(ev));
+        ev[0] |= 0x80;
+        _fake_queue(ev);
+    }
+    return cookie;
+}
+
+XCBCookie
+XCBSetInputFocus(XCBDisplay *display, XCBWindow window, u8 revert_to, XCBTimestamp time)
+{
+    const XCBCookie cookie = { .sequence = REQ(window, "revert=%u", revert_to) };
+    (void)display;
+    (void)time;
+    if(window > XCB_INPUT_FOCUS_POINTER_ROOT && !_fake_window(window))
+    {   _fake_error(BadWindow, X_SetInputFocus, cookie.sequence, window, NULL);
+    }
+    else
+    {   _fake_setfocus(window);
+    }
+    return cookie;
+}
+
+
+/* GRABS */
+
+XCBCookie
+XCBGrabKey(XCBDisplay *display, XCBKeyCode key, u16 modifiers, XCBWindow grab_window, u8 owner_events, u8 pointer_mode, u8 keyboard_mode)
+{
+    const XCBCookie cookie = { .sequence = REQ(grab_window, "%u 0x%x", key, modifiers) };
+    (void)display;
+    (void)owner_events;
+    (void)pointer_mode;
+    (void)keyboard_mode;
+    return cookie;
+}
+
+XCBCookie
+XCBUngrabKey(XCBDisplay *display, XCBKeyCode key, u16 modifiers, XCBWindow grab_window)
+{
+    const XCBCookie cookie = { .sequence = REQ(grab_window, "%u 0x%x", key, modifiers) };
+    (void)display;
+    return cookie;
+}
+
+XCBCookie
+XCBGrabButton(XCBDisplay *display, u8 button, u16 modifiers, XCBWindow grab_window, u8 owner_events, u16 event_mask, u8 pointer_mode, u8 keyboard_mode, XCBWindow confine_to, XCBCursor cursor)
+{
+    const XCBCookie cookie = { .sequence = REQ(grab_window, "%u 0x%x", button, modifiers) };
+    (void)display;
+    (void)owner_events;
+    (void)event_mask;
+    (void)pointer_mode;
+    (void)keyboard_mode;
+    (void)confine_to;
+    (void)cursor;
+    return cookie;
+}
+
+XCBCookie
+XCBUngrabButton(XCBDisplay *display, u8 button, u16 modifier, XCBWindow window)
+{
+    const XCBCookie cookie = { .sequence = REQ(window, "%u 0x%x", button, modifier) };
+    (void)display;
+    return cookie;
+}
+
+XCBCookie
+XCBGrabPointerCookie(XCBDisplay *display, XCBWindow grab_window, u8 owner_events, u16 event_mask, u8 pointer_mode, u8 keyboard_mode, XCBWindow confine_to, XCBCursor cursor, XCBTimestamp tim)
+{
+    const XCBCookie cookie = { .sequence = REQ(grab_window, "0x%x", event_mask) };
+    XCBGrabPointer *reply = calloc(1, sizeof(XCBGrabPointer));
+    (void)display;
+    (void)owner_events;
+    (void)pointer_mode;
+    (void)keyboard_mode;
+    (void)confine_to;
+    (void)cursor;
+    (void)tim;
+    if(reply)
+    {   reply->response_type = XCB_GRAB_POINTER;
+        reply->status = XCB_GRAB_STATUS_SUCCESS;
+    }
+    _fake_pending(cookie.sequence, reply);
+    return cookie;
+}
+
+XCBCookie
+XCBChangeActivePointerGrab(XCBDisplay *display, XCBCursor cursor, XCBTimestamp tim, u16 event_mask)
+{
+    const XCBCookie cookie = { .sequence = REQ(_fake.grab, "0x%x", event_mask) };
+    (void)display;
+    (void)cursor;
+    (void)tim;
+    if(_fake.grab)
+    {   _fake.grabmask = event_mask;
+    }
+    return cookie;
+}
+
+XCBGrabPointer *
+XCBGrabPointerReply(XCBDisplay *display, XCBCookie cookie)
+{
+    (void)display;
+    return BLOCK(cookie);
+}
+
+XCBCookie
+XCBAllowEvents(XCBDisplay *display, u8 mode, XCBTimestamp timestamp)
+{
+    const XCBCookie cookie = { .sequence = REQ(XCB_NONE, "%u", mode) };
+    (void)display;
+    (void)timestamp;
+    return cookie;
+}
+
+XCBCookie
+XCBGrabKeyboardCookie(XCBDisplay *display, XCBWindow grab_window, u8 owner_events, u8 pointer_mode, u8 keyboard_mode, XCBTimestamp tim)
+{
+    const XCBCookie cookie = { .sequence = REQ(grab_window, "") };
+    XCBGrabKeyboard *reply = calloc(1, sizeof(XCBGrabKeyboard));
+    (void)display;
+    (void)owner_events;
+    (void)pointer_mode;
+    (void)keyboard_mode;
+    (void)tim;
+    /* keys already always go to the root */
+    if(reply)
+    {   reply->response_type = XCB_GRAB_KEYBOARD;
+        reply->status = XCB_GRAB_STATUS_SUCCESS;
+    }
+    _fake_pending(cookie.sequence, reply);
+    return cookie;
+}
+
+XCBGrabKeyboard *
+XCBGrabKeyboardReply(XCBDisplay *display, XCBCookie cookie)
+{
+    (void)display;
+    return BLOCK(cookie);
+}
+
+XCBCookie
+XCBUngrabKeyboard(XCBDisplay *display, XCBTimestamp tim)
+{
+    const XCBCookie cookie = { .sequence = REQ(XCB_NONE, "") };
+    (void)display;
+    (void)tim;
+    return cookie;
+}
+
+XCBCookie
+XCBGrabServer(XCBDisplay *display)
+{
+    const XCBCookie cookie = { .sequence = REQ(XCB_NONE, "") };
+    (void)display;
+    return cookie;
+}
+
+XCBCookie
+XCBUngrabServer(XCBDisplay *display)
+{
+    const XCBCookie cookie = { .sequence = REQ(XCB_NONE, "") };
+    (void)display;
+    return cookie;
+}
+
+
+/* KEYBOARD */
+
+XCBKeySymbols *
+XCBKeySymbolsAlloc(XCBDisplay *display)
+{
+    (void)display;
+    /* opaque, only ever handed back to us */
+    return (XCBKeySymbols *)_keymap;
+}
+
+void
+XCBKeySymbolsFree(XCBKeySymbols *keysyms)
+{
+    (void)keysyms;
+}
+
+XCBKeyCode *
+XCBKeySymbolsGetKeyCode(XCBKeySymbols *symbols, XCBKeysym keysym)
+{
+    XCBKeyCode *codes = calloc(2, sizeof(XCBKeyCode));
+    (void)symbols;
+    if(codes)
+    {   codes[0] = _fake_keycode(keysym);
+    }
+    return codes;
+}
+
+XCBKeysym
+XCBKeySymbolsGetKeySym(XCBKeySymbols *symbols, XCBKeyCode keycode, u8 column)
+{
+    (void)symbols;
+    (void)column;
+    return _keymap[keycode];
+}
+
+u8
+XCBRefreshKeyboardMapping(XCBKeySymbols *syms, XCBMappingNotifyEvent *event)
+{
+    (void)syms;
+    return event->request == XCB_MAPPING_KEYBOARD;
+}
+
+XCBCookie
+XCBGetModifierMappingCookie(XCBDisplay *display)
+{
+    const XCBCookie cookie = { .sequence = REQ(XCB_NONE, "") };
+    XCBKeyboardModifier *reply = calloc(1, sizeof(XCBKeyboardModifier) + 8 * sizeof(XCBKeyCode));
+    (void)display;
+    if(reply)
+    {
+        reply->response_type = XCB_GET_MODIFIER_MAPPING;
+        reply->keycodes_per_modifier = 1;
+        reply->length = 2;
+        /* shift, lock, control, mod1, mod2 ... Num_Lock is mod2 like most keymaps */
+        ((XCBKeyCode *)(reply + 1))[4] = _fake_keycode(XK_NUM_LOCK);
+    }
+    _fake_pending(cookie.sequence, reply);
+    return cookie;
+}
+
+XCBKeyboardModifier *
+XCBGetModifierMappingReply(XCBDisplay *display, XCBCookie cookie)
+{
+    (void)display;
+    return BLOCK(cookie);
+}
+
+XCBKeyCode *
+XCBGetModifierMappingKeyCodes(XCBKeyboardModifier *reply)
+{
+    return (XCBKeyCode *)(reply + 1);
+}
@@ -0,0 +1,110 @@
+/**
+ * @file xcb_trl_fake.h
+ * In process fake XServer for xcb_trl.
+ */
+
+/* xcb_trl_fake.c implements the XCB* functions from xcb_trl.h against an in memory model instead of an XServer.
+ * It is linked in place of xcb_trl.c, see `make fake`, so the WM itself is unchanged.
+ *
+ * Environment:
+ * XCB_FAKE_SCRIPT      File the events are read from, one command per line (default: stdin).
+ * XCB_FAKE_LOG         File the request stream is written to (default: none).
+ * XCB_FAKE_SCREEN      Screen size as WIDTHxHEIGHT (default: 1920x1080).
+ *
+ * Script (window ids may be decimal or 0x hex, '#' starts a comment):
+ * window WIN X Y W H [override]        Creates a top level window.
+ * prop WIN ATOM TYPE FORMAT VALUE...   Replaces a property, format 8 takes the rest of the line as a string,
+ *                                      format 32 takes numbers or atom names.
+ * map WIN                              The client maps WIN (MapRequest if the root is redirected).
+ * unmap WIN                            The client unmaps WIN.
+ * destroy WIN                          The client destroys WIN.
+ * configure WIN X Y W H [BW]           The client configures WIN (ConfigureRequest if the root is redirected).
+ * key KEYSYM [MODS]                    Presses and releases KEYSYM, MODS are joined by '+' (shift, lock, ctrl, alt, super, mod1-mod5).
+ * hold KEYSYM COUNT [MODS]             Presses KEYSYM, autorepeats it COUNT times and releases it.
+ * button WIN BUTTON [MODS]             Presses and releases BUTTON over WIN.
+ * press WIN BUTTON [MODS]              Presses BUTTON over WIN, the pointer stays grabbed by WIN until release.
+ * release WIN BUTTON                   Releases BUTTON.
+ * motion X Y                           Moves the pointer, reported to the grab window while a button is held,
+ *                                      otherwise the topmost window under it gets an EnterNotify if it changed.
+ * enter WIN                            Moves the pointer into WIN.
+ * focus WIN                            The client focuses WIN.
+ * sync WIN VALUE                       The client sets its _NET_WM_SYNC_REQUEST_COUNTER to VALUE.
+ * message WIN ATOM [DATA...]           Sends a format 32 ClientMessage about WIN to the root.
+ * mark TEXT                            Writes TEXT to the log.
+ *
+ * The connection fd (an eventfd) is always readable, XCBPollForEvent() reads one script line once the queue is empty.
+ * It only does so once the WM asked for the fd, so startup never sees scripted input.
+ * Once the script runs out XCBNextEvent() returns 0 and XCBCheckDisplayError() returns XCB_CONN_ERROR
+ * (after a poll) so the WM leaves its event loop.
+ *
+ * Log, one tab separated entry per line:
+ * R SEQUENCE SCOPE WRAPPER WINDOW DETAIL   A request.
+ * B SEQUENCE SCOPE WRAPPER                 A blocking reply or sync.
+ * H HOT WRAPPER                            A blocking call inside a hot path, see XCB_TRL_HOT_SCOPE().
+ * E EVENT WINDOW                           An event handed to the WM.
+ * X ERROR MAJOR SEQUENCE RESOURCE          An error generated for a request.
+ * M TEXT                                   A script mark.
+ *
+ * Simplifications:
+ * Every window is a child of the root and the WM is the only client, so every selected event mask is the WM's.
+ * Keys are always delivered to the root, no grabs are enforced except the automatic one of press
+ * and the keymap is assigned on demand.
+ * SYNC counters are not modeled, only the last armed alarm exists and it only triggers on a sync command.
+ * Byte counts in XCBStats are always 0.
+ */
+
+#ifndef XCB_TRL_FAKE_H_
+#define XCB_TRL_FAKE_H_
+
+#include "xcb_trl.h"
+
+typedef struct XCBFakeCounts XCBFakeCounts;
+
+struct XCBFakeCounts
+{
+    uint64_t requests;          /* Requests made                                */
+    uint64_t replies;           /* Replies blocked for, including syncs         */
+    uint64_t syncs;             /* XCBSync() round trips                        */
+    uint64_t flushes;           /* XCBFlush() calls                             */
+    uint64_t events;            /* Events handed to the WM                      */
+    uint64_t errors;            /* Errors generated                             */
+};
+
+/* Runs a single script line, as if it was read from XCB_FAKE_SCRIPT.
+ *
+ * RETURN: 1 on Success.
+ * RETURN: 0 on Failure (unknown command or missing arguments).
+ */
+int
+XCBFakeScript(
+        const char *line);
+
+/* Copies the counters since the display was opened or last reset. */
+void
+XCBFakeGetCounts(
+        XCBFakeCounts *counts_return);
+
+/* Clears the counters. */
+void
+XCBFakeResetCounts(void);
+
+/* Any of the returns may be NULL.
+ *
+ * RETURN: 1 and the current state of window if it exists.
+ * RETURN: 0 if window does not exist.
+ */
+int
+XCBFakeGetWindow(
+        XCBWindow window,
+        int16_t *x_return,
+        int16_t *y_return,
+        uint16_t *width_return,
+        uint16_t *height_return,
+        uint8_t *mapped_return
+        );
+
+/* RETURN: The window that has the input focus. */
+XCBWindow
+XCBFakeGetFocus(void);
+
+#endif
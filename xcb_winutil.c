@@ -123,6 +123,7 @@ XCBInitAtoms(XCBDisplay *display, XCBAtom *wm_atom_return, XCBAtom *net_atom_ret
         /* Window manager protocols */
         netcookies[NetWMPing] = XCBInternAtomCookie(display, "_NET_WM_PING", False);
         netcookies[NetWMSyncRequest] = XCBInternAtomCookie(display, "_NET_WM_SYNC_REQUEST", False);
+        netcookies[NetWMSyncRequestCounter] = XCBInternAtomCookie(display, "_NET_WM_SYNC_REQUEST_COUNTER", False);
         netcookies[NetWMFullscreenMonitors] = XCBInternAtomCookie(display, "_NET_WM_FULLSCREEN_MONITORS", False);
         netcookies[NetWMUserTime] = XCBInternAtomCookie(display, "_NET_WM_USER_TIME", False);
         netcookies[NetWMUserTimeWindow] = XCBInternAtomCookie(display, "_NET_WM_USER_TIME_WINDOW", False);
@@ -243,6 +244,7 @@ XCBInitAtoms(XCBDisplay *display, XCBAtom *wm_atom_return, XCBAtom *net_atom_ret
         /* Window manager protocols */
         net_atom_return[NetWMPing] = XCBInternAtomReply(display, netcookies[NetWMPing]);
         net_atom_return[NetWMSyncRequest] = XCBInternAtomReply(display, netcookies[NetWMSyncRequest]);
+        net_atom_return[NetWMSyncRequestCounter] = XCBInternAtomReply(display, netcookies[NetWMSyncRequestCounter]);
         net_atom_return[NetWMFullscreenMonitors] = XCBInternAtomReply(display, netcookies[NetWMFullscreenMonitors]);
         net_atom_return[NetWMUserTime] = XCBInternAtomReply(display, netcookies[NetWMUserTime]);
         net_atom_return[NetWMUserTimeWindow] = XCBInternAtomReply(display, netcookies[NetWMUserTimeWindow]);
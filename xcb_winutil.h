@@ -66,7 +66,7 @@ enum NETWMPROTOCOLS
     NetWMWindowTypeDialog, NetWMWindowTypeNormal,
 
     /* wm protocols */
-    NetWMPing, NetWMSyncRequest,
+    NetWMPing, NetWMSyncRequest, NetWMSyncRequestCounter,
     NetWMFullscreenMonitors,
     /* other */
     NetWMFullPlacement ,NetWMBypassCompositor,